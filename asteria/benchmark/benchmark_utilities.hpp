@@ -0,0 +1,38 @@
+// This file is part of Asteria.
+// Copyleft 2018 - 2020, LH_Mouse. All wrongs reserved.
+
+#ifndef ASTERIA_BENCHMARK_UTILITIES_HPP_
+#define ASTERIA_BENCHMARK_UTILITIES_HPP_
+
+#include "../src/fwd.hpp"
+#include "../src/runtime/simple_script.hpp"
+#include "../src/runtime/global_context.hpp"
+#include <chrono>
+#include <cstdio>
+#include <limits>
+
+namespace Asteria {
+
+// Compiles `source` with `opts`, then executes it `rounds` times, each time in a new global context.
+// The shortest duration is printed to standard output in milliseconds.
+inline void benchmark_script(const char* name, const char* source, const Compiler_Options& opts = { },
+                             unsigned rounds = 5)
+  {
+    Simple_Script script;
+    script.set_options(opts);
+    script.reload_string(::rocket::sref(source), ::rocket::sref(name));
+
+    double best = ::std::numeric_limits<double>::infinity();
+    for(unsigned k = 0;  k != rounds;  ++k) {
+      Global_Context global;
+      auto start = ::std::chrono::steady_clock::now();
+      script.execute(global);
+      auto stop = ::std::chrono::steady_clock::now();
+      best = ::std::min(best, ::std::chrono::duration<double, ::std::milli>(stop - start).count());
+    }
+    ::std::printf("%-32s%12.3f ms\n", name, best);
+  }
+
+}  // namespace Asteria
+
+#endif
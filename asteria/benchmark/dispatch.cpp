@@ -0,0 +1,109 @@
+// This file is part of Asteria.
+// Copyleft 2018 - 2020, LH_Mouse. All wrongs reserved.
+
+#include "benchmark_utilities.hpp"
+#include "../src/llds/avmc_queue.hpp"
+#include "../src/runtime/executive_context.hpp"
+#include "../src/runtime/evaluation_stack.hpp"
+
+using namespace Asteria;
+
+namespace {
+
+AIR_Status do_nothing(Executive_Context& /*ctx*/, AVMC_Queue::ParamU /*pu*/, const void* /*pv*/)
+  {
+    return air_status_next;
+  }
+
+AIR_Status do_count(Executive_Context& /*ctx*/, AVMC_Queue::ParamU pu, const void* pv)
+  {
+    **static_cast<uint64_t* const*>(pv) += pu.x32;
+    return air_status_next;
+  }
+
+AIR_Status do_touch_string(Executive_Context& /*ctx*/, AVMC_Queue::ParamU /*pu*/, const void* pv)
+  {
+    return static_cast<const cow_string*>(pv)->empty() ? air_status_break_unspec : air_status_next;
+  }
+
+// Executes `queue` repeatedly and prints the number of nodes executed per second.
+void benchmark_queue(const char* name, const AVMC_Queue& queue, size_t nnodes, bool jit, unsigned rounds = 5)
+  {
+    Global_Context global;
+    global.set_jit_enabled(jit);
+    Evaluation_Stack stack;
+    rcptr<Variadic_Arguer> zvarg;
+    Executive_Context ctx(::rocket::ref(global), ::rocket::ref(stack), ::rocket::ref(zvarg), { });
+
+    constexpr unsigned nreps = 20000;
+    double best = ::std::numeric_limits<double>::infinity();
+    for(unsigned k = 0;  k != rounds;  ++k) {
+      auto start = ::std::chrono::steady_clock::now();
+      for(unsigned r = 0;  r != nreps;  ++r)
+        queue.execute(ctx);
+      auto stop = ::std::chrono::steady_clock::now();
+      best = ::std::min(best, ::std::chrono::duration<double, ::std::milli>(stop - start).count());
+    }
+    ::std::printf("%-32s%12.3f ms%12.1f Mnodes/s\n", (cow_string(name) + (jit ? "/jit" : "")).c_str(),
+                  best, double(nnodes) * nreps / best / 1000);
+  }
+
+}  // namespace
+
+int main()
+  {
+    constexpr size_t nnodes = 1000;
+    AVMC_Queue queue;
+
+    for(size_t i = 0;  i != nnodes;  ++i)
+      queue.request(0);
+    for(size_t i = 0;  i != nnodes;  ++i)
+      queue.append<do_nothing>({ });
+    benchmark_queue("dispatch/trivial", queue, nnodes, false);
+    benchmark_queue("dispatch/trivial", queue, nnodes, true);
+
+    uint64_t count = 0;
+    uint64_t* pcount = &count;
+    queue.clear();
+    for(size_t i = 0;  i != nnodes;  ++i)
+      queue.request(sizeof(pcount));
+    for(size_t i = 0;  i != nnodes;  ++i)
+      queue.append<do_count>({ { 1 } }, pcount);
+    benchmark_queue("dispatch/parameter", queue, nnodes, false);
+    benchmark_queue("dispatch/parameter", queue, nnodes, true);
+
+    queue.clear();
+    for(size_t i = 0;  i != nnodes;  ++i)
+      queue.request(sizeof(cow_string));
+    for(size_t i = 0;  i != nnodes;  ++i)
+      queue.append<do_touch_string>({ }, ::rocket::sref("hello"));
+    benchmark_queue("dispatch/vtable", queue, nnodes, false);
+    benchmark_queue("dispatch/vtable", queue, nnodes, true);
+
+    // This is a mix of the above, in a pattern that is hard to predict.
+    queue.clear();
+    for(size_t i = 0;  i != nnodes;  ++i)
+      queue.request(sizeof(cow_string));
+    for(size_t i = 0;  i != nnodes;  ++i)
+      switch(i * 7 % 11 % 3) {
+      case 0:
+        queue.append<do_nothing>({ });
+        break;
+      case 1:
+        queue.append<do_count>({ { 1 } }, pcount);
+        break;
+      default:
+        queue.append<do_touch_string>({ }, ::rocket::sref("hello"));
+        break;
+      }
+    benchmark_queue("dispatch/mixed", queue, nnodes, false);
+    benchmark_queue("dispatch/mixed", queue, nnodes, true);
+
+    benchmark_script("dispatch/script_loop",
+      R"__(
+        var s = 0;
+        for(var i = 0;  i < 1000000;  ++i)
+          s = s + i;
+        return s;
+      )__");
+  }
@@ -0,0 +1,59 @@
+// This file is part of Asteria.
+// Copyleft 2018 - 2020, LH_Mouse. All wrongs reserved.
+
+#include "benchmark_utilities.hpp"
+
+using namespace Asteria;
+
+int main()
+  {
+    benchmark_script("function_call/fib",
+      R"__(
+        func fib(n) {
+          return n <= 1 ? n : fib(n - 1) + fib(n - 2);
+        }
+        return fib(24);
+      )__");
+
+    benchmark_script("function_call/closure",
+      R"__(
+        func make_adder(x) {
+          return func(y) = x + y;
+        }
+        var sum = 0;
+        for(var i = 0;  i < 100000;  ++i) {
+          var add = make_adder(i);
+          sum = add(sum) & 0xFFFF;
+        }
+        return sum;
+      )__");
+
+    benchmark_script("function_call/sort_comparator",
+      R"__(
+        var data = [];
+        for(var i = 0;  i < 20000;  ++i)
+          data[$] = (i * 7919) % 10007;
+        for(var k = 0;  k < 5;  ++k)
+          std.array.sort(data, func(x, y) = y <=> x);
+        return data[0];
+      )__");
+
+    benchmark_script("function_call/tail_call",
+      R"__(
+        var ping, pong;
+        ping = func(n, acc) {
+          if(n <= 0)
+            return acc;
+          return pong(n - 1, acc + 1);
+        };
+        pong = func(n, acc) {
+          if(n <= 0)
+            return acc;
+          return ping(n - 1, (acc + n) % 1000);
+        };
+        func spin(n) {
+          return (n <= 0) ? n : spin(n - 1);
+        }
+        return ping(200000, 0) + spin(200000);
+      )__");
+  }
@@ -0,0 +1,41 @@
+// This file is part of Asteria.
+// Copyleft 2018 - 2020, LH_Mouse. All wrongs reserved.
+
+#include "benchmark_utilities.hpp"
+
+using namespace Asteria;
+
+int main()
+  {
+    benchmark_script("native_call/numeric",
+      R"__(
+        var abs = std.numeric.abs;
+        var sign = std.numeric.sign;
+        var clamp = std.numeric.clamp;
+        var s = 0;
+        for(var i = 0;  i < 200000;  ++i)
+          s = clamp(s + abs(-i) * sign(i), 0, 100000);
+        return s;
+      )__");
+
+    benchmark_script("native_call/string",
+      R"__(
+        var slice = std.string.slice;
+        var find = std.string.find;
+        var str = "hello world";
+        var s = 0;
+        for(var i = 0;  i < 100000;  ++i)
+          s += lengthof slice(str, 2) + find(str, "o") + find(str, 5, "o");
+        return s;
+      )__");
+
+    benchmark_script("native_call/math",
+      R"__(
+        var sqrt = std.numeric.sqrt;
+        var exp = std.math.exp;
+        var s = 0.0;
+        for(var i = 0;  i < 200000;  ++i)
+          s += sqrt(i) + exp(1.0 / (i + 1), 2);
+        return s;
+      )__");
+  }
@@ -0,0 +1,77 @@
+// This file is part of Asteria.
+// Copyleft 2018 - 2020, LH_Mouse. All wrongs reserved.
+
+#include "benchmark_utilities.hpp"
+
+using namespace Asteria;
+
+namespace {
+
+// Runs `source` with the stack-based and register-based expressions side by side.
+void benchmark_both(const char* name, const char* source)
+  {
+    Compiler_Options opts = { };
+    benchmark_script(name, source, opts);
+    opts.register_expressions = true;
+    benchmark_script((cow_string(name) + "/reg").c_str(), source, opts);
+  }
+
+}  // namespace
+
+int main()
+  {
+    // These are modelled after scripts in `test/`.
+    benchmark_both("register/arithmetic",
+      R"__(
+        var s = 0, t = 1;
+        for(var i = 0;  i < 300000;  ++i) {
+          s = (s + i * 3 - t) % 1000003;
+          t = t * 5 + i & 0xFFFF;
+        }
+        return s + t;
+      )__");
+
+    benchmark_both("register/superinstructions",
+      R"__(
+        var n = 0, m = 0;
+        for(var k = 0;  k < 30000;  ++k)
+          for(var i = 0;  i < 10;  ++i) {
+            n = n + 3;
+            m = m - 1;
+            if(i == 5)
+              n = n * 2 % 65536;
+          }
+        return n + m;
+      )__");
+
+    benchmark_both("register/comparison",
+      R"__(
+        var c = 0;
+        var a = 3.5, b = 7;
+        for(var i = 0;  i < 300000;  ++i)
+          if(i % 7 < b && a * i > 100 || i == 17)
+            ++c;
+        return c;
+      )__");
+
+    benchmark_both("register/closure",
+      R"__(
+        var base = 11;
+        func poly(x) { return x * x * base + x * 7 - base; }
+        var s = 0;
+        for(var i = 0;  i < 100000;  ++i)
+          s = s + poly(i % 100) & 0xFFFFFF;
+        return s;
+      )__");
+
+    benchmark_both("register/string",
+      R"__(
+        var s = "", t = "ab", c = 0;
+        for(var i = 0;  i < 100000;  ++i) {
+          s = t + "cd" + t;
+          if(s < "b" || s == t * 2)
+            ++c;
+        }
+        return c;
+      )__");
+  }
@@ -0,0 +1,32 @@
+// This file is part of Asteria.
+// Copyleft 2018 - 2020, LH_Mouse. All wrongs reserved.
+
+#include "benchmark_utilities.hpp"
+
+using namespace Asteria;
+
+int main()
+  {
+    benchmark_script("string/concatenate",
+      R"__(
+        var parts = [];
+        for(var i = 0;  i < 100000;  ++i) {
+          var s = "item" + std.string.format("$1", i);
+          parts[i % 64] = s + ":" + s;
+        }
+        return lengthof parts;
+      )__");
+
+    benchmark_script("string/copy",
+      R"__(
+        var base = "The quick brown fox jumps over the lazy dog.";
+        var obj = { };
+        for(var i = 0;  i < 100000;  ++i) {
+          var t = base;
+          obj.last = t;
+          var u = std.string.slice(obj.last, 4, 5);
+          obj.len = lengthof u;
+        }
+        return obj.len;
+      )__");
+  }
@@ -13,10 +13,63 @@ namespace rocket {
 
 template<typename valueT = long> class reference_counter;
 
+namespace details_reference_counter {
+
+// This class provides the subset of `std::atomic` that is used by `reference_counter`, without
+// any synchronization. It is used when `ROCKET_NO_ATOMIC_REFERENCE_COUNTS` is defined, in which
+// case no reference-counted object may be shared between threads.
+template<typename valueT> class plain_counter
+  {
+  private:
+    valueT m_val;
+
+  public:
+    explicit constexpr plain_counter(valueT val) noexcept
+      :
+        m_val(val)
+      {
+      }
+
+  public:
+    valueT load(::std::memory_order) const noexcept
+      {
+        return this->m_val;
+      }
+    valueT fetch_add(valueT val, ::std::memory_order) noexcept
+      {
+        auto old = this->m_val;
+        this->m_val = old + val;
+        return old;
+      }
+    valueT fetch_sub(valueT val, ::std::memory_order) noexcept
+      {
+        auto old = this->m_val;
+        this->m_val = old - val;
+        return old;
+      }
+    bool compare_exchange_weak(valueT& cmp, valueT xchg, ::std::memory_order) noexcept
+      {
+        if(this->m_val != cmp) {
+          cmp = this->m_val;
+          return false;
+        }
+        this->m_val = xchg;
+        return true;
+      }
+  };
+
+#ifdef ROCKET_NO_ATOMIC_REFERENCE_COUNTS
+template<typename valueT> using counter_storage = plain_counter<valueT>;
+#else
+template<typename valueT> using counter_storage = ::std::atomic<valueT>;
+#endif
+
+}  // namespace details_reference_counter
+
 template<typename valueT> class reference_counter
   {
   private:
-    ::std::atomic<valueT> m_nref;
+    details_reference_counter::counter_storage<valueT> m_nref;
 
   public:
     constexpr reference_counter() noexcept
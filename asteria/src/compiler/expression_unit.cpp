@@ -53,7 +53,15 @@ cow_vector<AIR_Node>& Expression_Unit::generate_code(cow_vector<AIR_Node>& code,
           qref = qctx->get_named_reference_opt(altr.name);
           if(qref) {
             // A reference declared later has been found. Record the context depth for later lookups.
-            AIR_Node::S_push_local_reference xnode = { depth, altr.name };
+            // If a slot has been assigned to it, record the slot too. Otherwise it has to be looked up
+            // by name, which is the case for pre-defined references such as `__varg`.
+            uint32_t slot = UINT32_MAX;
+            if(qctx->is_analytic()) {
+              auto qslot = static_cast<const Analytic_Context*>(qctx)->get_slot_opt(altr.name);
+              if(qslot)
+                slot = *qslot;
+            }
+            AIR_Node::S_push_local_reference xnode = { depth, altr.name, slot };
             code.emplace_back(::std::move(xnode));
             return code;
           }
@@ -91,12 +99,15 @@ cow_vector<AIR_Node>& Expression_Unit::generate_code(cow_vector<AIR_Node>& code,
           Analytic_Context ctx_func(::std::addressof(ctx), altr.params);
           // Generate code with regard to proper tail calls.
           for(size_t i = 0;  i < epos;  ++i) {
-            altr.body[i].generate_code(code_body, nullptr, ctx_func, opts,
+            altr.body[i].generate_code(code_body, ctx_func, opts,
                                        altr.body[i + 1].is_empty_return() ? ptc_aware_void : ptc_aware_none);
           }
-          altr.body[epos].generate_code(code_body, nullptr, ctx_func, opts, ptc_aware_void);
+          altr.body[epos].generate_code(code_body, ctx_func, opts, ptc_aware_void);
+        }
+        // Optimize the body unless disabled.
+        if(!opts.no_optimization) {
+          AIR_Node::optimize(code_body, opts);
         }
-        // TODO: Insert optimization passes.
         // Encode arguments.
         AIR_Node::S_define_function xnode = { altr.sloc, ::std::move(func), altr.params,
                                               ::std::move(code_body) };
@@ -13,8 +13,7 @@
 namespace Asteria {
 namespace {
 
-void do_user_declare(cow_vector<phsh_string>* names_opt, Analytic_Context& ctx,
-                     const phsh_string& name, const char* desc)
+uint32_t do_user_declare(Analytic_Context& ctx, const phsh_string& name, const char* desc)
   {
     if(name.rdstr().empty()) {
       ASTERIA_THROW("attempt to declare a nameless $1", desc);
@@ -22,16 +21,8 @@ void do_user_declare(cow_vector<phsh_string>* names_opt, Analytic_Context& ctx,
     if(name.rdstr().starts_with("__")) {
       ASTERIA_THROW("reserved name not declarable as $2 (name `$1`)", name);
     }
-    // Record this name.
-    if(names_opt) {
-      auto oldp = ::std::find(names_opt->begin(), names_opt->end(), name);
-      if(oldp != names_opt->end()) {
-        names_opt->erase(oldp);
-      }
-      names_opt->emplace_back(name);
-    }
-    // Just ensure the name exists.
-    ctx.open_named_reference(name) /*= Reference_root::S_void()*/;
+    // Allocate a slot for it.
+    return ctx.declare_slot(name);
   }
 
 cow_vector<AIR_Node>& do_generate_clear_stack(cow_vector<AIR_Node>& code)
@@ -81,28 +72,27 @@ cow_vector<AIR_Node> do_generate_expression(const Compiler_Options& opts, PTC_Aw
     return code;
   }
 
-cow_vector<AIR_Node>& do_generate_statement_list(cow_vector<AIR_Node>& code, cow_vector<phsh_string>* names_opt,
-                                                 Analytic_Context& ctx, const Compiler_Options& opts, PTC_Aware ptc,
+cow_vector<AIR_Node>& do_generate_statement_list(cow_vector<AIR_Node>& code, Analytic_Context& ctx,
+                                                 const Compiler_Options& opts, PTC_Aware ptc,
                                                  const Statement::S_block& block)
   {
     size_t epos = block.stmts.size() - 1;
     if(epos != SIZE_MAX) {
       // Statements other than the last one cannot be the end of function.
       for(size_t i = 0;  i < epos;  ++i) {
-        block.stmts[i].generate_code(code, names_opt, ctx, opts,
+        block.stmts[i].generate_code(code, ctx, opts,
                                      block.stmts[i+1].is_empty_return() ? ptc_aware_void : ptc_aware_none);
       }
-      block.stmts[epos].generate_code(code, names_opt, ctx, opts, ptc);
+      block.stmts[epos].generate_code(code, ctx, opts, ptc);
     }
     return code;
   }
 
-cow_vector<AIR_Node> do_generate_statement_list(cow_vector<phsh_string>* names_opt, Analytic_Context& ctx,
-                                                const Compiler_Options& opts, PTC_Aware ptc,
+cow_vector<AIR_Node> do_generate_statement_list(Analytic_Context& ctx, const Compiler_Options& opts, PTC_Aware ptc,
                                                 const Statement::S_block& block)
   {
     cow_vector<AIR_Node> code;
-    do_generate_statement_list(code, names_opt, ctx, opts, ptc, block);
+    do_generate_statement_list(code, ctx, opts, ptc, block);
     return code;
   }
 
@@ -117,7 +107,7 @@ cow_vector<AIR_Node>& do_generate_block(cow_vector<AIR_Node>& code, const Compil
     // Create a new context for the block. No new names are injected into `ctx`.
     if(block.stmts.size()) {
       Analytic_Context ctx_stmts(::rocket::ref(ctx), nullptr);
-      do_generate_statement_list(code, nullptr, ctx_stmts, opts, ptc, block);
+      do_generate_statement_list(code, ctx_stmts, opts, ptc, block);
     }
     return code;
   }
@@ -132,9 +122,8 @@ cow_vector<AIR_Node> do_generate_block(const Compiler_Options& opts, PTC_Aware p
 
 }  // namespace
 
-cow_vector<AIR_Node>& Statement::generate_code(cow_vector<AIR_Node>& code, cow_vector<phsh_string>* names_opt,
-                                               Analytic_Context& ctx, const Compiler_Options& opts,
-                                               PTC_Aware ptc) const
+cow_vector<AIR_Node>& Statement::generate_code(cow_vector<AIR_Node>& code, Analytic_Context& ctx,
+                                               const Compiler_Options& opts, PTC_Aware ptc) const
   {
     switch(this->index()) {
     case index_expression: {
@@ -183,14 +172,13 @@ cow_vector<AIR_Node>& Statement::generate_code(cow_vector<AIR_Node>& code, cow_v
           else {
             ROCKET_ASSERT(altr.decls[i].size() == 1);
           }
-          // Create dummy references for further name lookups.
-          for(size_t k = bpos;  k < epos;  ++k) {
-            do_user_declare(names_opt, ctx, altr.decls[i][k], "variable placeholder");
-          }
           if(altr.inits[i].units.empty()) {
             // If no initializer is provided, no further initialization is required.
             for(size_t k = bpos;  k < epos;  ++k) {
-              AIR_Node::S_define_null_variable xnode = { altr.immutable, altr.slocs[i], altr.decls[i][k] };
+              // Create a dummy reference for further name lookups.
+              auto slot = do_user_declare(ctx, altr.decls[i][k], "variable placeholder");
+              AIR_Node::S_define_null_variable xnode = { altr.immutable, altr.slocs[i], altr.decls[i][k], slot,
+                                                         false };
               code.emplace_back(::std::move(xnode));
             }
           }
@@ -199,7 +187,9 @@ cow_vector<AIR_Node>& Statement::generate_code(cow_vector<AIR_Node>& code, cow_v
             do_generate_clear_stack(code);
             // Push uninitialized variables from left to right.
             for(size_t k = bpos;  k < epos;  ++k) {
-              AIR_Node::S_declare_variable xnode = { altr.slocs[i], altr.decls[i][k] };
+              // Create a dummy reference for further name lookups.
+              auto slot = do_user_declare(ctx, altr.decls[i][k], "variable placeholder");
+              AIR_Node::S_declare_variable xnode = { altr.slocs[i], altr.decls[i][k], slot, false };
               code.emplace_back(::std::move(xnode));
             }
             // Generate code for the initializer.
@@ -226,9 +216,9 @@ cow_vector<AIR_Node>& Statement::generate_code(cow_vector<AIR_Node>& code, cow_v
     case index_function: {
         const auto& altr = this->m_stor.as<index_function>();
         // Create a dummy reference for further name lookups.
-        do_user_declare(names_opt, ctx, altr.name, "function placeholder");
+        auto slot = do_user_declare(ctx, altr.name, "function placeholder");
         // Declare the function, which is effectively an immutable variable.
-        AIR_Node::S_declare_variable xnode_decl = { altr.sloc, altr.name };
+        AIR_Node::S_declare_variable xnode_decl = { altr.sloc, altr.name, slot, false };
         code.emplace_back(::std::move(xnode_decl));
         // Prettify the function name.
         ::rocket::tinyfmt_str fmt;
@@ -250,12 +240,15 @@ cow_vector<AIR_Node>& Statement::generate_code(cow_vector<AIR_Node>& code, cow_v
           Analytic_Context ctx_func(::std::addressof(ctx), altr.params);
           // Generate code with regard to proper tail calls.
           for(size_t i = 0;  i < epos;  ++i) {
-            altr.body[i].generate_code(code_body, nullptr, ctx_func, opts,
+            altr.body[i].generate_code(code_body, ctx_func, opts,
                                        altr.body[i + 1].is_empty_return() ? ptc_aware_void : ptc_aware_none);
           }
-          altr.body[epos].generate_code(code_body, nullptr, ctx_func, opts, ptc_aware_void);
+          altr.body[epos].generate_code(code_body, ctx_func, opts, ptc_aware_void);
+        }
+        // Optimize the body unless disabled.
+        if(!opts.no_optimization) {
+          AIR_Node::optimize(code_body, opts);
         }
-        // TODO: Insert optimization passes.
         // Encode arguments.
         AIR_Node::S_define_function xnode_defn = { altr.sloc, ::std::move(func), altr.params,
                                                    ::std::move(code_body) };
@@ -290,26 +283,25 @@ cow_vector<AIR_Node>& Statement::generate_code(cow_vector<AIR_Node>& code, cow_v
         // Generate code for all clauses.
         cow_vector<cow_vector<AIR_Node>> code_labels;
         cow_vector<cow_vector<AIR_Node>> code_bodies;
-        cow_vector<cow_vector<phsh_string>> names_added;
         // Create a fresh context for the `switch` body.
         // Be advised that all clauses inside a `switch` statement share the same context.
         Analytic_Context ctx_body(::rocket::ref(ctx), nullptr);
-        cow_vector<phsh_string> names;
         // Get the number of clauses.
         auto nclauses = altr.labels.size();
         ROCKET_ASSERT(nclauses == altr.bodies.size());
         for(size_t i = 0;  i < nclauses;  ++i) {
           // Generate code for the label.
-          do_generate_expression(code_labels.emplace_back(), opts, ptc_aware_none, ctx_body, altr.labels[i]);
-          // Generate code for the clause and accumulate names.
+          // Note that the label of a `default` clause must yield empty code, even if single-step traps are enabled.
+          // Labels are evaluated in the enclosing context, so names declared in clauses are not visible.
+          auto& code_label = code_labels.emplace_back();
+          if(altr.labels[i].units.size())
+            do_generate_expression(code_label, opts, ptc_aware_none, ctx, altr.labels[i]);
+          // Generate code for the clause. Slots of names declared here are shared by all clauses.
           // This cannot be PTC'd.
-          do_generate_statement_list(code_bodies.emplace_back(), &names, ctx_body, opts, ptc_aware_none,
-                                     altr.bodies[i]);
-          names_added.emplace_back(names);
+          do_generate_statement_list(code_bodies.emplace_back(), ctx_body, opts, ptc_aware_none, altr.bodies[i]);
         }
         // Encode arguments.
-        AIR_Node::S_switch_statement xnode = { ::std::move(code_labels), ::std::move(code_bodies),
-                                               ::std::move(names_added) };
+        AIR_Node::S_switch_statement xnode = { ::std::move(code_labels), ::std::move(code_bodies) };
         code.emplace_back(::std::move(xnode));
         return code;
       }
@@ -347,8 +339,8 @@ cow_vector<AIR_Node>& Statement::generate_code(cow_vector<AIR_Node>& code, cow_v
         // Note that the key and value references outlasts every iteration, so we have to create
         // an outer contexts here.
         Analytic_Context ctx_for(::rocket::ref(ctx), nullptr);
-        do_user_declare(names_opt, ctx_for, altr.name_key, "key placeholder");
-        do_user_declare(names_opt, ctx_for, altr.name_mapped, "value placeholder");
+        auto slot_key = do_user_declare(ctx_for, altr.name_key, "key placeholder");
+        auto slot_mapped = do_user_declare(ctx_for, altr.name_mapped, "value placeholder");
         // Generate code for the range initializer.
         ROCKET_ASSERT(!altr.init.units.empty());
         auto code_init = do_generate_expression(opts, ptc_aware_none, ctx_for, altr.init);
@@ -356,8 +348,8 @@ cow_vector<AIR_Node>& Statement::generate_code(cow_vector<AIR_Node>& code, cow_v
         // Loop statements cannot be PTC'd.
         auto code_body = do_generate_block(opts, ptc_aware_none, ctx_for, altr.body);
         // Encode arguments.
-        AIR_Node::S_for_each_statement xnode = { altr.name_key, altr.name_mapped, ::std::move(code_init),
-                                                 ::std::move(code_body) };
+        AIR_Node::S_for_each_statement xnode = { altr.name_key, slot_key, altr.name_mapped, slot_mapped,
+                                                 ::std::move(code_init), ::std::move(code_body) };
         code.emplace_back(::std::move(xnode));
         return code;
       }
@@ -368,7 +360,7 @@ cow_vector<AIR_Node>& Statement::generate_code(cow_vector<AIR_Node>& code, cow_v
         // so we have to create an outer contexts here.
         Analytic_Context ctx_for(::rocket::ref(ctx), nullptr);
         // Generate code for the initializer, the condition and the loop increment.
-        auto code_init = do_generate_statement_list(nullptr, ctx_for, opts, ptc_aware_none, altr.init);
+        auto code_init = do_generate_statement_list(ctx_for, opts, ptc_aware_none, altr.init);
         auto code_cond = do_generate_expression(opts, ptc_aware_none, ctx_for, altr.cond);
         auto code_step = do_generate_expression(opts, ptc_aware_none, ctx_for, altr.step);
         // Generate code for the body.
@@ -387,13 +379,13 @@ cow_vector<AIR_Node>& Statement::generate_code(cow_vector<AIR_Node>& code, cow_v
         auto code_try = do_generate_block(opts, ptc, ctx, altr.body_try);
         // Create a fresh context for the `catch` clause.
         Analytic_Context ctx_catch(::rocket::ref(ctx), nullptr);
-        do_user_declare(names_opt, ctx_catch, altr.name_except, "exception placeholder");
+        auto slot_except = do_user_declare(ctx_catch, altr.name_except, "exception placeholder");
         ctx_catch.open_named_reference(::rocket::sref("__backtrace"));
         // Generate code for the `catch` body.
         // Unlike the `try` body, this may be PTC'd.
-        auto code_catch = do_generate_statement_list(nullptr, ctx_catch, opts, ptc, altr.body_catch);
+        auto code_catch = do_generate_statement_list(ctx_catch, opts, ptc, altr.body_catch);
         // Encode arguments.
-        AIR_Node::S_try_statement xnode = { ::std::move(code_try), altr.sloc, altr.name_except,
+        AIR_Node::S_try_statement xnode = { ::std::move(code_try), altr.sloc, altr.name_except, slot_except,
                                             ::std::move(code_catch) };
         code.emplace_back(::std::move(xnode));
         return code;
@@ -185,8 +185,8 @@ class Statement
         return *this;
       }
 
-    cow_vector<AIR_Node>& generate_code(cow_vector<AIR_Node>& code, cow_vector<phsh_string>* names_opt,
-                                        Analytic_Context& ctx, const Compiler_Options& opts, PTC_Aware ptc) const;
+    cow_vector<AIR_Node>& generate_code(cow_vector<AIR_Node>& code, Analytic_Context& ctx,
+                                        const Compiler_Options& opts, PTC_Aware ptc) const;
   };
 
 inline void swap(Statement& lhs, Statement& rhs) noexcept
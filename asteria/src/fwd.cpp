@@ -121,6 +121,43 @@ const char* describe_frame_type(Frame_Type type) noexcept
     }
   }
 
+const char* describe_gc_policy(GC_Policy policy) noexcept
+  {
+    switch(policy) {
+    case gc_policy_fixed: {
+        return "fixed";
+      }
+    case gc_policy_adaptive: {
+        return "adaptive";
+      }
+    default:
+      return "<unknown GC policy>";
+    }
+  }
+
+const char* describe_gc_decision(GC_Decision decision) noexcept
+  {
+    switch(decision) {
+    case gc_decision_none: {
+        return "none";
+      }
+    case gc_decision_keep: {
+        return "keep";
+      }
+    case gc_decision_grow_for_throughput: {
+        return "grow_for_throughput";
+      }
+    case gc_decision_shrink_for_pause: {
+        return "shrink_for_pause";
+      }
+    case gc_decision_shrink_for_footprint: {
+        return "shrink_for_footprint";
+      }
+    default:
+      return "<unknown GC decision>";
+    }
+  }
+
 const char* describe_parser_status(Parser_Status status) noexcept
   {
     switch(status) {
@@ -107,6 +107,7 @@ class Recursion_Sentry;
 
 // Low-level data structures
 class Variable_HashSet;
+class Variable_Arena;
 class Reference_Dictionary;
 class AVMC_Queue;
 
@@ -490,6 +491,27 @@ enum GC_Generation : uint8_t
     gc_generation_oldest  = 2,
   };
 
+// Garbage collection policies
+enum GC_Policy : uint8_t
+  {
+    gc_policy_fixed     = 0,  // Thresholds are only changed explicitly.
+    gc_policy_adaptive  = 1,  // Thresholds are tuned after each collection.
+  };
+
+ROCKET_PURE_FUNCTION extern const char* describe_gc_policy(GC_Policy policy) noexcept;
+
+// Decisions of adaptive garbage collection
+enum GC_Decision : uint8_t
+  {
+    gc_decision_none                  = 0,  // No decision has been made.
+    gc_decision_keep                  = 1,  // All goals have been met.
+    gc_decision_grow_for_throughput   = 2,  // Too much time has been spent on collection.
+    gc_decision_shrink_for_pause      = 3,  // The longest pause has exceeded its goal.
+    gc_decision_shrink_for_footprint  = 4,  // Collection is cheap and most variables have been collected.
+  };
+
+ROCKET_PURE_FUNCTION extern const char* describe_gc_decision(GC_Decision decision) noexcept;
+
 // Parser status codes
 enum Parser_Status : uint32_t
   {
@@ -597,12 +619,27 @@ template<> struct Compiler_Options_fragment<2>
     // Note: Please keep this struct as compact as possible.
   };
 
+template<> struct Compiler_Options_fragment<3>
+  {
+    // Resolve `std.<module>.<member>` to the value it designates when it is evaluated for the first time,
+    // and reuse it afterwards, as long as `std` still refers to the standard library. Functions obtained
+    // this way are called with a null `this`. This has no effect if `no_optimization` is set.
+    bool bind_std_members : 1;
+    // Lower operators whose operands are local variables, constants or other such operators to register-based
+    // nodes, which read operands from frame slots directly instead of pushing them onto the evaluation stack.
+    // This has no effect if `no_optimization` is set.
+    bool register_expressions : 1;
+
+    // Note: Please keep this struct as compact as possible.
+  };
+
 // These are aliases for historical versions.
 using Compiler_Options_v1 = Compiler_Options_template<1>;
 using Compiler_Options_v2 = Compiler_Options_template<2>;
+using Compiler_Options_v3 = Compiler_Options_template<3>;
 
 // This is always an alias for the latest version.
-using Compiler_Options = Compiler_Options_v2;
+using Compiler_Options = Compiler_Options_v3;
 
 // This value is initialized statically and never destroyed.
 extern const unsigned char null_value_storage[];
@@ -65,6 +65,75 @@ Ival std_gc_collect(Global& global, Iopt generation_limit)
     return static_cast<int64_t>(nvars);
   }
 
+Sval std_gc_get_policy(Global& global)
+  {
+    auto gcoll = global.generational_collector();
+    return ::rocket::sref(describe_gc_policy(gcoll->get_policy()));
+  }
+
+Sopt std_gc_set_policy(Global& global, Sval policy)
+  {
+    GC_Policy gc_policy;
+    if(policy == "fixed")
+      gc_policy = gc_policy_fixed;
+    else if(policy == "adaptive")
+      gc_policy = gc_policy_adaptive;
+    else
+      return nullopt;
+    // Set the policy and return its old value.
+    auto gcoll = global.generational_collector();
+    auto old = gcoll->get_policy();
+    gcoll->set_policy(gc_policy);
+    return ::rocket::sref(describe_gc_policy(old));
+  }
+
+Oopt std_gc_get_statistics(Global& global, Ival generation)
+  {
+    auto gc_gen = static_cast<GC_Generation>(::rocket::clamp(generation,
+                        static_cast<Ival>(gc_generation_newest), static_cast<Ival>(gc_generation_oldest)));
+    if(gc_gen != generation) {
+      return nullopt;
+    }
+    auto gcoll = global.generational_collector();
+    const auto& coll = gcoll->get_collector(gc_gen);
+    const auto& stats = coll.get_statistics();
+    // Convert the result to an `object`.
+    Oval result;
+    result.try_emplace(::rocket::sref("threshold"),
+      Ival(
+        coll.get_threshold()  // current threshold
+      ));
+    result.try_emplace(::rocket::sref("cycles"),
+      Ival(
+        static_cast<int64_t>(stats.cycles)  // number of cycles that have completed
+      ));
+    result.try_emplace(::rocket::sref("staged"),
+      Ival(
+        stats.staged  // number of variables examined in the last cycle
+      ));
+    result.try_emplace(::rocket::sref("collected"),
+      Ival(
+        stats.collected  // number of variables collected in the last cycle
+      ));
+    result.try_emplace(::rocket::sref("pause_us"),
+      Ival(
+        stats.pause_us  // longest step of the last cycle
+      ));
+    result.try_emplace(::rocket::sref("time_us"),
+      Ival(
+        stats.time_us  // total time of the last cycle
+      ));
+    result.try_emplace(::rocket::sref("interval_us"),
+      Ival(
+        stats.interval_us  // time between ends of the last two cycles
+      ));
+    result.try_emplace(::rocket::sref("decision"),
+      Sval(
+        ::rocket::sref(describe_gc_decision(stats.decision))  // how the threshold was changed
+      ));
+    return ::std::move(result);
+  }
+
 void create_bindings_gc(V_object& result, API_Version /*version*/)
   {
     //===================================================================
@@ -148,6 +217,8 @@ void create_bindings_gc(V_object& result, API_Version /*version*/)
     silently without failure. A larger `threshold` makes garbage
     collection run less often but slower. Setting `threshold` to
     `0` ensures all unreachable variables be collected immediately.
+    If the policy is `"adaptive"`, the threshold will be tuned
+    starting from `threshold`.
 
   * Returns the threshold before the call. If `generation` is not
     valid, `null` is returned.
@@ -178,6 +249,110 @@ void create_bindings_gc(V_object& result, API_Version /*version*/)
 
   * Returns the number of variables that have been collected in
     total.
+)'''''''''''''''"  """"""""""""""""""""""""""""""""""""""""""""""""
+      ));
+    //===================================================================
+    // `std.gc.get_policy()`
+    //===================================================================
+    result.insert_or_assign(::rocket::sref("get_policy"),
+      Fval(
+[](cow_vector<Reference>&& args, Reference&& /*self*/, Global& global) -> Value
+  {
+    Argument_Reader reader(::rocket::ref(args), ::rocket::sref("std.gc.get_policy"));
+    // Parse arguments.
+    if(reader.I().F()) {
+      return std_gc_get_policy(global);
+    }
+    // Fail.
+    reader.throw_no_matching_function_call();
+  },
+"""""""""""""""""""""""""""""""""""""""""""""""" R"'''''''''''''''(
+`std.gc.get_policy()`
+
+  * Gets the policy by which thresholds of all generations are
+    managed.
+
+  * Returns the policy as a string, which is either `"fixed"` or
+    `"adaptive"`.
+)'''''''''''''''"  """"""""""""""""""""""""""""""""""""""""""""""""
+      ));
+    //===================================================================
+    // `std.gc.set_policy()`
+    //===================================================================
+    result.insert_or_assign(::rocket::sref("set_policy"),
+      Fval(
+[](cow_vector<Reference>&& args, Reference&& /*self*/, Global& global) -> Value
+  {
+    Argument_Reader reader(::rocket::ref(args), ::rocket::sref("std.gc.set_policy"));
+    // Parse arguments.
+    Sval policy;
+    if(reader.I().v(policy).F()) {
+      return std_gc_set_policy(global, ::std::move(policy));
+    }
+    // Fail.
+    reader.throw_no_matching_function_call();
+  },
+"""""""""""""""""""""""""""""""""""""""""""""""" R"'''''''''''''''(
+`std.gc.set_policy(policy)`
+
+  * Sets the policy by which thresholds of all generations are
+    managed. If `policy` is `"fixed"`, thresholds are only changed
+    by `std.gc.set_threshold()`. If `policy` is `"adaptive"`, the
+    threshold of a generation is tuned after each collection: It is
+    lowered if the collection paused the program for too long, and
+    is raised if too much time has been spent on collection. It is
+    also lowered slightly if collection is cheap and most variables
+    are collected, in order to save memory. `"adaptive"` is the
+    default policy.
+
+  * Returns the policy before the call. If `policy` is not valid,
+    `null` is returned.
+)'''''''''''''''"  """"""""""""""""""""""""""""""""""""""""""""""""
+      ));
+    //===================================================================
+    // `std.gc.get_statistics()`
+    //===================================================================
+    result.insert_or_assign(::rocket::sref("get_statistics"),
+      Fval(
+[](cow_vector<Reference>&& args, Reference&& /*self*/, Global& global) -> Value
+  {
+    Argument_Reader reader(::rocket::ref(args), ::rocket::sref("std.gc.get_statistics"));
+    // Parse arguments.
+    Ival generation;
+    if(reader.I().v(generation).F()) {
+      return std_gc_get_statistics(global, ::std::move(generation));
+    }
+    // Fail.
+    reader.throw_no_matching_function_call();
+  },
+"""""""""""""""""""""""""""""""""""""""""""""""" R"'''''''''''''''(
+`std.gc.get_statistics(generation)`
+
+  * Gets statistics of the collector for `generation`. Valid values
+    for `generation` are `0`, `1` and `2`.
+
+  * Returns an object consisting of the following fields:
+
+    * `threshold`   integer: the current threshold
+    * `cycles`      integer: number of collections that have
+                    completed
+    * `staged`      integer: number of variables examined in the
+                    last collection
+    * `collected`   integer: number of variables collected in the
+                    last collection
+    * `pause_us`    integer: longest pause of the last collection,
+                    in microseconds
+    * `time_us`     integer: total time of the last collection, in
+                    microseconds
+    * `interval_us` integer: time between ends of the last two
+                    collections, in microseconds
+    * `decision`    string: how the threshold was changed after the
+                    last collection, which is one of `"none"`,
+                    `"keep"`, `"grow_for_throughput"`,
+                    `"shrink_for_pause"` and
+                    `"shrink_for_footprint"`
+
+    If `generation` is not valid, `null` is returned.
 )'''''''''''''''"  """"""""""""""""""""""""""""""""""""""""""""""""
       ));
     //===================================================================
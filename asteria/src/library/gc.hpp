@@ -12,6 +12,9 @@ Iopt std_gc_tracked_count(Global& global, Ival generation);
 Iopt std_gc_get_threshold(Global& global, Ival generation);
 Iopt std_gc_set_threshold(Global& global, Ival generation, Ival threshold);
 Ival std_gc_collect(Global& global, Iopt generation_limit);
+Sval std_gc_get_policy(Global& global);
+Sopt std_gc_set_policy(Global& global, Sval policy);
+Oopt std_gc_get_statistics(Global& global, Ival generation);
 
 // Create an object that is to be referenced as `std.gc`.
 void create_bindings_gc(V_object& result, API_Version version);
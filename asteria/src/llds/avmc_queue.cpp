@@ -4,19 +4,371 @@
 #include "../precompiled.hpp"
 #include "avmc_queue.hpp"
 #include "../runtime/variable_callback.hpp"
+#include "../runtime/executive_context.hpp"
+#include "../runtime/global_context.hpp"
 #include "../utilities.hpp"
 
+// Unwind information of native code is registered with `__register_frame()`, which takes a list of CIEs and
+// FDEs in libgcc, but a single FDE in other unwinders. The configure script checks for the former.
+#if defined(__x86_64__) && defined(__linux__) && defined(HAVE_REGISTER_FRAME_LIST) && defined(HAVE_MEMFD_CREATE)  \
+    && !defined(ASTERIA_NO_JIT)
+#  define ASTERIA_AVMC_JIT_  1
+#  include <sys/mman.h>  // ::memfd_create(), ::mmap(), ::munmap()
+#  include <unistd.h>  // ::ftruncate(), ::close()
+#  include <mutex>  // ::std::mutex, ::std::lock_guard
+extern "C" void __register_frame(void* frame);
+extern "C" void __deregister_frame(void* frame);
+#endif
+
 namespace Asteria {
+namespace {
+
+// This is the maximum number of nodes that may be executed by threaded code before control is
+// returned to the dispatch loop. If it is zero, each node returns to the dispatch loop.
+// Threaded dispatch relies on sibling call optimization, which is not performed without optimization.
+#if defined(__OPTIMIZE__) && !defined(ASTERIA_NO_THREADED_DISPATCH)
+constexpr size_t nthread_max = 64;
+#else
+constexpr size_t nthread_max = 0;
+#endif
+
+// A queue is translated into native code after it has been executed this number of times.
+// Queues that consist of fewer nodes than `jit_nnodes_min` are never translated.
+constexpr uint32_t jit_threshold = 200;
+constexpr size_t jit_nnodes_min = 4;
+
+// This is stored in `paramv` of the sentinel. Like the rest of a queue, it is not safe for concurrent execution.
+struct Jit_State
+  {
+    void* native;  // native code, or a null pointer
+    uint32_t nexec;  // number of executions
+  };
+
+static_assert(sizeof(Jit_State) <= 16, "");
+
+Jit_State& do_get_jit_state(const void* paramv) noexcept
+  {
+    return *static_cast<Jit_State*>(const_cast<void*>(paramv));
+  }
+
+#ifdef ASTERIA_AVMC_JIT_
+
+// Native code is generated by copying these stencils and patching their holes. Nodes are not translated
+// individually, as their parameters are C++ objects. Instead, native code of a queue calls the threaded code
+// of each node with `nleft` set to zero, as in:
+//
+//   void native(AIR_Status& status, Executive_Context& ctx)
+//     {
+//       if(!node_1->thrd(status, ctx, node_1, 0))
+//         return;
+//       if(!node_2->thrd(status, ctx, node_2, 0))
+//         return;
+//       ...
+//     }
+//
+// Every call has a fixed target, so, unlike threaded code, it is easily predicted by the processor.
+using Native_Function = void (AIR_Status& status, Executive_Context& ctx);
+
+constexpr unsigned char s_stencil_prologue[] =
+  {
+    0x53,                          // push rbx
+    0x41, 0x54,                    // push r12
+    0x48, 0x83, 0xEC, 0x08,        // sub rsp, 8
+    0x48, 0x89, 0xFB,              // mov rbx, rdi
+    0x49, 0x89, 0xF4,              // mov r12, rsi
+  };
+
+constexpr unsigned char s_stencil_node_qnode[] =
+  {
+    0x48, 0x89, 0xDF,              // mov rdi, rbx
+    0x4C, 0x89, 0xE6,              // mov rsi, r12
+    0x48, 0xBA,                    // movabs rdx, <qnode>
+  };
+
+constexpr unsigned char s_stencil_node_thrd[] =
+  {
+    0x31, 0xC9,                    // xor ecx, ecx
+    0x48, 0xB8,                    // movabs rax, <thrd>
+  };
+
+constexpr unsigned char s_stencil_node_call[] =
+  {
+    0xFF, 0xD0,                    // call rax
+    0x48, 0x85, 0xC0,              // test rax, rax
+    0x0F, 0x84,                    // jz <epilogue>
+  };
+
+constexpr unsigned char s_stencil_epilogue[] =
+  {
+    0x48, 0x83, 0xC4, 0x08,        // add rsp, 8
+    0x41, 0x5C,                    // pop r12
+    0x5B,                          // pop rbx
+    0xC3,                          // ret
+  };
+
+// Exceptions may be thrown through native code, so unwind information must be provided.
+// This is a common information entry (CIE) for `.eh_frame`.
+constexpr unsigned char s_frame_cie[] =
+  {
+    0x01,                          // version
+    'z', 'R', 0x00,                // augmentation
+    0x01,                          // code alignment factor
+    0x78,                          // data alignment factor (-8)
+    0x10,                          // return address register (rip)
+    0x01,                          // augmentation data length
+    0x00,                          // pointer encoding (DW_EH_PE_absptr)
+    0x0C, 0x07, 0x08,              // DW_CFA_def_cfa: rsp + 8
+    0x90, 0x01,                    // DW_CFA_offset: rip at CFA - 8
+  };
+
+// A single FDE covers all code in a chunk, so it describes the frame after the prologue above, which is
+// where all calls are made. It is not accurate in prologues and epilogues, where no exception may occur.
+constexpr unsigned char s_frame_fde[] =
+  {
+    0x00,                          // augmentation data length
+    0x0E, 0x20,                    // DW_CFA_def_cfa_offset: 32
+    0x83, 0x02,                    // DW_CFA_offset: rbx at CFA - 16
+    0x8C, 0x03,                    // DW_CFA_offset: r12 at CFA - 24
+  };
+
+template<typename valueT> void do_put_value(cow_string& buf, const valueT& value)
+  {
+    buf.append(reinterpret_cast<const char*>(::std::addressof(value)), sizeof(value));
+  }
+
+template<size_t N> void do_put_bytes(cow_string& buf, const unsigned char (&bytes)[N])
+  {
+    buf.append(reinterpret_cast<const char*>(bytes), N);
+  }
+
+void do_put_padding(cow_string& buf, size_t align)
+  {
+    // `DW_CFA_nop` and `nop` are both zero.
+    buf.append((align - buf.size() % align) % align, '\0');
+  }
+
+void do_patch_value(cow_string& buf, size_t offset, uint32_t value)
+  {
+    ::std::memcpy(buf.mut_data() + offset, &value, sizeof(value));
+  }
+
+cow_string& do_generate_frame(cow_string& buf, uintptr_t pc_begin, uintptr_t pc_range)
+  {
+    // Write the CIE.
+    do_put_value(buf, uint32_t(0));  // length (to be patched)
+    do_put_value(buf, uint32_t(0));  // CIE ID
+    do_put_bytes(buf, s_frame_cie);
+    do_put_padding(buf, 8);
+    do_patch_value(buf, 0, static_cast<uint32_t>(buf.size() - 4));
+    // Write the FDE.
+    auto off_fde = buf.size();
+    do_put_value(buf, uint32_t(0));  // length (to be patched)
+    do_put_value(buf, static_cast<uint32_t>(buf.size()));  // offset to the CIE
+    do_put_value(buf, pc_begin);
+    do_put_value(buf, pc_range);
+    do_put_bytes(buf, s_frame_fde);
+    do_put_padding(buf, 8);
+    do_patch_value(buf, off_fde, static_cast<uint32_t>(buf.size() - off_fde - 4));
+    // Terminate the list.
+    do_put_value(buf, uint32_t(0));
+    return buf;
+  }
+
+// Native code is allocated from chunks that are shared by all queues. Each chunk is mapped twice, once
+// writable and once executable, so new code may be written while other threads are executing old code in
+// the same chunk. Unwind information is placed at the beginning of a chunk, and is registered once.
+// Space of released code is not reused. A chunk is unmapped after all code in it has been released, unless
+// it is the one where new code is allocated.
+constexpr size_t jit_chunk_size = 0x40000;
+constexpr size_t jit_frame_size = 0x100;
+
+struct Code_Chunk
+  {
+    size_t nbytes;  // size of each mapping
+    size_t nused;  // size of allocated space, including unwind information
+    size_t nlive;  // number of allocations that have not been released
+    char* wbase;  // writable view
+    char* xbase;  // executable view
+  };
+
+// This is what a queue holds.
+struct Native_Code
+  {
+    Code_Chunk* chunk;
+    Native_Function* entry;
+  };
+
+// These are protected by `s_jit_mutex`.
+::std::mutex s_jit_mutex;
+Code_Chunk* s_jit_chunk;
+
+Code_Chunk* do_create_chunk(size_t nbytes)
+  {
+    // Create an anonymous file and map it twice. Some systems don't allow executable mappings.
+    int fd = ::memfd_create("asteria-jit", MFD_CLOEXEC);
+    if(fd == -1)
+      return nullptr;
+    char* wbase = nullptr;
+    char* xbase = nullptr;
+    if(::ftruncate(fd, static_cast<::off_t>(nbytes)) == 0) {
+      auto ptr = ::mmap(nullptr, nbytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      if(ptr != MAP_FAILED)
+        wbase = static_cast<char*>(ptr);
+      ptr = ::mmap(nullptr, nbytes, PROT_READ | PROT_EXEC, MAP_SHARED, fd, 0);
+      if(ptr != MAP_FAILED)
+        xbase = static_cast<char*>(ptr);
+    }
+    ::close(fd);
+    if(!wbase || !xbase) {
+      if(wbase)
+        ::munmap(wbase, nbytes);
+      if(xbase)
+        ::munmap(xbase, nbytes);
+      return nullptr;
+    }
+
+    // Write and register unwind information for all code in this chunk.
+    cow_string frame;
+    do_generate_frame(frame, reinterpret_cast<uintptr_t>(xbase + jit_frame_size), nbytes - jit_frame_size);
+    ROCKET_ASSERT(frame.size() <= jit_frame_size);
+    ::std::memcpy(wbase, frame.data(), frame.size());
+    __register_frame(xbase);
+
+    auto chunk = new Code_Chunk;
+    chunk->nbytes = nbytes;
+    chunk->nused = jit_frame_size;
+    chunk->nlive = 0;
+    chunk->wbase = wbase;
+    chunk->xbase = xbase;
+    return chunk;
+  }
+
+void do_destroy_chunk(Code_Chunk* chunk) noexcept
+  {
+    __deregister_frame(chunk->xbase);
+    ::munmap(chunk->xbase, chunk->nbytes);
+    ::munmap(chunk->wbase, chunk->nbytes);
+    delete chunk;
+  }
+
+Native_Code* do_allocate_native(const cow_string& code)
+  {
+    ::std::lock_guard<::std::mutex> lock(s_jit_mutex);
+    // Allocate a new chunk if there isn't enough room in the current one. Large code gets a chunk of its own,
+    // which is released as soon as possible.
+    uptr<Native_Code> qcode(new Native_Code);
+    auto chunk = s_jit_chunk;
+    auto nalign = (code.size() + 15) / 16 * 16;
+    if(!chunk || (chunk->nbytes - chunk->nused < nalign)) {
+      auto nbytes = ::rocket::max(jit_chunk_size, (jit_frame_size + nalign + 0xFFF) / 0x1000 * 0x1000);
+      chunk = do_create_chunk(nbytes);
+      if(!chunk)
+        return nullptr;
+      if(nbytes == jit_chunk_size) {
+        if(s_jit_chunk && (s_jit_chunk->nlive == 0))
+          do_destroy_chunk(s_jit_chunk);
+        s_jit_chunk = chunk;
+      }
+    }
+    qcode->chunk = chunk;
+    qcode->entry = reinterpret_cast<Native_Function*>(chunk->xbase + chunk->nused);
+    ::std::memcpy(chunk->wbase + chunk->nused, code.data(), code.size());
+    chunk->nused += nalign;
+    chunk->nlive += 1;
+    return qcode.release();
+  }
+
+void do_free_native(Native_Code* qcode) noexcept
+  {
+    ::std::lock_guard<::std::mutex> lock(s_jit_mutex);
+    auto chunk = qcode->chunk;
+    delete qcode;
+    if((--(chunk->nlive) == 0) && (chunk != s_jit_chunk))
+      do_destroy_chunk(chunk);
+  }
+
+#endif  // ASTERIA_AVMC_JIT_
+
+}  // namespace
+
+const AVMC_Queue::Header* AVMC_Queue::do_thread_end(AIR_Status& /*status*/, Executive_Context& /*ctx*/,
+                                                    const Header* /*qnode*/, size_t /*nleft*/)
+  {
+    // This is the sentinel at the end of a queue. All nodes have been executed.
+    return nullptr;
+  }
+
+void* AVMC_Queue::do_compile_native(const Header* bptr, const Header* eptr)
+  {
+#ifdef ASTERIA_AVMC_JIT_
+    // Don't bother with short queues.
+    size_t nnodes = 0;
+    for(auto qnode = bptr;  qnode != eptr;  qnode += qnode->nphdrs + size_t(1))
+      ++nnodes;
+    if(nnodes < jit_nnodes_min)
+      return nullptr;
+
+    // Generate code.
+    cow_string code;
+    cow_vector<size_t> holes;
+    do_put_bytes(code, s_stencil_prologue);
+    for(auto qnode = bptr;  qnode != eptr;  qnode += qnode->nphdrs + size_t(1)) {
+      do_put_bytes(code, s_stencil_node_qnode);
+      do_put_value(code, qnode);
+      do_put_bytes(code, s_stencil_node_thrd);
+      do_put_value(code, qnode->thrd);
+      do_put_bytes(code, s_stencil_node_call);
+      holes.emplace_back(code.size());
+      do_put_value(code, uint32_t(0));  // displacement (to be patched)
+    }
+    for(auto off : holes)
+      do_patch_value(code, off, static_cast<uint32_t>(code.size() - off - 4));
+    do_put_bytes(code, s_stencil_epilogue);
+
+    // Copy code into executable memory.
+    return do_allocate_native(code);
+#else
+    (void)bptr;
+    (void)eptr;
+    return nullptr;
+#endif
+  }
+
+void AVMC_Queue::do_execute_native(const void* native, AIR_Status& status, Executive_Context& ctx)
+  {
+#ifdef ASTERIA_AVMC_JIT_
+    (*(static_cast<const Native_Code*>(native)->entry))(status, ctx);
+#else
+    // This is never called, as no native code is ever generated.
+    (void)native;
+    (void)status;
+    (void)ctx;
+#endif
+  }
+
+void AVMC_Queue::do_release_native(void* native) noexcept
+  {
+#ifdef ASTERIA_AVMC_JIT_
+    do_free_native(static_cast<Native_Code*>(native));
+#else
+    (void)native;
+#endif
+  }
 
 void AVMC_Queue::do_deallocate_storage() const
   {
     auto bptr = this->m_stor.bptr;
     auto eptr = bptr + this->m_stor.nused;
+    // Release native code if any.
+    auto native = do_get_jit_state(eptr->get_paramv()).native;
+    if(native) {
+      do_release_native(native);
+    }
     // Destroy all nodes.
     auto qnode = bptr;
     while(ROCKET_EXPECT(qnode != eptr)) {
       // Call the destructor for this node.
-      auto dtor = qnode->has_vtbl ? qnode->vtbl->dtor : nullptr;
+      auto dtor = qnode->has_vtbl ? qnode->get_vtable()->dtor : nullptr;
       if(ROCKET_UNEXPECT(dtor))
         (*dtor)(qnode->get_paramu(), qnode->get_paramv());
       qnode += qnode->nphdrs + size_t(1);
@@ -30,18 +382,35 @@ void AVMC_Queue::do_deallocate_storage() const
 void AVMC_Queue::do_execute_all_break(AIR_Status& status, Executive_Context& ctx) const
   {
     auto bptr = this->m_stor.bptr;
+    if(!bptr)
+      return;
+    // If native code is available, use it. Otherwise, check whether this queue is hot enough.
     auto eptr = bptr + this->m_stor.nused;
-    // Execute all nodes.
-    auto qnode = bptr;
-    while(ROCKET_EXPECT(qnode != eptr)) {
-      // Call the executor function for this node.
-      auto exec = qnode->has_vtbl ? qnode->vtbl->exec : qnode->exec;
-      ROCKET_ASSERT(exec);
-      status = (*exec)(ctx, qnode->get_paramu(), qnode->get_paramv());
-      if(ROCKET_UNEXPECT(status != air_status_next))
-        return;
-      qnode += qnode->nphdrs + size_t(1);
+    auto& jit = do_get_jit_state(eptr->get_paramv());
+    if(ROCKET_UNEXPECT(jit.native) && ctx.global().is_jit_enabled()) {
+      ctx.global().note_native_execution();
+      return do_execute_native(jit.native, status, ctx);
     }
+    if(ROCKET_EXPECT(jit.nexec < jit_threshold)) {
+      jit.nexec++;
+    }
+    else if((jit.nexec == jit_threshold) && ctx.global().is_jit_enabled()) {
+      // If native code cannot be generated, don't try again.
+      jit.nexec++;
+      jit.native = do_compile_native(bptr, eptr);
+      if(jit.native) {
+        ctx.global().note_native_queue();
+        ctx.global().note_native_execution();
+        return do_execute_native(jit.native, status, ctx);
+      }
+    }
+    // Execute all nodes. Each call executes a run of nodes and returns the first node that has
+    // not been executed, or a null pointer if either the end has been reached or execution shall
+    // not continue. The queue is terminated by a sentinel, so no bound check is necessary here.
+    const Header* qnode = bptr;
+    do
+      qnode = (*(qnode->thrd))(status, ctx, qnode, nthread_max);
+    while(ROCKET_EXPECT(qnode));
   }
 
 void AVMC_Queue::do_enumerate_variables(Variable_Callback& callback) const
@@ -52,7 +421,7 @@ void AVMC_Queue::do_enumerate_variables(Variable_Callback& callback) const
     auto qnode = bptr;
     while(ROCKET_EXPECT(qnode != eptr)) {
       // Call the enumerator function for this node.
-      auto vnum = qnode->has_vtbl ? qnode->vtbl->vnum : nullptr;
+      auto vnum = qnode->has_vtbl ? qnode->get_vtable()->vnum : nullptr;
       if(ROCKET_UNEXPECT(vnum))
         (*vnum)(callback, qnode->get_paramu(), qnode->get_paramv());
       qnode += qnode->nphdrs + size_t(1);
@@ -66,8 +435,13 @@ void AVMC_Queue::do_reserve_delta(size_t nbytes)
     if(this->m_stor.bptr) {
       ASTERIA_THROW("AVMC queue not resizable");
     }
+    // A node with a non-trivial parameter stores a pointer to its vtable after the parameter.
+    // As we don't know whether the parameter is trivial, reserve space for it anyway.
+    if(nbytes != 0) {
+      nbytes = do_get_nbytes_with_vtable(nbytes);
+    }
     constexpr auto nbytes_hdr = sizeof(Header);
-    constexpr auto nbytes_max = nbytes_hdr * nphdrs_max;
+    constexpr auto nbytes_max = nbytes_hdr * (nphdrs_max - 1);
     if(nbytes > nbytes_max) {
       ASTERIA_THROW("invalid AVMC node size (`$1` > `$2`)", nbytes, nbytes_max);
     }
@@ -85,8 +459,10 @@ AVMC_Queue::Header* AVMC_Queue::do_check_storage_for_paramv(size_t nbytes)
     auto bptr = this->m_stor.bptr;
     // If no storage has been allocated so far, it shall be allocated now.
     if(ROCKET_UNEXPECT(!bptr)) {
-      bptr = static_cast<Header*>(::operator new(nbytes_hdr * this->m_stor.nrsrv));
+      // Reserve two extra headers for the sentinel.
+      bptr = static_cast<Header*>(::operator new(nbytes_hdr * (this->m_stor.nrsrv + size_t(2))));
       this->m_stor.bptr = bptr;
+      this->do_terminate();
     }
     auto qnode = bptr + this->m_stor.nused;
     // Check the number of available headers.
@@ -98,7 +474,21 @@ AVMC_Queue::Header* AVMC_Queue::do_check_storage_for_paramv(size_t nbytes)
     return qnode;
   }
 
-void AVMC_Queue::do_append_trivial(Executor* exec, AVMC_Queue::ParamU paramu, size_t nbytes, const void* source)
+void AVMC_Queue::do_terminate() noexcept
+  {
+    // Append a sentinel after the last node, which will be overwritten by the next one.
+    auto qend = this->m_stor.bptr + this->m_stor.nused;
+    qend->nphdrs = 1;
+    qend->has_vtbl = false;
+    qend->paramu_x16 = 0;
+    qend->paramu_x32 = 0;
+    qend->thrd = do_thread_end;
+    auto& jit = *::rocket::construct_at(static_cast<Jit_State*>(qend->get_paramv()));
+    jit.native = nullptr;
+    jit.nexec = 0;
+  }
+
+void AVMC_Queue::do_append_trivial(Thread* thrd, AVMC_Queue::ParamU paramu, size_t nbytes, const void* source)
   {
     auto qnode = this->AVMC_Queue::do_check_storage_for_paramv(nbytes);
     auto nbytes_node = static_cast<uint32_t>(qnode->nphdrs + size_t(1));
@@ -106,28 +496,31 @@ void AVMC_Queue::do_append_trivial(Executor* exec, AVMC_Queue::ParamU paramu, si
     qnode->has_vtbl = false;
     qnode->paramu_x16 = paramu.x16;
     qnode->paramu_x32 = paramu.x32;
-    qnode->exec = exec;
+    qnode->thrd = thrd;
     // Copy source data if any.
     if(nbytes != 0) {
       ::std::memcpy(qnode->paramv, source, nbytes);
     }
     this->m_stor.nused += nbytes_node;
+    this->do_terminate();
   }
 
-void AVMC_Queue::do_append_nontrivial(ref_to<const Vtable> vtbl, AVMC_Queue::ParamU paramu, size_t nbytes,
-                                      Constructor* ctor, intptr_t source)
+void AVMC_Queue::do_append_nontrivial(ref_to<const Vtable> vtbl, Thread* thrd, AVMC_Queue::ParamU paramu,
+                                      size_t nbytes, Constructor* ctor, intptr_t source)
   {
-    auto qnode = this->AVMC_Queue::do_check_storage_for_paramv(nbytes);
+    auto qnode = this->AVMC_Queue::do_check_storage_for_paramv(do_get_nbytes_with_vtable(nbytes));
     auto nbytes_node = static_cast<uint32_t>(qnode->nphdrs + size_t(1));
     // Initialize the node.
     qnode->has_vtbl = true;
     qnode->paramu_x16 = paramu.x16;
     qnode->paramu_x32 = paramu.x32;
-    qnode->vtbl = vtbl.ptr();
+    qnode->thrd = thrd;
+    reinterpret_cast<const Vtable**>(qnode + nbytes_node)[-1] = vtbl.ptr();
     // Invoke the constructor if any, which is subject to exceptions.
     if(ROCKET_EXPECT(ctor))
       (*ctor)(paramu, qnode->paramv, source);
     this->m_stor.nused += nbytes_node;
+    this->do_terminate();
   }
 
 }  // namespace Asteria
@@ -9,6 +9,11 @@
 
 namespace Asteria {
 
+// Nodes may cache data that depend on the global context, such as results of name lookups, type feedback and
+// compiled function bodies. These caches are not synchronized, so a queue, as well as a script or function that
+// owns it, shall not be executed by multiple threads concurrently. A queue may be executed by different global
+// contexts one after another, as caches of name lookups are keyed by generation numbers of dictionaries, which
+// are unique.
 class AVMC_Queue
   {
   public:
@@ -36,7 +41,6 @@ class AVMC_Queue
     struct Vtable
       {
         Destructor* dtor;
-        Executor* exec;
         Enumerator* vnum;
       };
     static_assert(::std::is_trivial<Vtable>::value, "");
@@ -47,17 +51,20 @@ class AVMC_Queue
         nphdrs_max = 0x100,  // maximum value of `Header::nphdrs`
       };
 
+    struct Header;
+
+    // This is the prototype of threaded code. Each node is executed by a specialization of `do_thread()`,
+    // which then jumps to the next node directly, until `nleft` reaches zero.
+    using Thread  = const Header* (AIR_Status& status, Executive_Context& ctx, const Header* qnode, size_t nleft);
+
     struct Header
       {
         uint16_t nphdrs : 8;  // size of `paramv`, in number of `Header`s [!]
-        uint16_t has_vtbl : 1;  // vtable exists?
+        uint16_t has_vtbl : 1;  // vtable exists? (stored in the last pointer of `paramv`)
         uint16_t : 7;
         uint16_t paramu_x16;  // user-defined data [1]
         uint32_t paramu_x32;  // user-defined data [2]
-        union {
-          Executor* exec;  // active if `has_vtbl`
-          const Vtable* vtbl;  // active otherwise
-        };
+        Thread* thrd;  // threaded code
         alignas(max_align_t) mutable intptr_t paramv[];  // user-defined data [3]
 
         constexpr ParamU get_paramu() const noexcept
@@ -68,6 +75,11 @@ class AVMC_Queue
           {
             return this->paramv;
           }
+        const Vtable* get_vtable() const noexcept
+          {
+            ROCKET_ASSERT(this->has_vtbl);
+            return reinterpret_cast<const Vtable* const*>(this + 1 + this->nphdrs)[-1];
+          }
       };
 
     struct Storage
@@ -106,20 +118,52 @@ class AVMC_Queue
       }
 
   private:
+    template<Executor execT>
+        static const Header* do_thread(AIR_Status& status, Executive_Context& ctx, const Header* qnode, size_t nleft)
+      {
+        // Execute this node.
+        status = (*execT)(ctx, qnode->get_paramu(), qnode->get_paramv());
+        if(ROCKET_UNEXPECT(status != air_status_next))
+          return nullptr;
+        // Proceed to the next node. If the budget has been used up, return it to the dispatch loop.
+        // This way, the depth of the call stack remains bounded in case that the compiler fails to
+        // turn the call below into a jump.
+        qnode += qnode->nphdrs + size_t(1);
+        if(ROCKET_UNEXPECT(nleft == 0))
+          return qnode;
+        return (*(qnode->thrd))(status, ctx, qnode, nleft - 1);
+      }
+    static const Header* do_thread_end(AIR_Status& status, Executive_Context& ctx, const Header* qnode, size_t nleft);
+
+    // These manage native code that has been generated from a queue, whose address is stored in the
+    // sentinel. If native code generation is not supported, `do_compile_native()` returns a null pointer.
+    static void* do_compile_native(const Header* bptr, const Header* eptr);
+    static void do_execute_native(const void* native, AIR_Status& status, Executive_Context& ctx);
+    static void do_release_native(void* native) noexcept;
+
+    static constexpr size_t do_get_nbytes_with_vtable(size_t nbytes) noexcept
+      {
+        return (nbytes + sizeof(void*) - 1) / sizeof(void*) * sizeof(void*) + sizeof(const Vtable*);
+      }
+
     void do_deallocate_storage() const;
     void do_execute_all_break(AIR_Status& status, Executive_Context& ctx) const;
     void do_enumerate_variables(Variable_Callback& callback) const;
 
     // Reserve storage for another node. `nbytes` is the size of `paramv` to reserve in bytes.
+    // If `nbytes` is non-zero, additional space for a vtable pointer is reserved as well.
     // Note: All calls to this function must precede calls to `do_check_storage_for_paramv()`.
     void do_reserve_delta(size_t nbytes);
     // Allocate storage for all nodes that have been reserved so far, then checks whether there is enough room
     // for a new node with `paramv` whose size is `nbytes` in bytes. An exception is thrown in case of failure.
     Header* do_check_storage_for_paramv(size_t nbytes);
+    // Put a sentinel after the last node. The sentinel also counts how many times the queue has been
+    // executed, and holds native code that has been generated for it.
+    void do_terminate() noexcept;
     // Append a new node to the end. `nbytes` is the size of `paramv` to initialize in bytes.
     // Note: The storage must have been reserved using `do_reserve_delta()`.
-    void do_append_trivial(Executor* exec, ParamU paramu, size_t nbytes, const void* source);
-    void do_append_nontrivial(ref_to<const Vtable> vtbl, ParamU paramu, size_t nbytes,
+    void do_append_trivial(Thread* thrd, ParamU paramu, size_t nbytes, const void* source);
+    void do_append_nontrivial(ref_to<const Vtable> vtbl, Thread* thrd, ParamU paramu, size_t nbytes,
                               Constructor* ctor, intptr_t source);
 
     template<Executor execT, nullptr_t, typename XNodeT>
@@ -127,7 +171,7 @@ class AVMC_Queue
       {
         // The parameter type is trivial and no vtable is required.
         // Append a node with a trivial parameter.
-        this->do_append_trivial(execT, paramu, sizeof(xnode), ::std::addressof(xnode));
+        this->do_append_trivial(do_thread<execT>, paramu, sizeof(xnode), ::std::addressof(xnode));
       }
     template<Executor execT, Enumerator* enumT, typename XNodeT>
         void do_dispatch_append(::std::false_type, ParamU paramu, XNodeT&& xnode)
@@ -152,10 +196,10 @@ class AVMC_Queue
           };
         static constexpr Vtable s_vtbl =
           {
-            H::destroy, execT, enumT
+            H::destroy, enumT
           };
         // Append a node with a non-trivial parameter.
-        this->do_append_nontrivial(::rocket::ref(s_vtbl), paramu, sizeof(xnode), H::construct,
+        this->do_append_nontrivial(::rocket::ref(s_vtbl), do_thread<execT>, paramu, sizeof(xnode), H::construct,
                                    reinterpret_cast<intptr_t>(::std::addressof(xnode)));
       }
 
@@ -191,7 +235,7 @@ class AVMC_Queue
     template<Executor execT> AVMC_Queue& append(ParamU paramu)
       {
         // Append a node with no parameter.
-        this->do_append_trivial(execT, paramu, 0, nullptr);
+        this->do_append_trivial(do_thread<execT>, paramu, 0, nullptr);
         return *this;
       }
     template<Executor execT, typename XNodeT> AVMC_Queue& append(ParamU paramu, XNodeT&& xnode)
@@ -207,10 +251,10 @@ class AVMC_Queue
         this->do_dispatch_append<execT, enumT>(::std::false_type(), paramu, ::std::forward<XNodeT>(xnode));
         return *this;
       }
-    AVMC_Queue& append_trivial(Executor* exec, ParamU paramu, const void* data, size_t size)
+    template<Executor execT> AVMC_Queue& append_trivial(ParamU paramu, const void* data, size_t size)
       {
         // Append an arbitrary function with a trivial argument.
-        this->do_append_trivial(exec, paramu, size, data);
+        this->do_append_trivial(do_thread<execT>, paramu, size, data);
         return *this;
       }
 
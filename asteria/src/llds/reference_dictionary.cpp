@@ -7,6 +7,12 @@
 #include "../utilities.hpp"
 
 namespace Asteria {
+namespace {
+
+// This is the last generation number that has been allocated.
+::std::atomic<uint64_t> s_last_gen;
+
+}  // namespace
 
 void Reference_Dictionary::do_destroy_buckets() const noexcept
   {
@@ -18,9 +24,15 @@ void Reference_Dictionary::do_destroy_buckets() const noexcept
       ::rocket::destroy_at(qbkt->kstor);
       ::rocket::destroy_at(qbkt->vstor);
       qbkt->next = nullptr;
+      qbkt->prev = nullptr;
     }
   }
 
+void Reference_Dictionary::do_update_generation() noexcept
+  {
+    this->m_stor.gen = s_last_gen.fetch_add(1, ::std::memory_order_relaxed) + 1;
+  }
+
 void Reference_Dictionary::do_enumerate_variables(Variable_Callback& callback) const
   {
     auto next = this->m_stor.head;
@@ -142,6 +154,8 @@ void Reference_Dictionary::do_rehash(size_t nbkt)
     if(bold) {
       ::operator delete(bold);
     }
+    // Invalidate pointers to old buckets.
+    this->do_update_generation();
   }
 
 void Reference_Dictionary::do_attach(Reference_Dictionary::Bucket* qbkt, const phsh_string& name) noexcept
@@ -166,6 +180,8 @@ void Reference_Dictionary::do_detach(Reference_Dictionary::Bucket* qbkt) noexcep
     ROCKET_ASSERT(!*qbkt);
     // Relocate nodes that follow `qbkt`, if any.
     this->do_xrelocate_but(qbkt);
+    // Invalidate pointers to relocated buckets.
+    this->do_update_generation();
   }
 
 }  // namespace Asteria
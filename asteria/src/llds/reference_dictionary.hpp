@@ -30,6 +30,7 @@ class Reference_Dictionary
         Bucket* eptr;  // end of bucket storage
         Bucket* head;  // the first initialized bucket
         size_t size;  // number of initialized buckets
+        uint64_t gen;  // generation number, which changes whenever buckets are relocated
       };
     Storage m_stor;
 
@@ -65,6 +66,7 @@ class Reference_Dictionary
 
   private:
     void do_destroy_buckets() const noexcept;
+    void do_update_generation() noexcept;
     void do_enumerate_variables(Variable_Callback& callback) const;
 
     Bucket* do_xprobe(const phsh_string& name) const noexcept;
@@ -94,6 +96,7 @@ class Reference_Dictionary
         // Clean invalid data up.
         this->m_stor.head = nullptr;
         this->m_stor.size = 0;
+        this->do_update_generation();
         return *this;
       }
 
@@ -103,6 +106,13 @@ class Reference_Dictionary
         return *this;
       }
 
+    // Pointers to references remain valid as long as this number does not change.
+    // Generation numbers are unique across all dictionaries, so they can be used as keys of caches.
+    uint64_t generation() const noexcept
+      {
+        return this->m_stor.gen;
+      }
+
     const Reference* get_opt(const phsh_string& name) const noexcept
       {
         // Be advised that `do_xprobe()` shall not be called when the table has not been allocated.
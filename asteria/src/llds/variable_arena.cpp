@@ -0,0 +1,248 @@
+// This file is part of Asteria.
+// Copyleft 2018 - 2020, LH_Mouse. All wrongs reserved.
+
+#include "../precompiled.hpp"
+#include "variable_arena.hpp"
+#include "../runtime/variable.hpp"
+#include "../utilities.hpp"
+#include <stdlib.h>  // ::posix_memalign(), ::free()
+#include <atomic>  // ::std::atomic
+#include <thread>  // ::std::this_thread::yield()
+
+namespace Asteria {
+namespace {
+
+// Slabs are aligned to their size, so the slab of a cell can be located by masking its address.
+constexpr size_t slab_size = 0x10000;
+
+union Cell
+  {
+    Cell* next;  // the next free cell
+    alignas(Variable) char bytes[sizeof(Variable)];
+  };
+
+enum Slab_State : uint8_t
+  {
+    slab_state_active   = 0,
+    slab_state_partial  = 1,
+    slab_state_full     = 2,
+  };
+
+}  // namespace
+
+struct Variable_Arena::Slab
+  {
+    Pool* pool;  // This is immutable.
+    Slab* prev;
+    Slab* next;
+    Cell* free;  // the first free cell
+    uint32_t nbump;  // number of cells that have been carved out
+    uint32_t nlive;  // number of cells that are in use
+    Slab_State state;
+
+    Cell cells[1];  // This is actually a flexible array member.
+  };
+
+// All fields of a pool and its slabs are protected by its lock. Critical sections are only a few instructions
+// long, so a spinlock is cheaper than a mutex.
+struct Variable_Arena::Pool
+  {
+    ::std::atomic<bool> locked = { false };
+    Slab* active = nullptr;  // the slab that variables are allocated from
+    Slab* partial = nullptr;  // slabs that have free cells, as a doubly-linked list
+    Slab* full = nullptr;  // slabs that have no free cells, as a doubly-linked list
+    bool orphaned = false;  // set when the arena has been destroyed
+  };
+
+namespace {
+
+using Slab = Variable_Arena::Slab;
+using Pool = Variable_Arena::Pool;
+
+class Pool_Lock
+  {
+  private:
+    Pool* m_pool;
+
+  public:
+    explicit Pool_Lock(Pool* pool) noexcept
+      : m_pool(pool)
+      {
+        while(ROCKET_UNEXPECT(pool->locked.exchange(true, ::std::memory_order_acquire)))
+          ::std::this_thread::yield();
+      }
+    ~Pool_Lock()
+      {
+        this->unlock();
+      }
+
+    Pool_Lock(const Pool_Lock&)
+      = delete;
+    Pool_Lock& operator=(const Pool_Lock&)
+      = delete;
+
+  public:
+    void unlock() noexcept
+      {
+        auto pool = ::std::exchange(this->m_pool, nullptr);
+        if(pool)
+          pool->locked.store(false, ::std::memory_order_release);
+      }
+  };
+
+constexpr uint32_t slab_capacity = (slab_size - offsetof(Slab, cells)) / sizeof(Cell);
+
+void do_list_attach(Slab*& head, Slab* slab) noexcept
+  {
+    slab->prev = nullptr;
+    slab->next = head;
+    if(head)
+      head->prev = slab;
+    head = slab;
+  }
+
+void do_list_detach(Slab*& head, Slab* slab) noexcept
+  {
+    if(slab->prev)
+      slab->prev->next = slab->next;
+    else
+      head = slab->next;
+    if(slab->next)
+      slab->next->prev = slab->prev;
+  }
+
+bool do_pool_empty(const Pool* pool) noexcept
+  {
+    return !pool->active && !pool->partial && !pool->full;
+  }
+
+void* do_allocate_slow(Pool* pool)
+  {
+    // Retire the active slab, which must have been exhausted.
+    auto slab = ::std::exchange(pool->active, nullptr);
+    if(slab) {
+      ROCKET_ASSERT(slab->nlive == slab_capacity);
+      slab->state = slab_state_full;
+      do_list_attach(pool->full, slab);
+    }
+    // Prefer a slab that has free cells.
+    slab = pool->partial;
+    if(slab) {
+      do_list_detach(pool->partial, slab);
+    }
+    else {
+      // Allocate a new slab.
+      void* ptr;
+      if(::posix_memalign(&ptr, slab_size, slab_size) != 0)
+        throw ::std::bad_alloc();
+      slab = static_cast<Slab*>(ptr);
+      slab->pool = pool;
+      slab->free = nullptr;
+      slab->nbump = 0;
+      slab->nlive = 0;
+    }
+    slab->state = slab_state_active;
+    pool->active = slab;
+    // Partial slabs have free cells and new slabs have room for bumping.
+    auto cell = slab->free;
+    if(cell)
+      slab->free = cell->next;
+    else
+      cell = slab->cells + slab->nbump++;
+    slab->nlive++;
+    return cell;
+  }
+
+}  // namespace
+
+Variable_Arena::~Variable_Arena()
+  {
+    auto pool = this->m_pool;
+    if(!pool)
+      return;
+    Pool_Lock lock(pool);
+    pool->orphaned = true;
+    // Deallocate empty slabs. Others will be deallocated when all cells have been freed.
+    auto slab = pool->active;
+    if(slab && (slab->nlive == 0)) {
+      pool->active = nullptr;
+      ::free(slab);
+    }
+    auto next = pool->partial;
+    while(next) {
+      slab = ::std::exchange(next, next->next);
+      if(slab->nlive != 0)
+        continue;
+      do_list_detach(pool->partial, slab);
+      ::free(slab);
+    }
+    // Deallocate the pool if no variables are alive.
+    bool dispose = do_pool_empty(pool);
+    lock.unlock();
+    if(dispose)
+      delete pool;
+  }
+
+void* Variable_Arena::allocate()
+  {
+    auto pool = this->m_pool;
+    if(ROCKET_UNEXPECT(!pool))
+      pool = this->m_pool = new Pool;
+    Pool_Lock lock(pool);
+    auto slab = pool->active;
+    if(ROCKET_UNEXPECT(!slab))
+      return do_allocate_slow(pool);
+    // Reuse a free cell.
+    auto cell = slab->free;
+    if(cell) {
+      slab->free = cell->next;
+      slab->nlive++;
+      return cell;
+    }
+    // Carve a new cell by bumping the pointer.
+    if(slab->nbump < slab_capacity) {
+      cell = slab->cells + slab->nbump++;
+      slab->nlive++;
+      return cell;
+    }
+    return do_allocate_slow(pool);
+  }
+
+void Variable_Arena::deallocate(void* ptr) noexcept
+  {
+    auto slab = reinterpret_cast<Slab*>(reinterpret_cast<uintptr_t>(ptr) & ~uintptr_t(slab_size - 1));
+    auto pool = slab->pool;
+    Pool_Lock lock(pool);
+    ROCKET_ASSERT(slab->nlive != 0);
+    // Push the cell onto the free list.
+    auto cell = static_cast<Cell*>(ptr);
+    cell->next = slab->free;
+    slab->free = cell;
+    slab->nlive--;
+    if(slab->nlive != 0) {
+      // Make slabs that were full available for allocation.
+      if(slab->state == slab_state_full) {
+        do_list_detach(pool->full, slab);
+        slab->state = slab_state_partial;
+        do_list_attach(pool->partial, slab);
+      }
+      return;
+    }
+    // Deallocate slabs that have become empty, as the active one is enough for new variables. The active slab
+    // is kept unless the arena has been destroyed.
+    if(slab->state == slab_state_active) {
+      if(!pool->orphaned)
+        return;
+      pool->active = nullptr;
+    }
+    else
+      do_list_detach((slab->state == slab_state_full) ? pool->full : pool->partial, slab);
+    ::free(slab);
+    // Deallocate the pool if it has been orphaned and this was its last slab.
+    bool dispose = pool->orphaned && do_pool_empty(pool);
+    lock.unlock();
+    if(dispose)
+      delete pool;
+  }
+
+}  // namespace Asteria
@@ -0,0 +1,44 @@
+// This file is part of Asteria.
+// Copyleft 2018 - 2020, LH_Mouse. All wrongs reserved.
+
+#ifndef ASTERIA_LLDS_VARIABLE_ARENA_HPP_
+#define ASTERIA_LLDS_VARIABLE_ARENA_HPP_
+
+#include "../fwd.hpp"
+
+namespace Asteria {
+
+// This allocates storage for variables from aligned slabs. Variables that are created together are adjacent in
+// memory. Each slab has an intrusive list of free cells, which are reused first, and the slab is deallocated
+// once all cells are free.
+// Like other objects in a global context, an arena shall not be used by multiple threads concurrently. However,
+// variables may be deallocated by any thread, even after their arena has been destroyed, so slabs are kept in a
+// pool that is protected by a lock, and that outlives its arena if some of its variables are still alive.
+class Variable_Arena
+  {
+  public:
+    struct Slab;  // This is opaque.
+    struct Pool;  // This is opaque.
+
+  private:
+    Pool* m_pool = nullptr;  // This is allocated on demand.
+
+  public:
+    constexpr Variable_Arena() noexcept
+      {
+      }
+    ~Variable_Arena();
+
+    Variable_Arena(const Variable_Arena&)
+      = delete;
+    Variable_Arena& operator=(const Variable_Arena&)
+      = delete;
+
+  public:
+    void* allocate();
+    static void deallocate(void* ptr) noexcept;
+  };
+
+}  // namespace Asteria
+
+#endif
@@ -96,6 +96,17 @@ class Variable_HashSet
         return *this;
       }
 
+    Variable_HashSet& shrink_to_fit(size_t nreserve = 0)
+      {
+        // Reallocate the table if it is much larger than necessary, so iterating over buckets is cheap.
+        auto nbkt = static_cast<size_t>(this->m_stor.eptr - this->m_stor.bptr);
+        auto nvars = ::rocket::max(this->m_stor.size, nreserve);
+        if(ROCKET_UNEXPECT(nbkt / 8 > (nvars | 97))) {
+          this->do_rehash(nvars * 3 | 97);
+        }
+        return *this;
+      }
+
     Variable_HashSet& swap(Variable_HashSet& other) noexcept
       {
         xswap(this->m_stor, other.m_stor);
@@ -170,6 +181,22 @@ class Variable_HashSet
         this->do_enumerate_variables(callback);
         return callback;
       }
+
+    // These allow resumable iteration by bucket index. If the table is rehashed in between, some variables may
+    // be skipped or visited twice.
+    size_t bucket_count() const noexcept
+      {
+        return static_cast<size_t>(this->m_stor.eptr - this->m_stor.bptr);
+      }
+    const rcptr<Variable>* get_bucket_opt(size_t index) const noexcept
+      {
+        ROCKET_ASSERT(index < this->bucket_count());
+        auto qbkt = this->m_stor.bptr + index;
+        if(!*qbkt) {
+          return nullptr;
+        }
+        return qbkt->kstor;
+      }
   };
 
 inline void swap(Variable_HashSet& lhs, Variable_HashSet& rhs) noexcept
@@ -54,6 +54,12 @@ class Abstract_Context
       {
         return this->m_named_refs.open(name);
       }
+    // Pointers returned by `get_named_reference_opt()` remain valid as long as this number does not change.
+    // Builtins that are initialized lazily shall be stored with `open_named_reference()` for this to hold.
+    uint64_t get_named_reference_generation() const noexcept
+      {
+        return this->m_named_refs.generation();
+      }
     Abstract_Context& clear_named_references() noexcept
       {
         return this->m_named_refs.clear(), *this;
@@ -55,6 +55,28 @@ bool do_rebind_nodes(bool& dirty, cow_vector<cow_vector<AIR_Node>>& code, const
     return dirty;
   }
 
+const Abstract_Context* do_locate_context(cow_vector<AIR_Node::Capture>*& qcaps, uint32_t& dcaps, const Abstract_Context& ctx,
+                                          uint32_t depth)
+  {
+    // If the context of a function whose body is being compiled into a template is passed through, references
+    // in the target context have to be captured. Return the capture list and the depth of the function context.
+    qcaps = nullptr;
+    dcaps = 0;
+    const Abstract_Context* qctx = ::std::addressof(ctx);
+    for(uint32_t k = 0;  k < depth;  ++k) {
+      if(qctx->is_analytic()) {
+        auto qlist = static_cast<const Analytic_Context*>(qctx)->get_captures_opt();
+        if(qlist) {
+          qcaps = qlist;
+          dcaps = k;
+        }
+      }
+      qctx = qctx->get_parent_opt();
+      ROCKET_ASSERT(qctx);
+    }
+    return qctx;
+  }
+
 template<typename XValT> Reference& do_set_temporary(Evaluation_Stack& stack, bool assign, XValT&& xval)
   {
     auto& ref = stack.open_top();
@@ -68,9 +90,9 @@ template<typename XValT> Reference& do_set_temporary(Evaluation_Stack& stack, bo
     return ref = ::std::move(xref);
   }
 
-Reference& do_declare(Executive_Context& ctx, const phsh_string& name)
+Reference& do_declare(Executive_Context& ctx, uint32_t slot)
   {
-    return ctx.open_named_reference(name) = Reference_root::S_void();
+    return ctx.open_slot(slot) = Reference_root::S_void();
   }
 
 AIR_Status do_execute_block(const AVMC_Queue& queue, Executive_Context& ctx)
@@ -189,9 +211,7 @@ template<> struct AVMC_Appender<void, void>
 
 AVMC_Queue& do_solidify_queue(AVMC_Queue& queue, const cow_vector<AIR_Node>& code)
   {
-    ::rocket::for_each(code, [&](const AIR_Node& node) { node.solidify(queue, 0);  });  // 1st pass
-    ::rocket::for_each(code, [&](const AIR_Node& node) { node.solidify(queue, 1);  });  // 2nd pass
-    return queue;
+    return AIR_Node::solidify_all(queue, code);
   }
 
 ///////////////////////////////////////////////////////////////////////////
@@ -213,7 +233,15 @@ struct Pv_switch
   {
     cow_vector<AVMC_Queue> queues_labels;
     cow_vector<AVMC_Queue> queues_bodies;
-    cow_vector<cow_vector<phsh_string>> names_added;
+
+    // If all labels are integer or string constants, they are mapped to clauses here, and `queues_labels`
+    // are only evaluated when hooks are installed or the condition is a real number.
+    bool tabled;
+    uint32_t target_default;  // `UINT32_MAX` if there is no `default` clause
+    int64_t dense_base;
+    cow_vector<uint32_t> dense_targets;  // indexed by integers relative to `dense_base`
+    cow_bivector<int64_t, uint32_t> sparse_targets;  // sorted by integers
+    cow_dictionary<uint32_t> string_targets;
 
     Variable_Callback& enumerate_variables(Variable_Callback& callback) const
       {
@@ -225,15 +253,41 @@ struct Pv_switch
 
 struct Pv_for_each
   {
-    phsh_string name_key;
-    phsh_string name_mapped;
+    uint32_t slot_key;
+    uint32_t slot_mapped;
+    AVMC_Queue queue_init;
+    AVMC_Queue queue_body;
+
+    Variable_Callback& enumerate_variables(Variable_Callback& callback) const
+      {
+        this->queue_init.enumerate_variables(callback);
+        this->queue_body.enumerate_variables(callback);
+        return callback;
+      }
+  };
+
+struct Pv_counted_for
+  {
     AVMC_Queue queue_init;
+    AVMC_Queue queue_cond;
+    AVMC_Queue queue_step;
     AVMC_Queue queue_body;
+    uint32_t slot;
+    bool materialize;
+    Xop xop_cond;
+    AIR_Node::Register_Operand bound;
+    int64_t bound_const;
+    Reference bound_ref = Reference_root::S_void();
+    Xop xop_step;
+    int64_t step;
 
     Variable_Callback& enumerate_variables(Variable_Callback& callback) const
       {
         this->queue_init.enumerate_variables(callback);
+        this->queue_cond.enumerate_variables(callback);
+        this->queue_step.enumerate_variables(callback);
         this->queue_body.enumerate_variables(callback);
+        callback(this->bound_ref);
         return callback;
       }
   };
@@ -242,7 +296,7 @@ struct Pv_try
   {
     AVMC_Queue queue_try;
     Source_Location sloc;
-    phsh_string name_except;
+    uint32_t slot_except;
     AVMC_Queue queue_catch;
 
     Variable_Callback& enumerate_variables(Variable_Callback& callback) const
@@ -258,23 +312,29 @@ struct Pv_func
     Source_Location sloc;
     cow_string func;
     cow_vector<phsh_string> params;
-    cow_vector<AIR_Node> code_body;
+    // This is released once the body has been compiled.
+    mutable cow_vector<AIR_Node> code_body;
+
+    // These are compiled when the function is defined for the first time, and are shared by all instances.
+    // Like the rest of a queue, they are not safe for concurrent execution.
+    mutable rcptr<const Instantiated_Function::Body> body;
+    mutable cow_vector<AIR_Node::Capture> captures;
 
     Variable_Callback& enumerate_variables(Variable_Callback& callback) const
       {
         ::rocket::for_each(this->code_body, callback);
+        if(this->body)
+          this->body->queue.enumerate_variables(callback);
         return callback;
       }
   };
 
-struct Pv_defer
+struct Pv_defer : Executive_Context::Deferred_Expression
   {
-    Source_Location sloc;
-    cow_vector<AIR_Node> code_body;
-
     Variable_Callback& enumerate_variables(Variable_Callback& callback) const
       {
         ::rocket::for_each(this->code_body, callback);
+        this->queue_body.enumerate_variables(callback);
         return callback;
       }
   };
@@ -297,6 +357,66 @@ struct Pv_name
     using nonenumerable = ::std::true_type;
   };
 
+struct Pv_name_cached
+  {
+    phsh_string name;
+    // This is an inline cache, which is valid if `qref` is non-null and `gen` matches the generation number
+    // of the global context. Like the rest of a queue, it is not safe for concurrent execution.
+    mutable uint64_t gen;
+    mutable const Reference* qref;
+
+    using nonenumerable = ::std::true_type;
+  };
+
+// This records the types of operands that an operator has seen.
+enum Type_Feedback : uint8_t
+  {
+    feedback_none     = 0,  // not executed yet
+    feedback_integer  = 1,  // both operands have always been integers
+    feedback_real     = 2,  // both operands have always been reals
+    feedback_generic  = 3,  // operands have had other or mixed types
+  };
+
+struct Pv_type_feedback
+  {
+    // Like the rest of a queue, this is not safe for concurrent execution.
+    mutable Type_Feedback state;
+
+    using nonenumerable = ::std::true_type;
+  };
+
+struct Pv_std_member
+  {
+    phsh_string module;
+    phsh_string member;
+    // This caches the value of `std.<module>.<member>`, which is valid if `qstd` is non-null, `gen` matches
+    // the generation number of the global context, and `qstd` still refers to the variable `vstd`. Like the rest
+    // of a queue, it is not safe for concurrent execution.
+    mutable uint64_t gen;
+    mutable const Reference* qstd;
+    mutable rcptr<Variable> vstd;
+    mutable Value value;
+
+    using nonenumerable = ::std::true_type;
+  };
+
+struct Pv_register_expression
+  {
+    cow_vector<AIR_Node::Register_Step> steps;
+    cow_vector<Value> consts;
+    cow_vector<Reference> refs;
+    AIR_Node::Register_Operand target;
+    AVMC_Queue queue_stack;
+
+    Variable_Callback& enumerate_variables(Variable_Callback& callback) const
+      {
+        ::rocket::for_each(this->consts, callback);
+        ::rocket::for_each(this->refs, callback);
+        this->queue_stack.enumerate_variables(callback);
+        return callback;
+      }
+  };
+
 struct Pv_names
   {
     cow_vector<phsh_string> names;
@@ -347,24 +467,22 @@ AIR_Status do_execute_block(Executive_Context& ctx, ParamU /*pu*/, const void* p
     return do_execute_block(queue_body, ctx);
   }
 
-AIR_Status do_declare_variable(Executive_Context& ctx, ParamU /*pu*/, const void* pv)
+AIR_Status do_declare_variable(Executive_Context& ctx, ParamU pu, const void* pv)
   {
     // Unpack arguments.
+    const auto& slot = pu.x32;
+    const auto& untracked = static_cast<bool>(pu.x16);
     const auto& sloc = do_pcast<Pv_sloc_name>(pv)->sloc;
     const auto& name = do_pcast<Pv_sloc_name>(pv)->name;
-    const auto& inside = ctx.zvarg()->func();
     const auto& gcoll = ctx.global().generational_collector();
-    const auto& qhooks = ctx.global().get_hooks_opt();
 
     // Allocate an uninitialized variable.
-    auto var = gcoll->create_variable();
+    auto var = untracked ? gcoll->create_untracked_variable() : gcoll->create_variable();
     // Inject the variable into the current context.
     Reference_root::S_variable xref = { ::std::move(var) };
-    ctx.open_named_reference(name) = xref;
+    ctx.open_slot(slot) = xref;
     // Call the hook function if any.
-    if(qhooks) {
-      qhooks->on_variable_declare(sloc, inside, name);
-    }
+    ctx.global().call_hook(&Abstract_Hooks::on_variable_declare, sloc, ctx.zvarg()->func(), name);
     // Push a copy of the reference onto the stack.
     ctx.stack().push(::std::move(xref));
     return air_status_next;
@@ -404,22 +522,105 @@ AIR_Status do_if_statement(Executive_Context& ctx, ParamU pu, const void* pv)
     return do_execute_block(queue_false, ctx);
   }
 
+size_t do_find_switch_target(const Pv_switch& sw, const Value& value)
+  {
+    uint32_t target = sw.target_default;
+    if(value.is_integer()) {
+      auto ival = value.as_integer();
+      if(sw.dense_targets.size()) {
+        // Note `ival - dense_base` might overflow.
+        auto off = static_cast<uint64_t>(ival) - static_cast<uint64_t>(sw.dense_base);
+        if((off < sw.dense_targets.size()) && (sw.dense_targets[off] != UINT32_MAX)) {
+          target = sw.dense_targets[off];
+        }
+      }
+      else {
+        auto pos = ::std::lower_bound(sw.sparse_targets.begin(), sw.sparse_targets.end(), ival,
+                                      [](const pair<int64_t, uint32_t>& elem, int64_t x) { return elem.first < x;  });
+        if((pos != sw.sparse_targets.end()) && (pos->first == ival)) {
+          target = pos->second;
+        }
+      }
+    }
+    else if(value.is_string()) {
+      auto pos = sw.string_targets.find(phsh_string(value.as_string()));
+      if(pos != sw.string_targets.end()) {
+        target = pos->second;
+      }
+    }
+    // Values of other types never equal integers or strings.
+    return (target == UINT32_MAX) ? SIZE_MAX : target;
+  }
+
+void do_make_switch_table(Pv_switch& sw, const cow_vector<const Value*>& labels)
+  {
+    // This requires all `case` labels to be integers or strings. `default` labels are null pointers.
+    // Note that, as with sequential comparison, the first matching label takes precedence.
+    sw.tabled = false;
+    sw.target_default = UINT32_MAX;
+    int64_t imin = INT64_MAX;
+    int64_t imax = INT64_MIN;
+    for(size_t i = 0;  i < labels.size();  ++i) {
+      auto qlabel = labels[i];
+      if(!qlabel) {
+        if(sw.target_default != UINT32_MAX) {
+          // Multiple `default` clauses are diagnosed at runtime.
+          return;
+        }
+        sw.target_default = static_cast<uint32_t>(i);
+      }
+      else if(qlabel->is_integer()) {
+        auto ival = qlabel->as_integer();
+        auto pos = ::std::find_if(sw.sparse_targets.begin(), sw.sparse_targets.end(),
+                                  [&](const pair<int64_t, uint32_t>& elem) { return elem.first == ival;  });
+        if(pos == sw.sparse_targets.end()) {
+          sw.sparse_targets.emplace_back(ival, static_cast<uint32_t>(i));
+        }
+        imin = ::rocket::min(imin, ival);
+        imax = ::rocket::max(imax, ival);
+      }
+      else if(qlabel->is_string()) {
+        sw.string_targets.try_emplace(phsh_string(qlabel->as_string()), static_cast<uint32_t>(i));
+      }
+      else {
+        return;
+      }
+    }
+    // Integers are looked up in a dense table if there are not too many holes. Otherwise they are sorted.
+    auto nints = sw.sparse_targets.size();
+    if((nints != 0) && (static_cast<uint64_t>(imax) - static_cast<uint64_t>(imin) < nints * 2 + 8)) {
+      sw.dense_base = imin;
+      sw.dense_targets.append(static_cast<size_t>(imax - imin) + 1, UINT32_MAX);
+      for(const auto& elem : sw.sparse_targets) {
+        sw.dense_targets.mut(static_cast<size_t>(elem.first - imin)) = elem.second;
+      }
+      sw.sparse_targets.clear();
+    }
+    else {
+      ::std::sort(sw.sparse_targets.mut_begin(), sw.sparse_targets.mut_end());
+    }
+    sw.tabled = true;
+  }
+
 AIR_Status do_switch_statement(Executive_Context& ctx, ParamU /*pu*/, const void* pv)
   {
     // Unpack arguments.
     const auto& queues_labels = do_pcast<Pv_switch>(pv)->queues_labels;
     const auto& queues_bodies = do_pcast<Pv_switch>(pv)->queues_bodies;
-    const auto& names_added = do_pcast<Pv_switch>(pv)->names_added;
 
     // Read the value of the condition.
     auto value = ctx.stack().get_top().read();
     // Get the number of clauses.
     auto nclauses = queues_labels.size();
     ROCKET_ASSERT(nclauses == queues_bodies.size());
-    ROCKET_ASSERT(nclauses == names_added.size());
     // Find a target clause.
     // This is different from the `switch` statement in C, where `case` labels must have constant operands.
     size_t target = SIZE_MAX;
+    if(do_pcast<Pv_switch>(pv)->tabled && !value.is_real() && !ctx.global().has_hooks()) {
+      // Look up the table, unless labels have to be compared with a real number, or evaluated for hooks.
+      target = do_find_switch_target(*do_pcast<Pv_switch>(pv), value);
+      nclauses = 0;
+    }
     for(size_t i = 0;  i < nclauses;  ++i) {
       // This is a `default` clause if the condition is empty, and a `case` clause otherwise.
       if(queues_labels[i].empty()) {
@@ -437,7 +638,7 @@ AIR_Status do_switch_statement(Executive_Context& ctx, ParamU /*pu*/, const void
         break;
       }
     }
-    if(target < nclauses) {
+    if(target >= queues_bodies.size()) {
       // No matching clause has been found.
       return air_status_next;
     }
@@ -447,11 +648,9 @@ AIR_Status do_switch_statement(Executive_Context& ctx, ParamU /*pu*/, const void
     Executive_Context ctx_body(::rocket::ref(ctx), nullptr);
     AIR_Status status;
     ASTERIA_RUNTIME_TRY {
-      size_t k = SIZE_MAX;
       // Fly over all clauses that precede `target`.
-      while(++k < target) {
-        ::rocket::for_each(names_added[k], [&](const phsh_string& name) { do_declare(ctx_body, name);  });
-      }
+      // Names that are declared in them have had slots assigned, which are left void.
+      size_t k = target;
       // Execute all clauses from `target`.
       do {
         status = queues_bodies[k].execute(ctx_body);
@@ -461,7 +660,7 @@ AIR_Status do_switch_statement(Executive_Context& ctx, ParamU /*pu*/, const void
         }
         if(status != air_status_next)
           break;
-      } while(++k < nclauses);
+      } while(++k < queues_bodies.size());
     }
     ASTERIA_RUNTIME_CATCH(Runtime_Error& except) {
       ctx_body.on_scope_exit(except);
@@ -522,8 +721,8 @@ AIR_Status do_while_statement(Executive_Context& ctx, ParamU pu, const void* pv)
 AIR_Status do_for_each_statement(Executive_Context& ctx, ParamU /*pu*/, const void* pv)
   {
     // Unpack arguments.
-    const auto& name_key = do_pcast<Pv_for_each>(pv)->name_key;
-    const auto& name_mapped = do_pcast<Pv_for_each>(pv)->name_mapped;
+    const auto& slot_key = do_pcast<Pv_for_each>(pv)->slot_key;
+    const auto& slot_mapped = do_pcast<Pv_for_each>(pv)->slot_mapped;
     const auto& queue_init = do_pcast<Pv_for_each>(pv)->queue_init;
     const auto& queue_body = do_pcast<Pv_for_each>(pv)->queue_body;
     const auto& gcoll = ctx.global().generational_collector();
@@ -534,9 +733,10 @@ AIR_Status do_for_each_statement(Executive_Context& ctx, ParamU /*pu*/, const vo
     const auto vkey = gcoll->create_variable();
     // Inject the variable into the current context.
     Reference_root::S_variable xref = { vkey };
-    ctx_for.open_named_reference(name_key) = xref;
+    ctx_for.open_slot(slot_key) = xref;
     // Create the mapped reference.
-    auto& mapped = do_declare(ctx_for, name_mapped);
+    // No other slot may be opened in `ctx_for` after this, which would invalidate `mapped`.
+    auto& mapped = do_declare(ctx_for, slot_mapped);
 
     // Evaluate the range initializer.
     auto status = queue_init.execute(ctx_for);
@@ -589,24 +789,12 @@ AIR_Status do_for_each_statement(Executive_Context& ctx, ParamU /*pu*/, const vo
     return air_status_next;
   }
 
-AIR_Status do_for_statement(Executive_Context& ctx, ParamU /*pu*/, const void* pv)
+AIR_Status do_loop_for(Executive_Context& ctx_for, const AVMC_Queue& queue_cond, const AVMC_Queue& queue_step,
+                       const AVMC_Queue& queue_body)
   {
-    // Unpack arguments.
-    const auto& queue_init = do_pcast<Pv_queues_fixed<4>>(pv)->queues[0];
-    const auto& queue_cond = do_pcast<Pv_queues_fixed<4>>(pv)->queues[1];
-    const auto& queue_step = do_pcast<Pv_queues_fixed<4>>(pv)->queues[2];
-    const auto& queue_body = do_pcast<Pv_queues_fixed<4>>(pv)->queues[3];
-
-    // This is the same as the `for` statement in C.
-    // We have to create an outer context due to the fact that names declared in the first segment
-    // outlast every iteration.
-    Executive_Context ctx_for(::rocket::ref(ctx), nullptr);
-    // Execute the loop initializer, which shall only be a definition or an expression statement.
-    auto status = queue_init.execute(ctx_for);
-    ROCKET_ASSERT(status == air_status_next);
     for(;;) {
       // Check the condition.
-      status = queue_cond.execute(ctx_for);
+      auto status = queue_cond.execute(ctx_for);
       ROCKET_ASSERT(status == air_status_next);
       // This is a special case: If the condition is empty then the loop is infinite.
       if(!(ctx_for.stack().empty() || ctx_for.stack().get_top().read().test()))
@@ -624,12 +812,30 @@ AIR_Status do_for_statement(Executive_Context& ctx, ParamU /*pu*/, const void* p
     return air_status_next;
   }
 
+AIR_Status do_for_statement(Executive_Context& ctx, ParamU /*pu*/, const void* pv)
+  {
+    // Unpack arguments.
+    const auto& queue_init = do_pcast<Pv_queues_fixed<4>>(pv)->queues[0];
+    const auto& queue_cond = do_pcast<Pv_queues_fixed<4>>(pv)->queues[1];
+    const auto& queue_step = do_pcast<Pv_queues_fixed<4>>(pv)->queues[2];
+    const auto& queue_body = do_pcast<Pv_queues_fixed<4>>(pv)->queues[3];
+
+    // This is the same as the `for` statement in C.
+    // We have to create an outer context due to the fact that names declared in the first segment
+    // outlast every iteration.
+    Executive_Context ctx_for(::rocket::ref(ctx), nullptr);
+    // Execute the loop initializer, which shall only be a definition or an expression statement.
+    auto status = queue_init.execute(ctx_for);
+    ROCKET_ASSERT(status == air_status_next);
+    return do_loop_for(ctx_for, queue_cond, queue_step, queue_body);
+  }
+
 AIR_Status do_try_statement(Executive_Context& ctx, ParamU /*pu*/, const void* pv)
   {
     // Unpack arguments.
     const auto& queue_try = do_pcast<Pv_try>(pv)->queue_try;
     const auto& sloc = do_pcast<Pv_try>(pv)->sloc;
-    const auto& name_except = do_pcast<Pv_try>(pv)->name_except;
+    const auto& slot_except = do_pcast<Pv_try>(pv)->slot_except;
     const auto& queue_catch = do_pcast<Pv_try>(pv)->queue_catch;
 
     // This is almost identical to JavaScript.
@@ -652,7 +858,7 @@ AIR_Status do_try_statement(Executive_Context& ctx, ParamU /*pu*/, const void* p
       ASTERIA_RUNTIME_TRY {
         // Set the exception reference.
         Reference_root::S_temporary xref_except = { except.value() };
-        ctx_catch.open_named_reference(name_except) = ::std::move(xref_except);
+        ctx_catch.open_slot(slot_except) = ::std::move(xref_except);
         // Set backtrace frames.
         V_array backtrace;
         for(size_t i = 0;  i < except.count_frames();  ++i) {
@@ -743,12 +949,82 @@ AIR_Status do_push_immediate(Executive_Context& ctx, ParamU /*pu*/, const void*
 AIR_Status do_push_global_reference(Executive_Context& ctx, ParamU /*pu*/, const void* pv)
   {
     // Unpack arguments.
-    const auto& name = do_pcast<Pv_name>(pv)->name;
+    const auto& name = do_pcast<Pv_name_cached>(pv)->name;
+    auto& gen = do_pcast<Pv_name_cached>(pv)->gen;
+    auto& qref = do_pcast<Pv_name_cached>(pv)->qref;
+
+    // Check whether the cached reference is still valid.
+    const auto& global = ctx.global();
+    if(ROCKET_UNEXPECT(!qref || (gen != global.get_named_reference_generation()))) {
+      // Look for the name in the global context.
+      auto qnew = global.get_named_reference_opt(name);
+      if(!qnew) {
+        ASTERIA_THROW("undeclared identifier `$1`", name);
+      }
+      // Update the cache. Note the lookup might have caused a rehash.
+      gen = global.get_named_reference_generation();
+      qref = qnew;
+    }
+    // Push a copy of it.
+    ctx.stack().push(*qref);
+    return air_status_next;
+  }
+
+AIR_Status do_push_std_member(Executive_Context& ctx, ParamU /*pu*/, const void* pv)
+  {
+    // Unpack arguments.
+    const auto& cache = *do_pcast<Pv_std_member>(pv);
+
+    // Check whether the cached value is still valid.
+    // As the standard library is immutable, this is the case if `std` has not been rebound.
+    const auto& global = ctx.global();
+    if(ROCKET_UNEXPECT(!cache.qstd || (cache.gen != global.get_named_reference_generation()) ||
+                       !cache.qstd->is_variable() ||
+                       (::std::addressof(cache.qstd->read()) != ::std::addressof(cache.vstd->get_value())))) {
+      // Look for `std` in the global context.
+      auto qstd = global.get_named_reference_opt(::rocket::sref("std"));
+      if(!qstd) {
+        ASTERIA_THROW("undeclared identifier `std`");
+      }
+      Reference ref = *qstd;
+      Reference_modifier::S_object_key xmod = { cache.module };
+      ref.zoom_in(::std::move(xmod));
+      xmod = { cache.member };
+      ref.zoom_in(::std::move(xmod));
+      // If `std` is no longer the standard library, fall back to ordinary member access.
+      auto vstd = qstd->get_variable_opt();
+      if(!vstd || (vstd != global.std_variable())) {
+        ctx.stack().push(::std::move(ref));
+        return air_status_next;
+      }
+      // Update the cache.
+      cache.value = ref.read();
+      cache.vstd = ::std::move(vstd);
+      cache.qstd = qstd;
+      cache.gen = global.get_named_reference_generation();
+    }
+    // Push a copy of the value.
+    Reference_root::S_constant xref = { cache.value };
+    ctx.stack().push(::std::move(xref));
+    return air_status_next;
+  }
+
+AIR_Status do_push_local_slot(Executive_Context& ctx, ParamU pu, const void* /*pv*/)
+  {
+    // Unpack arguments.
+    const auto& slot = pu.x32;
+    const auto& depth = pu.x16;
 
-    // Look for the name in the global context.
-    auto qref = ctx.global().get_named_reference_opt(name);
+    // Get the context.
+    const Executive_Context* qctx = ::std::addressof(ctx);
+    ::rocket::ranged_for(uint16_t(0), depth, [&](uint16_t) { qctx = qctx->get_parent_opt();  });
+    ROCKET_ASSERT(qctx);
+    // Look for the slot in the context.
+    auto qref = qctx->get_slot_opt(slot);
     if(!qref) {
-      ASTERIA_THROW("undeclared identifier `$1`", name);
+      // The declaration has been bypassed, e.g. by a jump into a `switch` clause.
+      ctx.stack().push(Reference_root::S_void());
+      return air_status_next;
     }
     // Push a copy of it.
     ctx.stack().push(*qref);
@@ -785,25 +1061,54 @@ AIR_Status do_push_bound_reference(Executive_Context& ctx, ParamU /*pu*/, const
     return air_status_next;
   }
 
+AIR_Status do_push_captured_reference(Executive_Context& ctx, ParamU pu, const void* /*pv*/)
+  {
+    // Unpack arguments.
+    const auto& index = pu.x32;
+
+    // Look for the reference in the enclosing function, which is shared by all its contexts.
+    auto qref = ctx.get_capture_opt(index);
+    ROCKET_ASSERT(qref);
+    // Push a copy of it.
+    ctx.stack().push(*qref);
+    return air_status_next;
+  }
+
 AIR_Status do_define_function(Executive_Context& ctx, ParamU /*pu*/, const void* pv)
   {
     // Unpack arguments.
     const auto& sloc = do_pcast<Pv_func>(pv)->sloc;
     const auto& func = do_pcast<Pv_func>(pv)->func;
     const auto& params = do_pcast<Pv_func>(pv)->params;
-    const auto& code_body = do_pcast<Pv_func>(pv)->code_body;
-
-    // Create the zero-ary argument getter, which serves two purposes:
-    // 0) It is copied as `__varg` whenever its parent function is called with no variadic argument as an optimization.
-    // 1) It provides storage for `__file`, `__line` and `__func` for its parent function.
-    auto zvarg = ::rocket::make_refcnt<Variadic_Arguer>(sloc, func);
-    // Rewrite nodes in the body as necessary.
-    // Don't trigger copy-on-write unless a node needs rewriting.
-    Analytic_Context ctx_func(::std::addressof(ctx), params);
-    auto pair = ::std::make_pair(false, code_body);
-    do_rebind_nodes(pair.first, pair.second, ctx_func);
-    // Instantiate the function.
-    auto qtarget = ::rocket::make_refcnt<Instantiated_Function>(params, ::std::move(zvarg), pair.second);
+    auto& code_body = do_pcast<Pv_func>(pv)->code_body;
+    auto& body = do_pcast<Pv_func>(pv)->body;
+    auto& captures = do_pcast<Pv_func>(pv)->captures;
+
+    if(ROCKET_UNEXPECT(!body)) {
+      auto xbody = ::rocket::make_refcnt<Instantiated_Function::Body>();
+      xbody->params = params;
+      // Create the zero-ary argument getter, which serves two purposes:
+      // 0) It is copied as `__varg` whenever its parent function is called with no variadic argument as an optimization.
+      // 1) It provides storage for `__file`, `__line` and `__func` for its parent function.
+      xbody->zvarg = ::rocket::make_refcnt<Variadic_Arguer>(sloc, func);
+      // Rewrite nodes in the body as necessary. References to enclosing contexts are captured, so the body
+      // doesn't depend on this context and can be shared by all instances. Only references that are actually
+      // used are captured.
+      // Don't trigger copy-on-write unless a node needs rewriting.
+      cow_vector<AIR_Node::Capture> xcaps;
+      Analytic_Context ctx_func(::std::addressof(ctx), params, xcaps);
+      auto pair = ::std::make_pair(false, code_body);
+      do_rebind_nodes(pair.first, pair.second, ctx_func);
+      AIR_Node::solidify_all(xbody->queue, pair.second);
+      body = ::std::move(xbody);
+      captures = ::std::move(xcaps);
+      // The uncompiled body is no longer needed.
+      code_body.clear();
+    }
+    // Instantiate the function. Only references that it captures are specific to this instance.
+    cow_vector<Reference> refs;
+    AIR_Node::capture_references(refs, captures, ctx);
+    auto qtarget = ::rocket::make_refcnt<Instantiated_Function>(body, ::std::move(refs));
     // Push the function as a temporary.
     Reference_root::S_temporary xref = { V_function(::std::move(qtarget)) };
     ctx.stack().push(::std::move(xref));
@@ -841,10 +1146,11 @@ AIR_Status do_coalescence(Executive_Context& ctx, ParamU pu, const void* pv)
     return air_status_next;
   }
 
-ROCKET_NOINLINE Reference& do_invoke_nontail(Reference& self, const Source_Location& sloc, Executive_Context& ctx,
-                                             const cow_function& target, cow_vector<Reference>&& args)
+ROCKET_NOINLINE Reference& do_invoke_nontail_hooked(Reference& self, const Source_Location& sloc, Executive_Context& ctx,
+                                                    const cow_function& target, cow_vector<Reference>&& args)
   {
     // Call the hook function if any.
+    // N.B. Hooks are copied here, so the same hooks will be notified when the call completes.
     const auto& inside = ctx.zvarg()->func();
     const auto& qhooks = ctx.global().get_hooks_opt();
     if(qhooks) {
@@ -870,13 +1176,32 @@ ROCKET_NOINLINE Reference& do_invoke_nontail(Reference& self, const Source_Locat
     return self;
   }
 
+ROCKET_NOINLINE Reference& do_invoke_nontail(Reference& self, const Source_Location& sloc, Executive_Context& ctx,
+                                             const cow_function& target, cow_vector<Reference>&& args)
+  {
+    if(ROCKET_UNEXPECT(ctx.global().has_hooks())) {
+      return do_invoke_nontail_hooked(self, sloc, ctx, target, ::std::move(args));
+    }
+    // Perform a non-tail call.
+    ASTERIA_RUNTIME_TRY {
+      target.invoke(self, ctx.global(), ::std::move(args));
+    }
+    ASTERIA_RUNTIME_CATCH(Runtime_Error& except) {
+      // Append the current frame and rethrow the exception.
+      except.push_frame_call(sloc, ctx.zvarg()->func());
+      throw;
+    }
+    return self;
+  }
+
 ROCKET_NOINLINE Reference& do_wrap_ptc(Reference& self, const Source_Location& sloc, Executive_Context& ctx,
                                        const cow_function& target, PTC_Aware ptc,
                                        cow_vector<Reference>&& args)
   {
     // Pack arguments for this proper tail call.
-    auto tca = ::rocket::make_refcnt<PTC_Arguments>(sloc, ctx.zvarg(), ptc, target,
-                                        ::std::move(args.insert(args.size(), ::std::move(self))));
+    // The wrapper is recycled after the call, so no memory is allocated in a loop of tail calls.
+    auto tca = ctx.global().acquire_ptc_arguments(sloc, ctx.zvarg(), ptc, target,
+                                                  ::std::move(args.insert(args.size(), ::std::move(self))));
     // Return it.
     Reference_root::S_tail_call xref = { ::std::move(tca) };
     return self = ::std::move(xref);
@@ -906,17 +1231,13 @@ AIR_Status do_function_call(Executive_Context& ctx, ParamU pu, const void* pv)
     const auto& sloc = do_pcast<Pv_sloc>(pv)->sloc;
     const auto& nargs = static_cast<size_t>(pu.y32);
     const auto& ptc = static_cast<PTC_Aware>(pu.y8s[0]);
-    const auto& inside = ctx.zvarg()->func();
-    const auto& qhooks = ctx.global().get_hooks_opt();
 
     // Check for stack overflows.
     const auto sentry = ctx.global().copy_recursion_sentry();
     // Generate a single-step trap.
-    if(qhooks) {
-      qhooks->on_single_step_trap(sloc, inside, ::std::addressof(ctx));
-    }
+    ctx.global().call_hook(&Abstract_Hooks::on_single_step_trap, sloc, ctx.zvarg()->func(), ::std::addressof(ctx));
     // Pop arguments off the stack backwards.
-    cow_vector<Reference> args;
+    auto args = ctx.global().acquire_reference_buffer();
     args.resize(nargs, Reference_root::S_void());
     for(size_t i = args.size() - 1;  i != SIZE_MAX;  --i) {
       // Get an argument. Ensure it is dereferenceable.
@@ -931,8 +1252,11 @@ AIR_Status do_function_call(Executive_Context& ctx, ParamU pu, const void* pv)
     if(!value.is_function()) {
       ASTERIA_THROW("attempt to call a non-function (value `$1`)", value);
     }
-    return do_function_call_common(ctx.stack().open_top().zoom_out(),sloc, ctx,
-                                   value.as_function(), ptc, ::std::move(args));
+    auto status = do_function_call_common(ctx.stack().open_top().zoom_out(),sloc, ctx,
+                                          value.as_function(), ptc, ::std::move(args));
+    // Recycle the argument buffer, which has been used as the evaluation stack of the callee.
+    ctx.global().release_reference_buffer(::std::move(args));
+    return status;
   }
 
 AIR_Status do_member_access(Executive_Context& ctx, ParamU /*pu*/, const void* pv)
@@ -1596,8 +1920,9 @@ AIR_Status do_apply_xop_NOTL(Executive_Context& ctx, ParamU pu, const void* /*pv
 
 AIR_Status do_apply_xop_INC_PRE(Executive_Context& ctx, ParamU /*pu*/, const void* /*pv*/)
   {
-    // This operator is unary.
-    auto& rhs = ctx.stack().get_top().open();
+    // This operator is unary. Local variables are accessed directly.
+    auto qrhs = ctx.stack().get_top().open_fast_opt();
+    auto& rhs = qrhs ? *qrhs : ctx.stack().get_top().open();
     // Increment the operand and return it. `assign` is ignored.
     if(rhs.is_integer()) {
       auto& reg = rhs.open_integer();
@@ -1615,8 +1940,9 @@ AIR_Status do_apply_xop_INC_PRE(Executive_Context& ctx, ParamU /*pu*/, const voi
 
 AIR_Status do_apply_xop_DEC_PRE(Executive_Context& ctx, ParamU /*pu*/, const void* /*pv*/)
   {
-    // This operator is unary.
-    auto& rhs = ctx.stack().get_top().open();
+    // This operator is unary. Local variables are accessed directly.
+    auto qrhs = ctx.stack().get_top().open_fast_opt();
+    auto& rhs = qrhs ? *qrhs : ctx.stack().get_top().open();
     // Decrement the operand and return it. `assign` is ignored.
     if(rhs.is_integer()) {
       auto& reg = rhs.open_integer();
@@ -2476,6 +2802,168 @@ AIR_Status do_apply_xop_TAIL(Executive_Context& ctx, ParamU /*pu*/, const void*
     return air_status_next;
   }
 
+// These are fast paths of common binary operators whose operands are both integers or both reals.
+// `xopT` is `xop_cmp_eq` for all equality comparisons and `xop_cmp_lt` for all relational comparisons,
+// whose details are encoded in `pu`, like their generic executors. If the result would be anything other
+// than a plain value of the same type, `false` is returned and nothing is done.
+template<typename ValT> Compare do_compare_typed(ValT lhs, ValT rhs) noexcept
+  {
+    if(lhs < rhs)
+      return compare_less;
+    else if(lhs > rhs)
+      return compare_greater;
+    else if(lhs == rhs)
+      return compare_equal;
+    else
+      return compare_unordered;
+  }
+
+template<Xop xopT, typename ValT> bool do_apply_typed(Evaluation_Stack& stack, ParamU pu, ValT lhs, ValT rhs)
+  {
+    // Unpack arguments.
+    const auto& assign = static_cast<bool>(pu.u8s[0]);
+    const auto& expect = static_cast<Compare>(pu.u8s[1]);
+    const auto& negative = static_cast<bool>(pu.u8s[2]);
+
+    switch(xopT) {
+    case xop_cmp_eq: {
+        auto comp = do_compare_typed(lhs, rhs);
+        stack.pop();
+        do_set_temporary(stack, assign, V_boolean((comp == expect) ^ negative));
+        return true;
+      }
+    case xop_cmp_lt: {
+        auto comp = do_compare_typed(lhs, rhs);
+        if(comp == compare_unordered) {
+          return false;
+        }
+        stack.pop();
+        do_set_temporary(stack, assign, V_boolean((comp == expect) ^ negative));
+        return true;
+      }
+    case xop_add: {
+        auto res = do_operator_ADD(lhs, rhs);
+        stack.pop();
+        do_set_temporary(stack, assign, res);
+        return true;
+      }
+    case xop_sub: {
+        auto res = do_operator_SUB(lhs, rhs);
+        stack.pop();
+        do_set_temporary(stack, assign, res);
+        return true;
+      }
+    case xop_mul: {
+        auto res = do_operator_MUL(lhs, rhs);
+        stack.pop();
+        do_set_temporary(stack, assign, res);
+        return true;
+      }
+    case xop_div: {
+        auto res = do_operator_DIV(lhs, rhs);
+        stack.pop();
+        do_set_temporary(stack, assign, res);
+        return true;
+      }
+    case xop_mod: {
+        auto res = do_operator_MOD(lhs, rhs);
+        stack.pop();
+        do_set_temporary(stack, assign, res);
+        return true;
+      }
+    default:
+      return false;
+    }
+  }
+
+Type_Feedback do_classify_operands(const Value* qlhs, const Value* qrhs) noexcept
+  {
+    if(!qlhs || !qrhs)
+      return feedback_generic;
+    else if(qlhs->is_integer() && qrhs->is_integer())
+      return feedback_integer;
+    else if(qlhs->is_real() && qrhs->is_real())
+      return feedback_real;
+    else
+      return feedback_generic;
+  }
+
+// This executor records the types of operands in the type feedback which `pv` points to. While the
+// operator is monomorphic, the fast path above is taken, after the types of operands are checked.
+// Once it has seen other types, the feedback becomes generic and `genericT` is always called instead.
+// If `pv` is null, as in superinstructions, there is no feedback and operands are checked every time.
+template<Xop xopT, Executor genericT> AIR_Status do_apply_xop_typed(Executive_Context& ctx, ParamU pu, const void* pv)
+  {
+    // Unpack arguments.
+    auto qfb = pv ? ::std::addressof(do_pcast<Pv_type_feedback>(pv)->state) : nullptr;
+    if(qfb && (*qfb == feedback_generic)) {
+      return genericT(ctx, pu, nullptr);
+    }
+
+    // This operator is binary. Operands must be accessible directly.
+    auto qrhs = ctx.stack().get_top(0).read_fast_opt();
+    auto qlhs = ctx.stack().get_top(1).read_fast_opt();
+    auto state = do_classify_operands(qlhs, qrhs);
+    if(qfb && (*qfb != state)) {
+      // Record the types when this node is executed for the first time. If they change afterwards,
+      // deoptimize this node.
+      *qfb = (*qfb == feedback_none) ? state : feedback_generic;
+    }
+    switch(::rocket::weaken_enum(state)) {
+    case feedback_integer: {
+        if(do_apply_typed<xopT>(ctx.stack(), pu, qlhs->as_integer(), qrhs->as_integer())) {
+          return air_status_next;
+        }
+        break;
+      }
+    case feedback_real: {
+        if(do_apply_typed<xopT>(ctx.stack(), pu, qlhs->as_real(), qrhs->as_real())) {
+          return air_status_next;
+        }
+        break;
+      }
+    default:
+      break;
+    }
+    return genericT(ctx, pu, nullptr);
+  }
+
+// These are arithmetic and comparison operators with type feedback.
+AIR_Status do_apply_xop_CMP_XEQ_typed(Executive_Context& ctx, ParamU pu, const void* pv)
+  {
+    return do_apply_xop_typed<xop_cmp_eq, do_apply_xop_CMP_XEQ>(ctx, pu, pv);
+  }
+
+AIR_Status do_apply_xop_CMP_XREL_typed(Executive_Context& ctx, ParamU pu, const void* pv)
+  {
+    return do_apply_xop_typed<xop_cmp_lt, do_apply_xop_CMP_XREL>(ctx, pu, pv);
+  }
+
+AIR_Status do_apply_xop_ADD_typed(Executive_Context& ctx, ParamU pu, const void* pv)
+  {
+    return do_apply_xop_typed<xop_add, do_apply_xop_ADD>(ctx, pu, pv);
+  }
+
+AIR_Status do_apply_xop_SUB_typed(Executive_Context& ctx, ParamU pu, const void* pv)
+  {
+    return do_apply_xop_typed<xop_sub, do_apply_xop_SUB>(ctx, pu, pv);
+  }
+
+AIR_Status do_apply_xop_MUL_typed(Executive_Context& ctx, ParamU pu, const void* pv)
+  {
+    return do_apply_xop_typed<xop_mul, do_apply_xop_MUL>(ctx, pu, pv);
+  }
+
+AIR_Status do_apply_xop_DIV_typed(Executive_Context& ctx, ParamU pu, const void* pv)
+  {
+    return do_apply_xop_typed<xop_div, do_apply_xop_DIV>(ctx, pu, pv);
+  }
+
+AIR_Status do_apply_xop_MOD_typed(Executive_Context& ctx, ParamU pu, const void* pv)
+  {
+    return do_apply_xop_typed<xop_mod, do_apply_xop_MOD>(ctx, pu, pv);
+  }
+
 AIR_Status do_unpack_struct_array(Executive_Context& ctx, ParamU pu, const void* /*pv*/)
   {
     // Unpack arguments.
@@ -2545,22 +3033,20 @@ AIR_Status do_unpack_struct_object(Executive_Context& ctx, ParamU pu, const void
 AIR_Status do_define_null_variable(Executive_Context& ctx, ParamU pu, const void* pv)
   {
     // Unpack arguments.
-    const auto& immutable = static_cast<bool>(pu.u8s[0]);
+    const auto& slot = pu.y32;
+    const auto& immutable = static_cast<bool>(pu.u8s[4]);
+    const auto& untracked = static_cast<bool>(pu.u8s[5]);
     const auto& sloc = do_pcast<Pv_sloc_name>(pv)->sloc;
     const auto& name = do_pcast<Pv_sloc_name>(pv)->name;
-    const auto& inside = ctx.zvarg()->func();
     const auto& gcoll = ctx.global().generational_collector();
-    const auto& qhooks = ctx.global().get_hooks_opt();
 
     // Allocate an uninitialized variable.
-    auto var = gcoll->create_variable();
+    auto var = untracked ? gcoll->create_untracked_variable() : gcoll->create_variable();
     // Inject the variable into the current context.
     Reference_root::S_variable xref = { var };
-    ctx.open_named_reference(name) = ::std::move(xref);
+    ctx.open_slot(slot) = ::std::move(xref);
     // Call the hook function if any.
-    if(qhooks) {
-      qhooks->on_variable_declare(sloc, inside, name);
-    }
+    ctx.global().call_hook(&Abstract_Hooks::on_variable_declare, sloc, ctx.zvarg()->func(), name);
     // Initialize the variable to `null`.
     var->initialize(nullptr, immutable);
     return air_status_next;
@@ -2570,13 +3056,9 @@ AIR_Status do_single_step_trap(Executive_Context& ctx, ParamU /*pu*/, const void
   {
     // Unpack arguments.
     const auto& sloc = do_pcast<Pv_sloc>(pv)->sloc;
-    const auto& inside = ctx.zvarg()->func();
-    const auto& qhooks = ctx.global().get_hooks_opt();
 
     // Call the hook function if any.
-    if(qhooks) {
-      qhooks->on_single_step_trap(sloc, inside, ::std::addressof(ctx));
-    }
+    ctx.global().call_hook(&Abstract_Hooks::on_single_step_trap, sloc, ctx.zvarg()->func(), ::std::addressof(ctx));
     return air_status_next;
   }
 
@@ -2585,17 +3067,13 @@ AIR_Status do_variadic_call(Executive_Context& ctx, ParamU pu, const void* pv)
     // Unpack arguments.
     const auto& sloc = do_pcast<Pv_sloc>(pv)->sloc;
     const auto& ptc = static_cast<PTC_Aware>(pu.u8s[0]);
-    const auto& inside = ctx.zvarg()->func();
-    const auto& qhooks = ctx.global().get_hooks_opt();
 
     // Check for stack overflows.
     const auto sentry = ctx.global().copy_recursion_sentry();
     // Generate a single-step trap.
-    if(qhooks) {
-      qhooks->on_single_step_trap(sloc, inside, ::std::addressof(ctx));
-    }
+    ctx.global().call_hook(&Abstract_Hooks::on_single_step_trap, sloc, ctx.zvarg()->func(), ::std::addressof(ctx));
     // Pop the argument generator.
-    cow_vector<Reference> args;
+    auto args = ctx.global().acquire_reference_buffer();
     auto value = ctx.stack().get_top().read();
     if(value.is_null()) {
       // Leave `args` empty.
@@ -2646,41 +3124,1647 @@ AIR_Status do_variadic_call(Executive_Context& ctx, ParamU pu, const void* pv)
     if(!value.is_function()) {
       ASTERIA_THROW("attempt to call a non-function (value `$1`)", value);
     }
-    return do_function_call_common(ctx.stack().open_top().zoom_out(),sloc, ctx,
-                                   value.as_function(), ptc, ::std::move(args));
+    auto status = do_function_call_common(ctx.stack().open_top().zoom_out(),sloc, ctx,
+                                          value.as_function(), ptc, ::std::move(args));
+    // Recycle the argument buffer, which has been used as the evaluation stack of the callee.
+    ctx.global().release_reference_buffer(::std::move(args));
+    return status;
   }
 
 AIR_Status do_defer_expression(Executive_Context& ctx, ParamU /*pu*/, const void* pv)
   {
     // Unpack arguments.
-    const auto& sloc = do_pcast<Pv_defer>(pv)->sloc;
-    const auto& code_body = do_pcast<Pv_defer>(pv)->code_body;
+    const auto& expr = *do_pcast<Pv_defer>(pv);
 
-    // Rebind the body here.
-    auto pair = ::std::make_pair(false, code_body);
-    do_rebind_nodes(pair.first, pair.second, ctx);
-    // Push this expression.
-    ctx.defer_expression(sloc, pair.second);
+    // Push this expression, which has been solidified already.
+    ctx.defer_expression(expr);
     return air_status_next;
   }
 
-}  // namespace
+///////////////////////////////////////////////////////////////////////////
+// Superinstructions
+///////////////////////////////////////////////////////////////////////////
 
-opt<AIR_Node> AIR_Node::rebind_opt(const Abstract_Context& ctx) const
+// These executors combine two executors above, saving one dispatch through the queue.
+// The first one uses `pu` and the second one uses `pv`.
+template<Executor headT, Executor tailT> AIR_Status do_fused_u_v(Executive_Context& ctx, ParamU pu, const void* pv)
   {
-    switch(this->index()) {
-    case index_clear_stack: {
-        // There is nothing to bind.
-        return nullopt;
-      }
+    auto status = headT(ctx, pu, nullptr);
+    if(ROCKET_UNEXPECT(status != air_status_next)) {
+      return status;
+    }
+    return tailT(ctx, ParamU(), pv);
+  }
 
-    case index_execute_block: {
-        const auto& altr = this->m_stor.as<index_execute_block>();
-        // Check for rebinds recursively.
-        Analytic_Context ctx_body(::rocket::ref(ctx), nullptr);
-        auto pair = ::std::make_pair(false, altr);
-        do_rebind_nodes(pair.first, pair.second.code_body, ctx_body);
-        if(!pair.first) {
+// The first one uses `pv` and the second one uses `pu`.
+template<Executor headT, Executor tailT> AIR_Status do_fused_v_u(Executive_Context& ctx, ParamU pu, const void* pv)
+  {
+    auto status = headT(ctx, ParamU(), pv);
+    if(ROCKET_UNEXPECT(status != air_status_next)) {
+      return status;
+    }
+    return tailT(ctx, pu, nullptr);
+  }
+
+// This performs a comparison and branches on its result.
+// `pu.u8s[0]`, `pu.u8s[1]` and `pu.u8s[2]` are for the comparison. `pu.u8s[3]` is `negative` of the branch.
+template<Executor compareT> AIR_Status do_compare_and_branch(Executive_Context& ctx, ParamU pu, const void* pv)
+  {
+    auto status = compareT(ctx, pu, nullptr);
+    if(ROCKET_UNEXPECT(status != air_status_next)) {
+      return status;
+    }
+    ParamU bu = { };
+    bu.u8s[0] = pu.u8s[3];
+    return do_if_statement(ctx, bu, pv);
+  }
+
+// This encodes arguments of an operator.
+ParamU do_encode_xop(Xop xop, bool assign) noexcept
+  {
+    ParamU pu = { };
+    pu.u8s[0] = assign;
+    switch(::rocket::weaken_enum(xop)) {
+    case xop_cmp_eq: {
+        pu.u8s[1] = compare_equal;
+        pu.u8s[2] = false;
+        break;
+      }
+    case xop_cmp_ne: {
+        pu.u8s[1] = compare_equal;
+        pu.u8s[2] = true;
+        break;
+      }
+    case xop_cmp_lt: {
+        pu.u8s[1] = compare_less;
+        pu.u8s[2] = false;
+        break;
+      }
+    case xop_cmp_gt: {
+        pu.u8s[1] = compare_greater;
+        pu.u8s[2] = false;
+        break;
+      }
+    case xop_cmp_lte: {
+        pu.u8s[1] = compare_greater;
+        pu.u8s[2] = true;
+        break;
+      }
+    case xop_cmp_gte: {
+        pu.u8s[1] = compare_less;
+        pu.u8s[2] = true;
+        break;
+      }
+    default:
+      break;
+    }
+    return pu;
+  }
+
+// This checks whether an operator can follow an immediate value in a superinstruction.
+bool do_is_fusable_xop(Xop xop) noexcept
+  {
+    switch(::rocket::weaken_enum(xop)) {
+    case xop_cmp_eq:
+    case xop_cmp_ne:
+    case xop_cmp_lt:
+    case xop_cmp_gt:
+    case xop_cmp_lte:
+    case xop_cmp_gte:
+    case xop_add:
+    case xop_sub:
+    case xop_mul:
+    case xop_div:
+    case xop_mod:
+    case xop_andb:
+    case xop_orb:
+    case xop_xorb:
+    case xop_assign:
+      return true;
+    default:
+      return false;
+    }
+  }
+
+// In the pair counter mode, this executor is inserted between two adjacent nodes.
+// `pu.u8s[0]` and `pu.u8s[1]` are the indices of the preceding and the following nodes, respectively.
+constexpr size_t nindices = AIR_Node::Xvariant::alternative_size;
+::std::atomic<bool> s_pair_counter_mode;
+::std::atomic<uint64_t> s_pair_counts[nindices][nindices];
+
+AIR_Status do_count_pair(Executive_Context& /*ctx*/, ParamU pu, const void* /*pv*/)
+  {
+    s_pair_counts[pu.u8s[0] % nindices][pu.u8s[1] % nindices].fetch_add(1, ::std::memory_order_relaxed);
+    return air_status_next;
+  }
+
+const char* do_describe_index(size_t index) noexcept
+  {
+    static constexpr const char s_names[][32] =
+      {
+        "clear_stack",            "execute_block",          "declare_variable",
+        "initialize_variable",    "if_statement",           "switch_statement",
+        "do_while_statement",     "while_statement",        "for_each_statement",
+        "for_statement",          "try_statement",          "throw_statement",
+        "assert_statement",       "simple_status",          "glvalue_to_rvalue",
+        "push_immediate",         "push_global_reference",  "push_local_reference",
+        "push_bound_reference",   "define_function",        "branch_expression",
+        "coalescence",            "function_call",          "member_access",
+        "push_unnamed_array",     "push_unnamed_object",    "apply_operator",
+        "unpack_struct_array",    "unpack_struct_object",   "define_null_variable",
+        "single_step_trap",       "variadic_call",          "defer_expression",
+        "push_std_member",        "register_expression",    "counted_for_statement",
+        "push_captured_reference",
+      };
+    static_assert(::rocket::countof(s_names) == nindices, "");
+    return (index < nindices) ? s_names[index] : "<unknown>";
+  }
+
+///////////////////////////////////////////////////////////////////////////
+// Constant folding
+///////////////////////////////////////////////////////////////////////////
+
+// These functions mirror the executors of operators above, but operate on constant operands.
+// If an operator cannot be folded, or it would throw an exception, `false` is returned and the
+// node is left intact, so errors are still reported at run time.
+
+bool do_fold_unary(Value& rhs, Xop xop)
+  {
+    switch(::rocket::weaken_enum(xop)) {
+    case xop_pos: {
+        return true;
+      }
+    case xop_neg: {
+        if(rhs.is_integer()) {
+          auto& reg = rhs.open_integer();
+          reg = do_operator_NEG(reg);
+          return true;
+        }
+        if(rhs.is_real()) {
+          auto& reg = rhs.open_real();
+          reg = do_operator_NEG(reg);
+          return true;
+        }
+        return false;
+      }
+    case xop_notb: {
+        if(rhs.is_boolean()) {
+          auto& reg = rhs.open_boolean();
+          reg = do_operator_NOT(reg);
+          return true;
+        }
+        if(rhs.is_integer()) {
+          auto& reg = rhs.open_integer();
+          reg = do_operator_NOT(reg);
+          return true;
+        }
+        if(rhs.is_string()) {
+          auto& reg = rhs.open_string();
+          reg = do_operator_NOT(::std::move(reg));
+          return true;
+        }
+        return false;
+      }
+    case xop_notl: {
+        rhs = do_operator_NOT(rhs.test());
+        return true;
+      }
+    case xop_typeof: {
+        rhs = V_string(::rocket::sref(rhs.what_vtype()));
+        return true;
+      }
+    default:
+      return false;
+    }
+  }
+
+bool do_fold_binary(Value& rhs, const Value& lhs, Xop xop)
+  {
+    switch(::rocket::weaken_enum(xop)) {
+    case xop_cmp_eq:
+    case xop_cmp_ne: {
+        auto comp = lhs.compare(rhs);
+        rhs = V_boolean((comp == compare_equal) ^ (xop == xop_cmp_ne));
+        return true;
+      }
+    case xop_cmp_lt:
+    case xop_cmp_gt:
+    case xop_cmp_lte:
+    case xop_cmp_gte: {
+        auto comp = lhs.compare(rhs);
+        if(comp == compare_unordered) {
+          return false;
+        }
+        switch(::rocket::weaken_enum(xop)) {
+        case xop_cmp_lt:
+          rhs = V_boolean(comp == compare_less);
+          break;
+        case xop_cmp_gt:
+          rhs = V_boolean(comp == compare_greater);
+          break;
+        case xop_cmp_lte:
+          rhs = V_boolean(comp != compare_greater);
+          break;
+        default:
+          rhs = V_boolean(comp != compare_less);
+          break;
+        }
+        return true;
+      }
+    case xop_cmp_3way: {
+        auto comp = lhs.compare(rhs);
+        if(comp == compare_unordered) {
+          rhs = V_string(::rocket::sref("<unordered>"));
+          return true;
+        }
+        rhs = V_integer((comp == compare_greater) - (comp == compare_less));
+        return true;
+      }
+    case xop_add: {
+        if(lhs.is_boolean() && rhs.is_boolean()) {
+          auto& reg = rhs.open_boolean();
+          reg = do_operator_OR(lhs.as_boolean(), reg);
+          return true;
+        }
+        if(lhs.is_integer() && rhs.is_integer()) {
+          auto& reg = rhs.open_integer();
+          reg = do_operator_ADD(lhs.as_integer(), reg);
+          return true;
+        }
+        if(lhs.is_convertible_to_real() && rhs.is_convertible_to_real()) {
+          rhs = do_operator_ADD(lhs.convert_to_real(), rhs.convert_to_real());
+          return true;
+        }
+        if(lhs.is_string() && rhs.is_string()) {
+          auto& reg = rhs.open_string();
+          reg = do_operator_ADD(lhs.as_string(), reg);
+          return true;
+        }
+        return false;
+      }
+    case xop_sub: {
+        if(lhs.is_boolean() && rhs.is_boolean()) {
+          auto& reg = rhs.open_boolean();
+          reg = do_operator_XOR(lhs.as_boolean(), reg);
+          return true;
+        }
+        if(lhs.is_integer() && rhs.is_integer()) {
+          auto& reg = rhs.open_integer();
+          reg = do_operator_SUB(lhs.as_integer(), reg);
+          return true;
+        }
+        if(lhs.is_convertible_to_real() && rhs.is_convertible_to_real()) {
+          rhs = do_operator_SUB(lhs.convert_to_real(), rhs.convert_to_real());
+          return true;
+        }
+        return false;
+      }
+    case xop_mul: {
+        // Duplication of strings is not folded, as it may create very long strings.
+        if(lhs.is_boolean() && rhs.is_boolean()) {
+          auto& reg = rhs.open_boolean();
+          reg = do_operator_AND(lhs.as_boolean(), reg);
+          return true;
+        }
+        if(lhs.is_integer() && rhs.is_integer()) {
+          auto& reg = rhs.open_integer();
+          reg = do_operator_MUL(lhs.as_integer(), reg);
+          return true;
+        }
+        if(lhs.is_convertible_to_real() && rhs.is_convertible_to_real()) {
+          rhs = do_operator_MUL(lhs.convert_to_real(), rhs.convert_to_real());
+          return true;
+        }
+        return false;
+      }
+    case xop_div: {
+        if(lhs.is_integer() && rhs.is_integer()) {
+          auto& reg = rhs.open_integer();
+          reg = do_operator_DIV(lhs.as_integer(), reg);
+          return true;
+        }
+        if(lhs.is_convertible_to_real() && rhs.is_convertible_to_real()) {
+          rhs = do_operator_DIV(lhs.convert_to_real(), rhs.convert_to_real());
+          return true;
+        }
+        return false;
+      }
+    case xop_mod: {
+        if(lhs.is_integer() && rhs.is_integer()) {
+          auto& reg = rhs.open_integer();
+          reg = do_operator_MOD(lhs.as_integer(), reg);
+          return true;
+        }
+        if(lhs.is_convertible_to_real() && rhs.is_convertible_to_real()) {
+          rhs = do_operator_MOD(lhs.convert_to_real(), rhs.convert_to_real());
+          return true;
+        }
+        return false;
+      }
+    case xop_sll:
+    case xop_srl:
+    case xop_sla:
+    case xop_sra: {
+        // Shifting of strings is not folded, as it may create very long strings.
+        if(!(lhs.is_integer() && rhs.is_integer())) {
+          return false;
+        }
+        auto& reg = rhs.open_integer();
+        switch(::rocket::weaken_enum(xop)) {
+        case xop_sll:
+          reg = do_operator_SLL(lhs.as_integer(), reg);
+          break;
+        case xop_srl:
+          reg = do_operator_SRL(lhs.as_integer(), reg);
+          break;
+        case xop_sla:
+          reg = do_operator_SLA(lhs.as_integer(), reg);
+          break;
+        default:
+          reg = do_operator_SRA(lhs.as_integer(), reg);
+          break;
+        }
+        return true;
+      }
+    case xop_andb:
+    case xop_orb:
+    case xop_xorb: {
+        if(lhs.is_boolean() && rhs.is_boolean()) {
+          auto& reg = rhs.open_boolean();
+          reg = (xop == xop_andb) ? do_operator_AND(lhs.as_boolean(), reg)
+                                  : (xop == xop_orb) ? do_operator_OR(lhs.as_boolean(), reg)
+                                                     : do_operator_XOR(lhs.as_boolean(), reg);
+          return true;
+        }
+        if(lhs.is_integer() && rhs.is_integer()) {
+          auto& reg = rhs.open_integer();
+          reg = (xop == xop_andb) ? do_operator_AND(lhs.as_integer(), reg)
+                                  : (xop == xop_orb) ? do_operator_OR(lhs.as_integer(), reg)
+                                                     : do_operator_XOR(lhs.as_integer(), reg);
+          return true;
+        }
+        if(lhs.is_string() && rhs.is_string()) {
+          auto& reg = rhs.open_string();
+          reg = (xop == xop_andb) ? do_operator_AND(lhs.as_string(), ::std::move(reg))
+                                  : (xop == xop_orb) ? do_operator_OR(lhs.as_string(), ::std::move(reg))
+                                                     : do_operator_XOR(lhs.as_string(), ::std::move(reg));
+          return true;
+        }
+        return false;
+      }
+    default:
+      return false;
+    }
+  }
+
+bool do_fold_operator(Value& rhs, const Value* lhs_opt, Xop xop) noexcept
+  {
+    try {
+      return lhs_opt ? do_fold_binary(rhs, *lhs_opt, xop) : do_fold_unary(rhs, xop);
+    }
+    catch(::std::exception& /*stdex*/) {
+      // Leave the exception to be thrown at run time.
+      return false;
+    }
+  }
+
+bool do_is_binary_xop(Xop xop) noexcept
+  {
+    return (xop >= xop_cmp_eq) && (xop <= xop_xorb);
+  }
+
+///////////////////////////////////////////////////////////////////////////
+// Register-based expressions
+///////////////////////////////////////////////////////////////////////////
+
+// This is the maximum number of steps in a register-based expression.
+constexpr size_t register_steps_max = 16;
+
+using Register_File = ::rocket::static_vector<Value, register_steps_max>;
+
+const Reference* do_locate_register_reference(const Executive_Context& ctx, const Pv_register_expression& rexpr,
+                                              const AIR_Node::Register_Operand& op) noexcept
+  {
+    if(op.kind == AIR_Node::register_bound) {
+      return rexpr.refs.data() + op.index;
+    }
+    if(op.kind == AIR_Node::register_capture) {
+      return ctx.get_capture_opt(op.index);
+    }
+    ROCKET_ASSERT(op.kind == AIR_Node::register_slot);
+    // Get the context.
+    const Executive_Context* qctx = ::std::addressof(ctx);
+    ::rocket::ranged_for(uint16_t(0), op.depth, [&](uint16_t) { qctx = qctx->get_parent_opt();  });
+    ROCKET_ASSERT(qctx);
+    // Look for the slot in the context. If the declaration has been bypassed, a null pointer is returned.
+    return qctx->get_slot_opt(op.index);
+  }
+
+const Value* do_get_register_operand(const Register_File& regs, const Executive_Context& ctx,
+                                     const Pv_register_expression& rexpr, const AIR_Node::Register_Operand& op)
+  {
+    switch(::rocket::weaken_enum(op.kind)) {
+    case AIR_Node::register_temp:
+      return regs.data() + op.index;
+    case AIR_Node::register_const:
+      return rexpr.consts.data() + op.index;
+    default: {
+        auto qref = do_locate_register_reference(ctx, rexpr, op);
+        return qref ? ::std::addressof(qref->read()) : nullptr;
+      }
+    }
+  }
+
+bool do_evaluate_registers(Register_File& regs, const Executive_Context& ctx, const Pv_register_expression& rexpr)
+noexcept
+  {
+    try {
+      for(const auto& step : rexpr.steps) {
+        // Get the LHS operand, which is not modified.
+        auto lhs = do_get_register_operand(regs, ctx, rexpr, step.lhs);
+        if(!lhs) {
+          return false;
+        }
+        // Get the RHS operand, which receives the result. As temporary registers are never read twice,
+        // they can be moved from.
+        Value rhs;
+        if(step.rhs.kind == AIR_Node::register_temp) {
+          rhs = ::std::move(regs.mut(step.rhs.index));
+        }
+        else {
+          auto qrhs = do_get_register_operand(regs, ctx, rexpr, step.rhs);
+          if(!qrhs) {
+            return false;
+          }
+          rhs = *qrhs;
+        }
+        // Apply the operator like its executor does.
+        if(!do_fold_binary(rhs, *lhs, step.xop)) {
+          return false;
+        }
+        regs.emplace_back(::std::move(rhs));
+      }
+      return true;
+    }
+    catch(::std::exception& /*stdex*/) {
+      // Leave the exception to be thrown by stack-based code.
+      return false;
+    }
+  }
+
+AIR_Status do_register_expression(Executive_Context& ctx, ParamU /*pu*/, const void* pv)
+  {
+    // Unpack arguments.
+    const auto& rexpr = *(do_pcast<Pv_register_expression>(pv));
+
+    // Locate the target, if any.
+    const Reference* qtarget = nullptr;
+    if(rexpr.target.kind != AIR_Node::register_none) {
+      qtarget = do_locate_register_reference(ctx, rexpr, rexpr.target);
+      if(!qtarget) {
+        return rexpr.queue_stack.execute(ctx);
+      }
+    }
+    // Evaluate all steps. Should anything unusual happen, such as an operator that would throw an exception,
+    // evaluate the expression again using stack-based code, which reports errors as usual. Nothing has to be
+    // undone, as operators have no side effects.
+    Register_File regs;
+    if(!do_evaluate_registers(regs, ctx, rexpr)) {
+      return rexpr.queue_stack.execute(ctx);
+    }
+    if(!qtarget) {
+      // Push the result as a temporary.
+      Reference_root::S_temporary xref = { ::std::move(regs.mut_back()) };
+      ctx.stack().push(::std::move(xref));
+      return air_status_next;
+    }
+    // Assign the result to the target, then push the target.
+    qtarget->open() = ::std::move(regs.mut_back());
+    ctx.stack().push(*qtarget);
+    return air_status_next;
+  }
+
+///////////////////////////////////////////////////////////////////////////
+// Counted loops
+///////////////////////////////////////////////////////////////////////////
+
+bool do_test_counted_for(int64_t count, Xop xop, int64_t bound) noexcept
+  {
+    switch(::rocket::weaken_enum(xop)) {
+    case xop_cmp_lt:
+      return count < bound;
+    case xop_cmp_gt:
+      return count > bound;
+    case xop_cmp_lte:
+      return count <= bound;
+    default:
+      return count >= bound;
+    }
+  }
+
+AIR_Status do_counted_for_statement(Executive_Context& ctx, ParamU /*pu*/, const void* pv)
+  {
+    // Unpack arguments.
+    const auto& queue_init = do_pcast<Pv_counted_for>(pv)->queue_init;
+    const auto& queue_cond = do_pcast<Pv_counted_for>(pv)->queue_cond;
+    const auto& queue_step = do_pcast<Pv_counted_for>(pv)->queue_step;
+    const auto& queue_body = do_pcast<Pv_counted_for>(pv)->queue_body;
+    const auto& slot = do_pcast<Pv_counted_for>(pv)->slot;
+    const auto& materialize = do_pcast<Pv_counted_for>(pv)->materialize;
+    const auto& xop_cond = do_pcast<Pv_counted_for>(pv)->xop_cond;
+    const auto& bound = do_pcast<Pv_counted_for>(pv)->bound;
+    const auto& bound_const = do_pcast<Pv_counted_for>(pv)->bound_const;
+    const auto& bound_ref = do_pcast<Pv_counted_for>(pv)->bound_ref;
+    const auto& xop_step = do_pcast<Pv_counted_for>(pv)->xop_step;
+    const auto& step = do_pcast<Pv_counted_for>(pv)->step;
+
+    // This is a `for` statement whose condition compares a loop variable with a bound, and whose increment adds
+    // a constant to the loop variable. The loop variable is kept in a native integer, which is written to the
+    // variable before the body is executed only if the body may refer to it. Should anything unusual happen, such
+    // as a loop variable or bound that is not an integer, or hooks that expect single-step traps, the remaining
+    // iterations are performed by equivalent code of the condition and the increment.
+    Executive_Context ctx_for(::rocket::ref(ctx), nullptr);
+    auto status = queue_init.execute(ctx_for);
+    ROCKET_ASSERT(status == air_status_next);
+    // Get the loop variable, which shall be a mutable integer.
+    auto qref = ctx_for.get_slot_opt(slot);
+    auto qval = qref ? qref->open_fast_opt() : nullptr;
+    if(!qval || !qval->is_integer()) {
+      return do_loop_for(ctx_for, queue_cond, queue_step, queue_body);
+    }
+    // Get the context of the bound, which doesn't change during the loop, although its value might.
+    const Executive_Context* qctx = ::std::addressof(ctx_for);
+    if(bound.kind == AIR_Node::register_slot) {
+      ::rocket::ranged_for(uint16_t(0), bound.depth, [&](uint16_t) { qctx = qctx->get_parent_opt();  });
+      ROCKET_ASSERT(qctx);
+    }
+    auto count = qval->as_integer();
+    for(;;) {
+      // Check the condition.
+      int64_t limit = bound_const;
+      if(bound.kind != AIR_Node::register_const) {
+        auto qbound = (bound.kind == AIR_Node::register_slot) ? qctx->get_slot_opt(bound.index)
+                    : (bound.kind == AIR_Node::register_capture) ? ctx_for.get_capture_opt(bound.index)
+                    : ::std::addressof(bound_ref);
+        auto qlimit = qbound ? qbound->read_fast_opt() : nullptr;
+        if(!qlimit || !qlimit->is_integer()) {
+          *qval = count;
+          return do_loop_for(ctx_for, queue_cond, queue_step, queue_body);
+        }
+        limit = qlimit->as_integer();
+      }
+      if(ROCKET_UNEXPECT(ctx.global().has_hooks())) {
+        *qval = count;
+        return do_loop_for(ctx_for, queue_cond, queue_step, queue_body);
+      }
+      if(!do_test_counted_for(count, xop_cond, limit)) {
+        break;
+      }
+      // Execute the body.
+      if(materialize) {
+        *qval = count;
+      }
+      status = do_execute_block(queue_body, ctx_for);
+      if(::rocket::is_any_of(status, { air_status_break_unspec, air_status_break_for }))
+        return air_status_next;
+      if(::rocket::is_none_of(status, { air_status_next, air_status_continue_unspec, air_status_continue_for }))
+        return status;
+      // Read the loop variable back, which the body might have modified.
+      if(materialize && qval->is_integer()) {
+        count = qval->as_integer();
+      }
+      if(ROCKET_UNEXPECT(!qval->is_integer() || ctx.global().has_hooks())) {
+        // Perform the remaining iterations, starting from the increment.
+        if(qval->is_integer()) {
+          *qval = count;
+        }
+        status = queue_step.execute(ctx_for);
+        ROCKET_ASSERT(status == air_status_next);
+        return do_loop_for(ctx_for, queue_cond, queue_step, queue_body);
+      }
+      // Execute the increment.
+      count = (xop_step == xop_sub) ? do_operator_SUB(count, step) : do_operator_ADD(count, step);
+    }
+    // Write the final value in case that the variable has been captured.
+    if(materialize) {
+      *qval = count;
+    }
+    return air_status_next;
+  }
+
+}  // namespace
+
+bool AIR_Node::do_lower_to_registers(cow_vector<AIR_Node>& code, const S_apply_operator& altr)
+  {
+    // Only binary operators and assignments to local variables can be lowered.
+    bool store = (altr.xop == xop_assign);
+    if(!store && (altr.assign || !do_is_binary_xop(altr.xop))) {
+      return false;
+    }
+    if(code.size() < 2) {
+      return false;
+    }
+    const auto& lhs = code[code.size() - 2];
+    const auto& rhs = code.back();
+    // Check whether both operands can be lowered. Operators with constant operands are left for folding.
+    auto get_nsteps = [&](const AIR_Node& node) -> size_t
+      {
+        switch(::rocket::weaken_enum(node.index())) {
+        case index_push_immediate:
+          return !store;
+        case index_push_local_reference: {
+            const auto& altr2 = node.m_stor.as<index_push_local_reference>();
+            return (altr2.slot != UINT32_MAX) && (altr2.depth <= UINT16_MAX);
+          }
+        case index_register_expression: {
+            const auto& altr2 = node.m_stor.as<index_register_expression>();
+            return (altr2.target.kind == register_none) ? altr2.steps.size() : 0;
+          }
+        default:
+          return 0;
+        }
+      };
+    size_t nlhs = get_nsteps(lhs);
+    size_t nrhs = get_nsteps(rhs);
+    if((nlhs == 0) || (nrhs == 0)) {
+      return false;
+    }
+    if(store ? (lhs.index() != index_push_local_reference) || (rhs.index() != index_register_expression)
+             : (lhs.index() == index_push_immediate) && (rhs.index() == index_push_immediate)) {
+      return false;
+    }
+    if(nlhs - (lhs.index() != index_register_expression) + nrhs + !store > register_steps_max) {
+      return false;
+    }
+
+    // Convert operands, then append them to the new node, together with their stack-based code.
+    S_register_expression xnode = { };
+    xnode.target.kind = register_none;
+    auto import = [&](const AIR_Node& node) -> Register_Operand
+      {
+        Register_Operand op = { };
+        switch(::rocket::weaken_enum(node.index())) {
+        case index_push_immediate: {
+            const auto& altr2 = node.m_stor.as<index_push_immediate>();
+            op.kind = register_const;
+            op.index = static_cast<uint32_t>(xnode.consts.size());
+            xnode.consts.emplace_back(altr2.val);
+            xnode.code_stack.emplace_back(node);
+            return op;
+          }
+        case index_push_local_reference: {
+            const auto& altr2 = node.m_stor.as<index_push_local_reference>();
+            op.kind = register_slot;
+            op.depth = static_cast<uint16_t>(altr2.depth);
+            op.index = altr2.slot;
+            xnode.code_stack.emplace_back(node);
+            return op;
+          }
+        default: {
+            const auto& altr2 = node.m_stor.as<index_register_expression>();
+            // Relocate operands of nested steps.
+            auto nsteps = static_cast<uint32_t>(xnode.steps.size());
+            auto nconsts = static_cast<uint32_t>(xnode.consts.size());
+            auto nrefs = static_cast<uint32_t>(xnode.refs.size());
+            auto relocate = [&](Register_Operand& op2)
+              {
+                op2.index += (op2.kind == register_temp) ? nsteps
+                           : (op2.kind == register_const) ? nconsts
+                           : (op2.kind == register_bound) ? nrefs : 0;
+              };
+            for(auto step : altr2.steps) {
+              relocate(step.lhs);
+              relocate(step.rhs);
+              xnode.steps.emplace_back(step);
+            }
+            xnode.consts.append(altr2.consts.begin(), altr2.consts.end());
+            xnode.refs.append(altr2.refs.begin(), altr2.refs.end());
+            xnode.code_stack.append(altr2.code_stack.begin(), altr2.code_stack.end());
+            op.kind = register_temp;
+            op.index = static_cast<uint32_t>(xnode.steps.size() - 1);
+            return op;
+          }
+        }
+      };
+    auto oplhs = import(lhs);
+    auto oprhs = import(rhs);
+    if(store) {
+      // The result of the last step is assigned to the LHS operand.
+      xnode.target = oplhs;
+    }
+    else {
+      Register_Step step = { altr.xop, oplhs, oprhs };
+      xnode.steps.emplace_back(step);
+    }
+    xnode.code_stack.emplace_back(altr);
+    // Replace both operands with the new node.
+    code.pop_back(2);
+    code.emplace_back(::std::move(xnode));
+    return true;
+  }
+
+bool AIR_Node::do_refers_to_local(const cow_vector<AIR_Node>& code, const phsh_string& name)
+  {
+    // Names are compared regardless of depths, which may yield false positives, but never false negatives.
+    auto refers = [&](const cow_vector<AIR_Node>& nested) { return do_refers_to_local(nested, name);  };
+    return ::std::any_of(code.begin(), code.end(),
+      [&](const AIR_Node& node)
+        {
+          switch(::rocket::weaken_enum(node.index())) {
+          case index_push_local_reference:
+            return node.m_stor.as<index_push_local_reference>().name == name;
+          case index_execute_block:
+            return refers(node.m_stor.as<index_execute_block>().code_body);
+          case index_if_statement: {
+              const auto& altr = node.m_stor.as<index_if_statement>();
+              return refers(altr.code_true) || refers(altr.code_false);
+            }
+          case index_switch_statement: {
+              const auto& altr = node.m_stor.as<index_switch_statement>();
+              return ::std::any_of(altr.code_labels.begin(), altr.code_labels.end(), refers) ||
+                     ::std::any_of(altr.code_bodies.begin(), altr.code_bodies.end(), refers);
+            }
+          case index_do_while_statement: {
+              const auto& altr = node.m_stor.as<index_do_while_statement>();
+              return refers(altr.code_body) || refers(altr.code_cond);
+            }
+          case index_while_statement: {
+              const auto& altr = node.m_stor.as<index_while_statement>();
+              return refers(altr.code_cond) || refers(altr.code_body);
+            }
+          case index_for_each_statement: {
+              const auto& altr = node.m_stor.as<index_for_each_statement>();
+              return refers(altr.code_init) || refers(altr.code_body);
+            }
+          case index_for_statement: {
+              const auto& altr = node.m_stor.as<index_for_statement>();
+              return refers(altr.code_init) || refers(altr.code_cond) || refers(altr.code_step) ||
+                     refers(altr.code_body);
+            }
+          case index_try_statement: {
+              const auto& altr = node.m_stor.as<index_try_statement>();
+              return refers(altr.code_try) || refers(altr.code_catch);
+            }
+          case index_define_function:
+            return refers(node.m_stor.as<index_define_function>().code_body);
+          case index_branch_expression: {
+              const auto& altr = node.m_stor.as<index_branch_expression>();
+              return refers(altr.code_true) || refers(altr.code_false);
+            }
+          case index_coalescence:
+            return refers(node.m_stor.as<index_coalescence>().code_null);
+          case index_defer_expression:
+            return refers(node.m_stor.as<index_defer_expression>().code_body);
+          case index_register_expression:
+            return refers(node.m_stor.as<index_register_expression>().code_stack);
+          case index_counted_for_statement: {
+              const auto& altr = node.m_stor.as<index_counted_for_statement>();
+              return refers(altr.code_init) || refers(altr.code_cond) || refers(altr.code_step) ||
+                     refers(altr.code_body);
+            }
+          default:
+            return false;
+          }
+        });
+  }
+
+bool AIR_Node::do_specialize_counted_for(cow_vector<AIR_Node>& code, const S_for_statement& altr)
+  {
+    // Single-step traps and stack clears are skipped. Hooks are checked at runtime.
+    auto skip_prologue = [&](const cow_vector<AIR_Node>& nested)
+      {
+        size_t k = 0;
+        while((k < nested.size()) && ::rocket::is_any_of(nested[k].index(),
+                                                         { index_single_step_trap, index_clear_stack }))
+          ++k;
+        return k;
+      };
+    auto is_local_slot = [&](const AIR_Node& node)
+      {
+        if(node.index() != index_push_local_reference) {
+          return false;
+        }
+        const auto& altr2 = node.m_stor.as<index_push_local_reference>();
+        return (altr2.slot != UINT32_MAX) && (altr2.depth <= UINT16_MAX);
+      };
+    auto is_relational = [&](Xop xop)
+      {
+        return ::rocket::is_any_of(xop, { xop_cmp_lt, xop_cmp_gt, xop_cmp_lte, xop_cmp_gte });
+      };
+
+    // Match the condition, which shall compare a loop variable with an integer or another variable.
+    // This is either `push_local_reference`, `push_immediate` or `push_local_reference`, `apply_operator`,
+    // or a register-based expression of a single step.
+    S_counted_for_statement xnode = { };
+    const AIR_Node* qvar;
+    size_t k = skip_prologue(altr.code_cond);
+    if((altr.code_cond.size() - k == 1) && (altr.code_cond[k].index() == index_register_expression)) {
+      const auto& rexpr = altr.code_cond[k].m_stor.as<index_register_expression>();
+      if((rexpr.steps.size() != 1) || (rexpr.target.kind != register_none)) {
+        return false;
+      }
+      const auto& step = rexpr.steps.front();
+      if(!is_relational(step.xop) || (step.lhs.kind != register_slot) || (step.lhs.depth != 0)) {
+        return false;
+      }
+      xnode.xop_cond = step.xop;
+      xnode.bound = step.rhs;
+      if(step.rhs.kind == register_const) {
+        if(!rexpr.consts[step.rhs.index].is_integer()) {
+          return false;
+        }
+        xnode.bound_const = rexpr.consts[step.rhs.index].as_integer();
+      }
+      else if(step.rhs.kind != register_slot) {
+        return false;
+      }
+      qvar = rexpr.code_stack.data();
+    }
+    else if(altr.code_cond.size() - k == 3) {
+      const auto& lhs = altr.code_cond[k];
+      const auto& rhs = altr.code_cond[k+1];
+      const auto& op = altr.code_cond[k+2];
+      if(!is_local_slot(lhs) || (op.index() != index_apply_operator)) {
+        return false;
+      }
+      const auto& altr2 = op.m_stor.as<index_apply_operator>();
+      if(altr2.assign || !is_relational(altr2.xop)) {
+        return false;
+      }
+      xnode.xop_cond = altr2.xop;
+      if(rhs.index() == index_push_immediate) {
+        const auto& val = rhs.m_stor.as<index_push_immediate>().val;
+        if(!val.is_integer()) {
+          return false;
+        }
+        xnode.bound.kind = register_const;
+        xnode.bound_const = val.as_integer();
+      }
+      else if(is_local_slot(rhs)) {
+        const auto& altr3 = rhs.m_stor.as<index_push_local_reference>();
+        xnode.bound.kind = register_slot;
+        xnode.bound.depth = static_cast<uint16_t>(altr3.depth);
+        xnode.bound.index = altr3.slot;
+      }
+      else {
+        return false;
+      }
+      qvar = ::std::addressof(lhs);
+    }
+    else {
+      return false;
+    }
+    const auto& var = qvar->m_stor.as<index_push_local_reference>();
+    if(var.depth != 0) {
+      return false;
+    }
+    if((xnode.bound.kind == register_slot) && (xnode.bound.depth == 0) && (xnode.bound.index == var.slot)) {
+      return false;
+    }
+    xnode.slot = var.slot;
+
+    // Match the increment, which shall add or subtract a constant integer to or from the loop variable.
+    // This is either `push_local_reference`, `apply_operator` of `++` or `--`, or `push_local_reference`,
+    // `push_immediate`, `apply_operator` of `+=` or `-=`.
+    k = skip_prologue(altr.code_step);
+    if((altr.code_step.size() - k < 2) || !is_local_slot(altr.code_step[k])) {
+      return false;
+    }
+    const auto& svar = altr.code_step[k].m_stor.as<index_push_local_reference>();
+    if((svar.depth != 0) || (svar.slot != var.slot)) {
+      return false;
+    }
+    if(altr.code_step.size() - k == 2) {
+      if(altr.code_step[k+1].index() != index_apply_operator) {
+        return false;
+      }
+      switch(::rocket::weaken_enum(altr.code_step[k+1].m_stor.as<index_apply_operator>().xop)) {
+      case xop_inc_pre:
+      case xop_inc_post:
+        xnode.xop_step = xop_add;
+        break;
+      case xop_dec_pre:
+      case xop_dec_post:
+        xnode.xop_step = xop_sub;
+        break;
+      default:
+        return false;
+      }
+      xnode.step = 1;
+    }
+    else if(altr.code_step.size() - k == 3) {
+      const auto& rhs = altr.code_step[k+1];
+      const auto& op = altr.code_step[k+2];
+      if((rhs.index() != index_push_immediate) || (op.index() != index_apply_operator)) {
+        return false;
+      }
+      const auto& val = rhs.m_stor.as<index_push_immediate>().val;
+      const auto& altr2 = op.m_stor.as<index_apply_operator>();
+      if(!val.is_integer() || !altr2.assign || ::rocket::is_none_of(altr2.xop, { xop_add, xop_sub })) {
+        return false;
+      }
+      xnode.xop_step = altr2.xop;
+      xnode.step = val.as_integer();
+    }
+    else {
+      return false;
+    }
+
+    // The loop variable has to be written to the variable only if it is referenced by other code.
+    xnode.materialize = do_refers_to_local(altr.code_init, var.name) ||
+                        do_refers_to_local(altr.code_body, var.name);
+    xnode.code_init = altr.code_init;
+    xnode.code_cond = altr.code_cond;
+    xnode.code_step = altr.code_step;
+    xnode.code_body = altr.code_body;
+    code.emplace_back(::std::move(xnode));
+    return true;
+  }
+
+cow_vector<AIR_Node>& AIR_Node::do_append_optimized(cow_vector<AIR_Node>& code, AIR_Node&& node,
+                                                     const Compiler_Options& opts)
+  {
+    switch(::rocket::weaken_enum(node.index())) {
+    case index_for_statement: {
+        const auto& altr = node.m_stor.as<index_for_statement>();
+        // Check whether this is a counted loop.
+        if(do_specialize_counted_for(code, altr)) {
+          return code;
+        }
+        break;
+      }
+
+    case index_if_statement: {
+        auto& altr = node.m_stor.as<index_if_statement>();
+        // Check whether the condition is a constant.
+        if(code.empty() || (code.back().index() != index_push_immediate)) {
+          break;
+        }
+        bool cond = code.back().m_stor.as<index_push_immediate>().val.test();
+        code.pop_back();
+        // Only the branch that would be taken is kept. It still requires its own scope.
+        auto& code_branch = (cond != altr.negative) ? altr.code_true : altr.code_false;
+        if(code_branch.empty()) {
+          return code;
+        }
+        S_execute_block xnode = { ::std::move(code_branch) };
+        return code.emplace_back(::std::move(xnode)), code;
+      }
+
+    case index_glvalue_to_rvalue: {
+        // Constants and results of register-based expressions are rvalues already.
+        if(code.empty()) {
+          break;
+        }
+        if(code.back().index() == index_push_immediate) {
+          return code;
+        }
+        if((code.back().index() == index_register_expression) &&
+           (code.back().m_stor.as<index_register_expression>().target.kind == register_none)) {
+          return code;
+        }
+        break;
+      }
+
+    case index_branch_expression: {
+        auto& altr = node.m_stor.as<index_branch_expression>();
+        // Check whether the condition is a constant.
+        if(altr.assign || code.empty() || (code.back().index() != index_push_immediate)) {
+          break;
+        }
+        bool cond = code.back().m_stor.as<index_push_immediate>().val.test();
+        // If the branch is empty, the condition is the result.
+        auto& code_branch = cond ? altr.code_true : altr.code_false;
+        if(code_branch.empty()) {
+          return code;
+        }
+        // Otherwise the condition is discarded and the branch is evaluated in place.
+        code.pop_back();
+        for(size_t i = 0;  i < code_branch.size();  ++i) {
+          do_append_optimized(code, ::std::move(code_branch.mut(i)), opts);
+        }
+        return code;
+      }
+
+    case index_coalescence: {
+        auto& altr = node.m_stor.as<index_coalescence>();
+        // Check whether the condition is a constant.
+        if(altr.assign || code.empty() || (code.back().index() != index_push_immediate)) {
+          break;
+        }
+        // If the condition is not null or the branch is empty, the condition is the result.
+        bool cond = code.back().m_stor.as<index_push_immediate>().val.is_null();
+        if(!cond || altr.code_null.empty()) {
+          return code;
+        }
+        // Otherwise the condition is discarded and the branch is evaluated in place.
+        code.pop_back();
+        for(size_t i = 0;  i < altr.code_null.size();  ++i) {
+          do_append_optimized(code, ::std::move(altr.code_null.mut(i)), opts);
+        }
+        return code;
+      }
+
+    case index_apply_operator: {
+        const auto& altr = node.m_stor.as<index_apply_operator>();
+        // Lower the operator to registers if enabled.
+        if(opts.register_expressions && do_lower_to_registers(code, altr)) {
+          return code;
+        }
+        // Check whether all operands are constants.
+        size_t nops = do_is_binary_xop(altr.xop) ? 2 : 1;
+        if(altr.assign || (code.size() < nops)) {
+          break;
+        }
+        for(size_t k = code.size() - nops;  k < code.size();  ++k) {
+          if(code[k].index() != index_push_immediate)
+            return code.emplace_back(::std::move(node)), code;
+        }
+        // Evaluate the operator on a copy of the RHS operand, which is left intact upon failure.
+        auto rhs = code.back().m_stor.as<index_push_immediate>().val;
+        const Value* lhs_opt = nullptr;
+        if(nops == 2) {
+          lhs_opt = ::std::addressof(code.at(code.size() - 2).m_stor.as<index_push_immediate>().val);
+        }
+        if(!do_fold_operator(rhs, lhs_opt, altr.xop)) {
+          break;
+        }
+        // Replace all operands with the result.
+        code.pop_back(nops);
+        S_push_immediate xnode = { ::std::move(rhs) };
+        return code.emplace_back(::std::move(xnode)), code;
+      }
+
+    case index_member_access: {
+        const auto& altr = node.m_stor.as<index_member_access>();
+        // Check for `std.<module>.<member>`, if enabled.
+        if(!opts.bind_std_members || (code.size() < 2)) {
+          break;
+        }
+        const auto& head = code[code.size() - 2];
+        if((head.index() != index_push_global_reference) ||
+           (head.m_stor.as<index_push_global_reference>().name != ::rocket::sref("std"))) {
+          break;
+        }
+        if(code.back().index() != index_member_access) {
+          break;
+        }
+        // Replace all three nodes with a single one.
+        S_push_std_member xnode = { code.back().m_stor.as<index_member_access>().name, altr.name };
+        code.pop_back(2);
+        return code.emplace_back(::std::move(xnode)), code;
+      }
+
+    default:
+      break;
+    }
+    // Append the node as is.
+    return code.emplace_back(::std::move(node)), code;
+  }
+
+cow_vector<AIR_Node>& AIR_Node::do_optimize_nested(cow_vector<AIR_Node>& code, const Compiler_Options& opts)
+  {
+    cow_vector<AIR_Node> temp;
+    temp.reserve(code.size());
+    for(size_t i = 0;  i < code.size();  ++i) {
+      auto node = ::std::move(code.mut(i));
+      // Optimize nested code first.
+      switch(::rocket::weaken_enum(node.index())) {
+      case index_execute_block: {
+          auto& altr = node.m_stor.as<index_execute_block>();
+          do_optimize_nested(altr.code_body, opts);
+          break;
+        }
+      case index_if_statement: {
+          auto& altr = node.m_stor.as<index_if_statement>();
+          do_optimize_nested(altr.code_true, opts);
+          do_optimize_nested(altr.code_false, opts);
+          break;
+        }
+      case index_switch_statement: {
+          auto& altr = node.m_stor.as<index_switch_statement>();
+          for(size_t k = 0;  k < altr.code_bodies.size();  ++k) {
+            do_optimize_nested(altr.code_labels.mut(k), opts);
+            do_optimize_nested(altr.code_bodies.mut(k), opts);
+          }
+          break;
+        }
+      case index_do_while_statement: {
+          auto& altr = node.m_stor.as<index_do_while_statement>();
+          do_optimize_nested(altr.code_body, opts);
+          do_optimize_nested(altr.code_cond, opts);
+          break;
+        }
+      case index_while_statement: {
+          auto& altr = node.m_stor.as<index_while_statement>();
+          do_optimize_nested(altr.code_cond, opts);
+          do_optimize_nested(altr.code_body, opts);
+          break;
+        }
+      case index_for_each_statement: {
+          auto& altr = node.m_stor.as<index_for_each_statement>();
+          do_optimize_nested(altr.code_init, opts);
+          do_optimize_nested(altr.code_body, opts);
+          break;
+        }
+      case index_for_statement: {
+          auto& altr = node.m_stor.as<index_for_statement>();
+          do_optimize_nested(altr.code_init, opts);
+          do_optimize_nested(altr.code_cond, opts);
+          do_optimize_nested(altr.code_step, opts);
+          do_optimize_nested(altr.code_body, opts);
+          break;
+        }
+      case index_counted_for_statement: {
+          auto& altr = node.m_stor.as<index_counted_for_statement>();
+          do_optimize_nested(altr.code_init, opts);
+          do_optimize_nested(altr.code_cond, opts);
+          do_optimize_nested(altr.code_step, opts);
+          do_optimize_nested(altr.code_body, opts);
+          break;
+        }
+      case index_try_statement: {
+          auto& altr = node.m_stor.as<index_try_statement>();
+          do_optimize_nested(altr.code_try, opts);
+          do_optimize_nested(altr.code_catch, opts);
+          break;
+        }
+      case index_branch_expression: {
+          auto& altr = node.m_stor.as<index_branch_expression>();
+          do_optimize_nested(altr.code_true, opts);
+          do_optimize_nested(altr.code_false, opts);
+          break;
+        }
+      case index_coalescence: {
+          auto& altr = node.m_stor.as<index_coalescence>();
+          do_optimize_nested(altr.code_null, opts);
+          break;
+        }
+      case index_defer_expression: {
+          auto& altr = node.m_stor.as<index_defer_expression>();
+          do_optimize_nested(altr.code_body, opts);
+          break;
+        }
+      default:
+        break;
+      }
+      // Fold this node into preceding ones if possible.
+      do_append_optimized(temp, ::std::move(node), opts);
+      // Nodes after a jump or a `throw` statement are unreachable.
+      if(temp.empty()) {
+        continue;
+      }
+      const auto& last = temp.back();
+      if((last.index() == index_throw_statement) ||
+         ((last.index() == index_simple_status) && (last.m_stor.as<index_simple_status>().status != air_status_next))) {
+        break;
+      }
+    }
+    code.swap(temp);
+    return code;
+  }
+
+bool AIR_Node::do_may_escape(cow_vector<uint8_t>& stack, const cow_vector<AIR_Node>& code, size_t start,
+                             const phsh_string& name)
+  {
+    // Each element of `stack` tells whether the reference at that position may designate the variable (`1`) or a
+    // part of it (`2`). Names are compared regardless of depths, which may yield false positives, but never false
+    // negatives.
+    auto pop = [&](size_t n)
+      {
+        uint8_t tainted = 0;
+        for(size_t k = 0;  (k < n) && !stack.empty();  ++k) {
+          tainted = ::rocket::max(tainted, stack.back());
+          stack.pop_back();
+        }
+        return tainted;
+      };
+    auto nested = [&](const cow_vector<AIR_Node>& body)
+      {
+        cow_vector<uint8_t> temp;
+        return do_may_escape(temp, body, 0, name);
+      };
+    auto branch = [&](uint8_t& tainted, const cow_vector<AIR_Node>& body)
+      {
+        // The branch shall push exactly one reference, which may become the result.
+        if(body.empty()) {
+          return false;
+        }
+        auto temp = stack;
+        if(do_may_escape(temp, body, 0, name) || (temp.size() != stack.size() + 1)) {
+          return true;
+        }
+        tainted = ::rocket::max(tainted, temp.back());
+        return false;
+      };
+
+    for(size_t i = start;  i < code.size();  ++i) {
+      const auto& node = code[i];
+      switch(::rocket::weaken_enum(node.index())) {
+      case index_clear_stack:
+        stack.clear();
+        break;
+
+      case index_execute_block:
+        if(nested(node.m_stor.as<index_execute_block>().code_body))
+          return true;
+        break;
+
+      case index_declare_variable:
+        stack.emplace_back(node.m_stor.as<index_declare_variable>().name == name);
+        break;
+
+      case index_initialize_variable:
+        pop(2);
+        break;
+
+      case index_if_statement: {
+          const auto& altr = node.m_stor.as<index_if_statement>();
+          if(nested(altr.code_true) || nested(altr.code_false))
+            return true;
+          break;
+        }
+
+      case index_switch_statement: {
+          const auto& altr = node.m_stor.as<index_switch_statement>();
+          if(::std::any_of(altr.code_labels.begin(), altr.code_labels.end(), nested) ||
+             ::std::any_of(altr.code_bodies.begin(), altr.code_bodies.end(), nested))
+            return true;
+          break;
+        }
+
+      case index_do_while_statement: {
+          const auto& altr = node.m_stor.as<index_do_while_statement>();
+          if(nested(altr.code_body) || nested(altr.code_cond))
+            return true;
+          break;
+        }
+
+      case index_while_statement: {
+          const auto& altr = node.m_stor.as<index_while_statement>();
+          if(nested(altr.code_cond) || nested(altr.code_body))
+            return true;
+          break;
+        }
+
+      case index_for_each_statement: {
+          const auto& altr = node.m_stor.as<index_for_each_statement>();
+          // Elements of the range are referenced by the mapped reference.
+          cow_vector<uint8_t> temp;
+          if(do_may_escape(temp, altr.code_init, 0, name) || (!temp.empty() && temp.back()) ||
+             nested(altr.code_body))
+            return true;
+          break;
+        }
+
+      case index_for_statement: {
+          const auto& altr = node.m_stor.as<index_for_statement>();
+          if(nested(altr.code_init) || nested(altr.code_cond) || nested(altr.code_step) || nested(altr.code_body))
+            return true;
+          break;
+        }
+
+      case index_counted_for_statement: {
+          const auto& altr = node.m_stor.as<index_counted_for_statement>();
+          if(nested(altr.code_init) || nested(altr.code_cond) || nested(altr.code_step) || nested(altr.code_body))
+            return true;
+          break;
+        }
+
+      case index_try_statement: {
+          const auto& altr = node.m_stor.as<index_try_statement>();
+          if(nested(altr.code_try) || nested(altr.code_catch))
+            return true;
+          break;
+        }
+
+      case index_throw_statement:
+      case index_assert_statement:
+      case index_single_step_trap:
+      case index_define_null_variable:
+        break;
+
+      case index_member_access:
+        if(!stack.empty() && stack.back())
+          stack.mut_back() = 2;
+        break;
+
+      case index_simple_status:
+        // A reference that is returned by reference escapes.
+        if((node.m_stor.as<index_simple_status>().status == air_status_return_ref) && pop(1))
+          return true;
+        break;
+
+      case index_glvalue_to_rvalue:
+        if(!stack.empty())
+          stack.mut_back() = 0;
+        break;
+
+      case index_push_immediate:
+      case index_push_global_reference:
+      case index_push_bound_reference:
+      case index_push_std_member:
+      case index_push_captured_reference:
+        stack.emplace_back(0);
+        break;
+
+      case index_push_local_reference:
+        stack.emplace_back(node.m_stor.as<index_push_local_reference>().name == name);
+        break;
+
+      case index_define_function:
+        // A variable that a nested function refers to is captured.
+        if(do_refers_to_local(node.m_stor.as<index_define_function>().code_body, name))
+          return true;
+        stack.emplace_back(0);
+        break;
+
+      case index_branch_expression: {
+          const auto& altr = node.m_stor.as<index_branch_expression>();
+          // The result is either the condition or the result of a branch.
+          uint8_t tainted = pop(1);
+          if(branch(tainted, altr.code_true) || branch(tainted, altr.code_false))
+            return true;
+          stack.emplace_back(tainted);
+          break;
+        }
+
+      case index_coalescence: {
+          const auto& altr = node.m_stor.as<index_coalescence>();
+          uint8_t tainted = pop(1);
+          if(branch(tainted, altr.code_null))
+            return true;
+          stack.emplace_back(tainted);
+          break;
+        }
+
+      case index_function_call:
+      case index_variadic_call: {
+          // Arguments that are not converted to rvalues are passed by reference. If the target is a part of the
+          // variable, the variable is passed as `this`.
+          size_t nargs = 1;
+          if(node.index() == index_function_call)
+            nargs = node.m_stor.as<index_function_call>().nargs;
+          if(pop(nargs) || (pop(1) > 1))
+            return true;
+          stack.emplace_back(0);
+          break;
+        }
+
+      case index_push_unnamed_array:
+        pop(node.m_stor.as<index_push_unnamed_array>().nelems);
+        stack.emplace_back(0);
+        break;
+
+      case index_push_unnamed_object:
+        pop(node.m_stor.as<index_push_unnamed_object>().keys.size());
+        stack.emplace_back(0);
+        break;
+
+      case index_apply_operator: {
+          const auto& altr = node.m_stor.as<index_apply_operator>();
+          size_t nops = 1;
+          if(do_is_binary_xop(altr.xop) || ::rocket::is_any_of(altr.xop, { xop_subscr, xop_assign }))
+            nops = 2;
+          else if(altr.xop == xop_fma)
+            nops = 3;
+          // Some operators yield their first operands, possibly with subscripts appended.
+          uint8_t tainted = (stack.size() >= nops) ? stack[stack.size() - nops] : 0;
+          pop(nops);
+          if(::rocket::is_any_of(altr.xop, { xop_subscr, xop_head, xop_tail }))
+            tainted = tainted ? 2 : 0;
+          else if(!altr.assign && ::rocket::is_none_of(altr.xop, { xop_inc_pre, xop_dec_pre, xop_assign }))
+            tainted = 0;
+          stack.emplace_back(tainted);
+          break;
+        }
+
+      case index_unpack_struct_array:
+        pop(1 + node.m_stor.as<index_unpack_struct_array>().nelems);
+        break;
+
+      case index_unpack_struct_object:
+        pop(1 + node.m_stor.as<index_unpack_struct_object>().keys.size());
+        break;
+
+      case index_defer_expression:
+        if(nested(node.m_stor.as<index_defer_expression>().code_body))
+          return true;
+        break;
+
+      case index_register_expression:
+        // Check the equivalent code, which has the same effect on the stack.
+        if(do_may_escape(stack, node.m_stor.as<index_register_expression>().code_stack, 0, name))
+          return true;
+        break;
+
+      default:
+        // Be conservative about nodes that are unknown here.
+        return true;
+      }
+    }
+    return false;
+  }
+
+void AIR_Node::do_mark_untracked(cow_vector<AIR_Node>& code, const cow_vector<const cow_vector<AIR_Node>*>& scope)
+  {
+    // The scope of a variable consists of nodes after its declaration, as well as sequences in `scope`, such as the
+    // condition, the increment and the body of a `for` statement whose initializer declares the variable.
+    auto escapes = [&](size_t i, const phsh_string& name, bool pushed)
+      {
+        cow_vector<uint8_t> stack;
+        if(pushed) {
+          stack.emplace_back(1);
+        }
+        if(do_may_escape(stack, code, i + 1, name)) {
+          return true;
+        }
+        for(const auto& qseq : scope) {
+          stack.clear();
+          if(do_may_escape(stack, *qseq, 0, name))
+            return true;
+        }
+        return false;
+      };
+
+    for(size_t i = 0;  i < code.size();  ++i) {
+      auto& node = code.mut(i);
+      switch(::rocket::weaken_enum(node.index())) {
+      case index_declare_variable: {
+          auto& altr = node.m_stor.as<index_declare_variable>();
+          // The variable itself is pushed, and is popped when it is initialized.
+          altr.untracked = !escapes(i, altr.name, true);
+          break;
+        }
+
+      case index_define_null_variable: {
+          auto& altr = node.m_stor.as<index_define_null_variable>();
+          altr.untracked = !escapes(i, altr.name, false);
+          break;
+        }
+
+      case index_execute_block:
+        do_mark_untracked(node.m_stor.as<index_execute_block>().code_body, { });
+        break;
+
+      case index_if_statement: {
+          auto& altr = node.m_stor.as<index_if_statement>();
+          do_mark_untracked(altr.code_true, { });
+          do_mark_untracked(altr.code_false, { });
+          break;
+        }
+
+      case index_switch_statement: {
+          auto& altr = node.m_stor.as<index_switch_statement>();
+          // Names that are declared in a clause are visible in all clauses after it.
+          for(size_t k = 0;  k < altr.code_bodies.size();  ++k) {
+            cow_vector<const cow_vector<AIR_Node>*> xscope;
+            for(size_t j = 0;  j < altr.code_bodies.size();  ++j) {
+              xscope.emplace_back(::std::addressof(altr.code_labels[j]));
+              if(j > k)
+                xscope.emplace_back(::std::addressof(altr.code_bodies[j]));
+            }
+            do_mark_untracked(altr.code_bodies.mut(k), xscope);
+          }
+          break;
+        }
+
+      case index_do_while_statement: {
+          auto& altr = node.m_stor.as<index_do_while_statement>();
+          do_mark_untracked(altr.code_body, { ::std::addressof(altr.code_cond) });
+          break;
+        }
+
+      case index_while_statement:
+        do_mark_untracked(node.m_stor.as<index_while_statement>().code_body, { });
+        break;
+
+      case index_for_each_statement:
+        do_mark_untracked(node.m_stor.as<index_for_each_statement>().code_body, { });
+        break;
+
+      case index_for_statement: {
+          auto& altr = node.m_stor.as<index_for_statement>();
+          do_mark_untracked(altr.code_init, { ::std::addressof(altr.code_cond), ::std::addressof(altr.code_step),
+                                              ::std::addressof(altr.code_body) });
+          do_mark_untracked(altr.code_body, { });
+          break;
+        }
+
+      case index_counted_for_statement: {
+          auto& altr = node.m_stor.as<index_counted_for_statement>();
+          do_mark_untracked(altr.code_init, { ::std::addressof(altr.code_cond), ::std::addressof(altr.code_step),
+                                              ::std::addressof(altr.code_body) });
+          do_mark_untracked(altr.code_body, { });
+          break;
+        }
+
+      case index_try_statement: {
+          auto& altr = node.m_stor.as<index_try_statement>();
+          do_mark_untracked(altr.code_try, { });
+          do_mark_untracked(altr.code_catch, { });
+          break;
+        }
+
+      default:
+        break;
+      }
+    }
+  }
+
+cow_vector<AIR_Node>& AIR_Node::optimize(cow_vector<AIR_Node>& code, const Compiler_Options& opts)
+  {
+    do_optimize_nested(code, opts);
+    do_mark_untracked(code, { });
+    return code;
+  }
+
+uint32_t AIR_Node::do_add_capture(cow_vector<Capture>& captures, Capture&& cap)
+  {
+    // Reuse an existing capture if it locates the same reference.
+    for(size_t k = 0;  k < captures.size();  ++k) {
+      const auto& comp = captures[k];
+      if((comp.kind == cap.kind) && (comp.depth == cap.depth) && (comp.index == cap.index) &&
+         ((cap.index != UINT32_MAX) || (comp.name == cap.name)))
+        return static_cast<uint32_t>(k);
+    }
+    if(captures.size() >= UINT32_MAX) {
+      ASTERIA_THROW("too many references captured");
+    }
+    captures.emplace_back(::std::move(cap));
+    return static_cast<uint32_t>(captures.size() - 1);
+  }
+
+bool AIR_Node::do_rebind_operand(Register_Operand& op, cow_vector<Reference>& refs, const Abstract_Context& ctx)
+  {
+    if((op.kind != register_slot) && (op.kind != register_capture)) {
+      return false;
+    }
+    // Get the context.
+    cow_vector<AIR_Node::Capture>* qcaps;
+    uint32_t dcaps;
+    auto qctx = do_locate_context(qcaps, dcaps, ctx, op.depth);
+    // Don't bind references in analytic contexts.
+    if(qctx->is_analytic()) {
+      return false;
+    }
+    if(qcaps) {
+      // Capture it, like `push_local_reference` and `push_captured_reference` nodes.
+      Capture xcap = { op.kind, op.depth - dcaps - 1u, op.index, ::rocket::sref("") };
+      op.kind = register_capture;
+      op.depth = static_cast<uint16_t>(dcaps);
+      op.index = do_add_capture(*qcaps, ::std::move(xcap));
+      return true;
+    }
+    // Bind it now. If the declaration has been bypassed, bind a void reference.
+    auto qexec = static_cast<const Executive_Context*>(qctx);
+    auto qref = (op.kind == register_slot) ? qexec->get_slot_opt(op.index) : qexec->get_capture_opt(op.index);
+    op.kind = register_bound;
+    op.depth = 0;
+    op.index = static_cast<uint32_t>(refs.size());
+    refs.emplace_back(qref ? *qref : Reference(Reference_root::S_void()));
+    return true;
+  }
+
+cow_vector<Reference>& AIR_Node::capture_references(cow_vector<Reference>& refs, const cow_vector<Capture>& captures,
+                                                    const Executive_Context& ctx)
+  {
+    refs.clear();
+    refs.reserve(captures.size());
+    for(const auto& cap : captures) {
+      // Get the context.
+      const Executive_Context* qctx = ::std::addressof(ctx);
+      ::rocket::ranged_for(uint32_t(0), cap.depth, [&](uint32_t) { qctx = qctx->get_parent_opt();  });
+      ROCKET_ASSERT(qctx);
+      // Look for the reference in it.
+      const Reference* qref;
+      if(cap.kind == register_capture)
+        qref = qctx->get_capture_opt(cap.index);
+      else if(cap.index != UINT32_MAX)
+        qref = qctx->get_slot_opt(cap.index);
+      else
+        qref = qctx->get_named_reference_opt(cap.name);
+      // If the declaration has been bypassed, capture a void reference.
+      refs.emplace_back(qref ? *qref : Reference(Reference_root::S_void()));
+    }
+    return refs;
+  }
+
+opt<AIR_Node> AIR_Node::rebind_opt(const Abstract_Context& ctx) const
+  {
+    switch(this->index()) {
+    case index_clear_stack: {
+        // There is nothing to bind.
+        return nullopt;
+      }
+
+    case index_execute_block: {
+        const auto& altr = this->m_stor.as<index_execute_block>();
+        // Check for rebinds recursively.
+        Analytic_Context ctx_body(::rocket::ref(ctx), nullptr);
+        auto pair = ::std::make_pair(false, altr);
+        do_rebind_nodes(pair.first, pair.second.code_body, ctx_body);
+        if(!pair.first) {
           return nullopt;
         }
         return ::std::move(pair.second);
@@ -2710,7 +4794,8 @@ opt<AIR_Node> AIR_Node::rebind_opt(const Abstract_Context& ctx) const
         // Check for rebinds recursively.
         Analytic_Context ctx_body(::rocket::ref(ctx), nullptr);
         auto pair = ::std::make_pair(false, altr);
-        do_rebind_nodes(pair.first, pair.second.code_labels, ctx_body);
+        // Labels are evaluated in the enclosing context, while bodies share a new one.
+        do_rebind_nodes(pair.first, pair.second.code_labels, ctx);
         do_rebind_nodes(pair.first, pair.second.code_bodies, ctx_body);
         if(!pair.first) {
           return nullopt;
@@ -2774,6 +4859,31 @@ opt<AIR_Node> AIR_Node::rebind_opt(const Abstract_Context& ctx) const
         return ::std::move(pair.second);
       }
 
+    case index_counted_for_statement: {
+        const auto& altr = this->m_stor.as<index_counted_for_statement>();
+        // Check for rebinds recursively.
+        Analytic_Context ctx_for(::rocket::ref(ctx), nullptr);
+        Analytic_Context ctx_body(::rocket::ref(ctx_for), nullptr);
+        auto pair = ::std::make_pair(false, altr);
+        do_rebind_nodes(pair.first, pair.second.code_init, ctx_for);
+        do_rebind_nodes(pair.first, pair.second.code_cond, ctx_for);
+        do_rebind_nodes(pair.first, pair.second.code_step, ctx_for);
+        do_rebind_nodes(pair.first, pair.second.code_body, ctx_body);
+        // A bound in an executive context is bound or captured, like `push_local_reference` nodes.
+        cow_vector<Reference> refs;
+        if(do_rebind_operand(pair.second.bound, refs, ctx_for)) {
+          if(pair.second.bound.kind == register_bound) {
+            pair.second.bound.index = 0;
+            pair.second.bound_ref = ::std::move(refs.mut_back());
+          }
+          pair.first = true;
+        }
+        if(!pair.first) {
+          return nullopt;
+        }
+        return ::std::move(pair.second);
+      }
+
     case index_try_statement: {
         const auto& altr = this->m_stor.as<index_try_statement>();
         // Check for rebinds recursively.
@@ -2800,13 +4910,35 @@ opt<AIR_Node> AIR_Node::rebind_opt(const Abstract_Context& ctx) const
     case index_push_local_reference: {
         const auto& altr = this->m_stor.as<index_push_local_reference>();
         // Get the context.
-        const Abstract_Context* qctx = ::std::addressof(ctx);
-        ::rocket::ranged_for(uint32_t(0), altr.depth, [&](uint32_t) { qctx = qctx->get_parent_opt();  });
-        ROCKET_ASSERT(qctx);
+        cow_vector<AIR_Node::Capture>* qcaps;
+        uint32_t dcaps;
+        auto qctx = do_locate_context(qcaps, dcaps, ctx, altr.depth);
         // Don't bind references in analytic contexts.
         if(qctx->is_analytic()) {
           return nullopt;
         }
+        if(qcaps) {
+          // Names are looked up when the function is defined, so they must have been declared.
+          if((altr.slot == UINT32_MAX) && !qctx->get_named_reference_opt(altr.name)) {
+            return nullopt;
+          }
+          // Capture it, relative to the context in which the function is defined.
+          Capture xcap = { register_slot, altr.depth - dcaps - 1, altr.slot, altr.name };
+          S_push_captured_reference xnode = { dcaps, do_add_capture(*qcaps, ::std::move(xcap)) };
+          return ::std::move(xnode);
+        }
+        if(altr.slot != UINT32_MAX) {
+          // Look for the slot in the context. Only executive contexts can be reached here.
+          auto qref = static_cast<const Executive_Context*>(qctx)->get_slot_opt(altr.slot);
+          if(!qref) {
+            // The declaration has been bypassed, so bind a void reference.
+            S_push_bound_reference xnode = { Reference_root::S_void() };
+            return ::std::move(xnode);
+          }
+          // Bind it now.
+          S_push_bound_reference xnode = { *qref };
+          return ::std::move(xnode);
+        }
         // Look for the name in the context.
         auto qref = qctx->get_named_reference_opt(altr.name);
         if(!qref) {
@@ -2822,6 +4954,28 @@ opt<AIR_Node> AIR_Node::rebind_opt(const Abstract_Context& ctx) const
         return nullopt;
       }
 
+    case index_push_captured_reference: {
+        const auto& altr = this->m_stor.as<index_push_captured_reference>();
+        // Get the context of the function that captures it.
+        cow_vector<AIR_Node::Capture>* qcaps;
+        uint32_t dcaps;
+        auto qctx = do_locate_context(qcaps, dcaps, ctx, altr.depth);
+        // Don't bind references in analytic contexts.
+        if(qctx->is_analytic()) {
+          return nullopt;
+        }
+        if(qcaps) {
+          // Capture it again in the inner function.
+          Capture xcap = { register_capture, altr.depth - dcaps - 1, altr.index, ::rocket::sref("") };
+          S_push_captured_reference xnode = { dcaps, do_add_capture(*qcaps, ::std::move(xcap)) };
+          return ::std::move(xnode);
+        }
+        // Bind it now.
+        auto qref = static_cast<const Executive_Context*>(qctx)->get_capture_opt(altr.index);
+        S_push_bound_reference xnode = { qref ? *qref : Reference(Reference_root::S_void()) };
+        return ::std::move(xnode);
+      }
+
     case index_define_function: {
         const auto& altr = this->m_stor.as<index_define_function>();
         // Check for rebinds recursively.
@@ -2882,6 +5036,31 @@ opt<AIR_Node> AIR_Node::rebind_opt(const Abstract_Context& ctx) const
         return ::std::move(pair.second);
       }
 
+    case index_push_std_member: {
+        // There is nothing to bind.
+        return nullopt;
+      }
+
+    case index_register_expression: {
+        const auto& altr = this->m_stor.as<index_register_expression>();
+        // Local references in executive contexts are bound or captured, like `push_local_reference` nodes.
+        auto pair = ::std::make_pair(false, altr);
+        // Don't trigger copy-on-write unless an operand needs rebinding.
+        for(size_t k = 0;  k < altr.steps.size();  ++k) {
+          auto step = altr.steps[k];
+          if(do_rebind_operand(step.lhs, pair.second.refs, ctx) | do_rebind_operand(step.rhs, pair.second.refs, ctx)) {
+            pair.second.steps.mut(k) = step;
+            pair.first = true;
+          }
+        }
+        pair.first |= do_rebind_operand(pair.second.target, pair.second.refs, ctx);
+        do_rebind_nodes(pair.first, pair.second.code_stack, ctx);
+        if(!pair.first) {
+          return nullopt;
+        }
+        return ::std::move(pair.second);
+      }
+
     default:
       ASTERIA_TERMINATE("invalid AIR node type (index `$1`)", this->index());
     }
@@ -2919,13 +5098,16 @@ AVMC_Queue& AIR_Node::solidify(AVMC_Queue& queue, uint8_t ipass) const
 
     case index_declare_variable: {
         const auto& altr = this->m_stor.as<index_declare_variable>();
-        // `pu` is unused.
+        // `pu.x32` is `slot`.
+        // `pu.x16` is `untracked`.
         // `pv` points to the source location and name.
         AVMC_Appender<Pv_sloc_name> avmcp;
         if(ipass == 0) {
           return avmcp.request(queue);
         }
         // Encode arguments.
+        avmcp.pu.x32 = altr.slot;
+        avmcp.pu.x16 = altr.untracked;
         avmcp.sloc = altr.sloc;
         avmcp.name = altr.name;
         // Push a new node.
@@ -2975,7 +5157,27 @@ AVMC_Queue& AIR_Node::solidify(AVMC_Queue& queue, uint8_t ipass) const
           do_solidify_queue(avmcp.queues_labels.emplace_back(), altr.code_labels.at(i));
           do_solidify_queue(avmcp.queues_bodies.emplace_back(), altr.code_bodies.at(i));
         }
-        avmcp.names_added = altr.names_added;
+        // Collect constant labels. Single-step traps are ignored, as hooks are checked at runtime.
+        cow_vector<const Value*> labels;
+        for(const auto& code_label : altr.code_labels) {
+          auto pos = ::std::find_if(code_label.begin(), code_label.end(),
+                       [&](const AIR_Node& node) {
+                         return ::rocket::is_none_of(node.index(), { index_single_step_trap, index_clear_stack });
+                       });
+          if(pos == code_label.end()) {
+            // This is a `default` clause.
+            labels.emplace_back(nullptr);
+          }
+          else if((pos + 1 == code_label.end()) && (pos->index() == index_push_immediate)) {
+            labels.emplace_back(::std::addressof(pos->m_stor.as<index_push_immediate>().val));
+          }
+          else {
+            break;
+          }
+        }
+        if(labels.size() == altr.code_labels.size()) {
+          do_make_switch_table(avmcp, labels);
+        }
         // Push a new node.
         return avmcp.output<do_switch_statement>(queue);
       }
@@ -3021,8 +5223,8 @@ AVMC_Queue& AIR_Node::solidify(AVMC_Queue& queue, uint8_t ipass) const
           return avmcp.request(queue);
         }
         // Encode arguments.
-        avmcp.name_key = altr.name_key;
-        avmcp.name_mapped = altr.name_mapped;
+        avmcp.slot_key = altr.slot_key;
+        avmcp.slot_mapped = altr.slot_mapped;
         do_solidify_queue(avmcp.queue_init, altr.code_init);
         do_solidify_queue(avmcp.queue_body, altr.code_body);
         // Push a new node.
@@ -3046,6 +5248,31 @@ AVMC_Queue& AIR_Node::solidify(AVMC_Queue& queue, uint8_t ipass) const
         return avmcp.output<do_for_statement>(queue);
       }
 
+    case index_counted_for_statement: {
+        const auto& altr = this->m_stor.as<index_counted_for_statement>();
+        // `pu` is unused.
+        // `pv` points to the triplet, the body and the decoded loop.
+        AVMC_Appender<Pv_counted_for> avmcp;
+        if(ipass == 0) {
+          return avmcp.request(queue);
+        }
+        // Encode arguments.
+        do_solidify_queue(avmcp.queue_init, altr.code_init);
+        do_solidify_queue(avmcp.queue_cond, altr.code_cond);
+        do_solidify_queue(avmcp.queue_step, altr.code_step);
+        do_solidify_queue(avmcp.queue_body, altr.code_body);
+        avmcp.slot = altr.slot;
+        avmcp.materialize = altr.materialize;
+        avmcp.xop_cond = altr.xop_cond;
+        avmcp.bound = altr.bound;
+        avmcp.bound_const = altr.bound_const;
+        avmcp.bound_ref = altr.bound_ref;
+        avmcp.xop_step = altr.xop_step;
+        avmcp.step = altr.step;
+        // Push a new node.
+        return avmcp.output<do_counted_for_statement>(queue);
+      }
+
     case index_try_statement: {
         const auto& altr = this->m_stor.as<index_try_statement>();
         // `pu` is unused.
@@ -3057,7 +5284,7 @@ AVMC_Queue& AIR_Node::solidify(AVMC_Queue& queue, uint8_t ipass) const
         // Encode arguments.
         do_solidify_queue(avmcp.queue_try, altr.code_try);
         avmcp.sloc = altr.sloc;
-        avmcp.name_except = altr.name_except;
+        avmcp.slot_except = altr.slot_except;
         do_solidify_queue(avmcp.queue_catch, altr.code_catch);
         // Push a new node.
         return avmcp.output<do_try_statement>(queue);
@@ -3137,8 +5364,8 @@ AVMC_Queue& AIR_Node::solidify(AVMC_Queue& queue, uint8_t ipass) const
     case index_push_global_reference: {
         const auto& altr = this->m_stor.as<index_push_global_reference>();
         // `pu` is unused.
-        // `pv` points to the name.
-        AVMC_Appender<Pv_name> avmcp;
+        // `pv` points to the name and the inline cache.
+        AVMC_Appender<Pv_name_cached> avmcp;
         if(ipass == 0) {
           return avmcp.request(queue);
         }
@@ -3150,6 +5377,23 @@ AVMC_Queue& AIR_Node::solidify(AVMC_Queue& queue, uint8_t ipass) const
 
     case index_push_local_reference: {
         const auto& altr = this->m_stor.as<index_push_local_reference>();
+        if(altr.slot != UINT32_MAX) {
+          // `pu.x32` is `slot`.
+          // `pu.x16` is `depth`.
+          // `pv` is unused.
+          AVMC_Appender<void> avmcp;
+          if(ipass == 0) {
+            return avmcp.request(queue);
+          }
+          // Encode arguments.
+          if(altr.depth > UINT16_MAX) {
+            ASTERIA_THROW("scopes nested too deeply (name `$1`, depth `$2`)", altr.name, altr.depth);
+          }
+          avmcp.pu.x32 = altr.slot;
+          avmcp.pu.x16 = static_cast<uint16_t>(altr.depth);
+          // Push a new node.
+          return avmcp.output<do_push_local_slot>(queue);
+        }
         // `pu.x32` is `depth`.
         // `pv` points to the name.
         AVMC_Appender<Pv_name> avmcp;
@@ -3177,6 +5421,20 @@ AVMC_Queue& AIR_Node::solidify(AVMC_Queue& queue, uint8_t ipass) const
         return avmcp.output<do_push_bound_reference>(queue);
       }
 
+    case index_push_captured_reference: {
+        const auto& altr = this->m_stor.as<index_push_captured_reference>();
+        // `pu.x32` is `index`.
+        // `pv` is unused.
+        AVMC_Appender<void> avmcp;
+        if(ipass == 0) {
+          return avmcp.request(queue);
+        }
+        // Encode arguments.
+        avmcp.pu.x32 = altr.index;
+        // Push a new node.
+        return avmcp.output<do_push_captured_reference>(queue);
+      }
+
     case index_define_function: {
         const auto& altr = this->m_stor.as<index_define_function>();
         // `pu` is unused.
@@ -3286,54 +5544,14 @@ AVMC_Queue& AIR_Node::solidify(AVMC_Queue& queue, uint8_t ipass) const
     case index_apply_operator: {
         const auto& altr = this->m_stor.as<index_apply_operator>();
         // `pu.u8s[0]` is `assign`. Other fields may be used depending on the operator.
-        // `pv` is unused.
-        AVMC_Appender<void> avmcp;
+        // `pv` points to the type feedback, which is used by arithmetic and comparison operators.
+        AVMC_Appender<Pv_type_feedback> avmcp;
         if(ipass == 0) {
           return avmcp.request(queue);
         }
         // Encode arguments.
-        switch(::rocket::weaken_enum(altr.xop)) {
-        case xop_cmp_eq: {
-            avmcp.pu.u8s[0] = altr.assign;
-            avmcp.pu.u8s[1] = compare_equal;
-            avmcp.pu.u8s[2] = false;
-            break;
-          }
-        case xop_cmp_ne: {
-            avmcp.pu.u8s[0] = altr.assign;
-            avmcp.pu.u8s[1] = compare_equal;
-            avmcp.pu.u8s[2] = true;
-            break;
-          }
-        case xop_cmp_lt: {
-            avmcp.pu.u8s[0] = altr.assign;
-            avmcp.pu.u8s[1] = compare_less;
-            avmcp.pu.u8s[2] = false;
-            break;
-          }
-        case xop_cmp_gt: {
-            avmcp.pu.u8s[0] = altr.assign;
-            avmcp.pu.u8s[1] = compare_greater;
-            avmcp.pu.u8s[2] = false;
-            break;
-          }
-        case xop_cmp_lte: {
-            avmcp.pu.u8s[0] = altr.assign;
-            avmcp.pu.u8s[1] = compare_greater;
-            avmcp.pu.u8s[2] = true;
-            break;
-          }
-        case xop_cmp_gte: {
-            avmcp.pu.u8s[0] = altr.assign;
-            avmcp.pu.u8s[1] = compare_less;
-            avmcp.pu.u8s[2] = true;
-            break;
-          }
-        default: {
-            avmcp.pu.u8s[0] = altr.assign;
-            break;
-          }
-        }
+        avmcp.pu = do_encode_xop(altr.xop, altr.assign);
+        avmcp.state = feedback_none;
         // Push a new node.
         switch(altr.xop) {
         case xop_inc_post: {
@@ -3412,40 +5630,40 @@ AVMC_Queue& AIR_Node::solidify(AVMC_Queue& queue, uint8_t ipass) const
             return avmcp.output<do_apply_xop_ITRUNC>(queue);
           }
         case xop_cmp_eq: {
-            return avmcp.output<do_apply_xop_CMP_XEQ>(queue);
+            return avmcp.output<do_apply_xop_CMP_XEQ_typed>(queue);
           }
         case xop_cmp_ne: {
-            return avmcp.output<do_apply_xop_CMP_XEQ>(queue);
+            return avmcp.output<do_apply_xop_CMP_XEQ_typed>(queue);
           }
         case xop_cmp_lt: {
-            return avmcp.output<do_apply_xop_CMP_XREL>(queue);
+            return avmcp.output<do_apply_xop_CMP_XREL_typed>(queue);
           }
         case xop_cmp_gt: {
-            return avmcp.output<do_apply_xop_CMP_XREL>(queue);
+            return avmcp.output<do_apply_xop_CMP_XREL_typed>(queue);
           }
         case xop_cmp_lte: {
-            return avmcp.output<do_apply_xop_CMP_XREL>(queue);
+            return avmcp.output<do_apply_xop_CMP_XREL_typed>(queue);
           }
         case xop_cmp_gte: {
-            return avmcp.output<do_apply_xop_CMP_XREL>(queue);
+            return avmcp.output<do_apply_xop_CMP_XREL_typed>(queue);
           }
         case xop_cmp_3way: {
             return avmcp.output<do_apply_xop_CMP_3WAY>(queue);
           }
         case xop_add: {
-            return avmcp.output<do_apply_xop_ADD>(queue);
+            return avmcp.output<do_apply_xop_ADD_typed>(queue);
           }
         case xop_sub: {
-            return avmcp.output<do_apply_xop_SUB>(queue);
+            return avmcp.output<do_apply_xop_SUB_typed>(queue);
           }
         case xop_mul: {
-            return avmcp.output<do_apply_xop_MUL>(queue);
+            return avmcp.output<do_apply_xop_MUL_typed>(queue);
           }
         case xop_div: {
-            return avmcp.output<do_apply_xop_DIV>(queue);
+            return avmcp.output<do_apply_xop_DIV_typed>(queue);
           }
         case xop_mod: {
-            return avmcp.output<do_apply_xop_MOD>(queue);
+            return avmcp.output<do_apply_xop_MOD_typed>(queue);
           }
         case xop_sll: {
             return avmcp.output<do_apply_xop_SLL>(queue);
@@ -3518,14 +5736,18 @@ AVMC_Queue& AIR_Node::solidify(AVMC_Queue& queue, uint8_t ipass) const
 
     case index_define_null_variable: {
         const auto& altr = this->m_stor.as<index_define_null_variable>();
-        // `pu.u8s[0]` is `immutable`.
+        // `pu.y32` is `slot`.
+        // `pu.u8s[4]` is `immutable`.
+        // `pu.u8s[5]` is `untracked`.
         // `pv` points to the source location and name.
         AVMC_Appender<Pv_sloc_name> avmcp;
         if(ipass == 0) {
           return avmcp.request(queue);
         }
         // Encode arguments.
-        avmcp.pu.u8s[0] = altr.immutable;
+        avmcp.pu.y32 = altr.slot;
+        avmcp.pu.u8s[4] = altr.immutable;
+        avmcp.pu.u8s[5] = altr.untracked;
         avmcp.sloc = altr.sloc;
         avmcp.name = altr.name;
         // Push a new node.
@@ -3564,7 +5786,8 @@ AVMC_Queue& AIR_Node::solidify(AVMC_Queue& queue, uint8_t ipass) const
     case index_defer_expression: {
         const auto& altr = this->m_stor.as<index_defer_expression>();
         // `pu` is unused.
-        // `pv` points to the source location and body.
+        // `pv` points to the source location, the body and its solidified form.
+        // The body is kept in case the expression has to be bound for a proper tail call.
         AVMC_Appender<Pv_defer> avmcp;
         if(ipass == 0) {
           return avmcp.request(queue);
@@ -3572,15 +5795,299 @@ AVMC_Queue& AIR_Node::solidify(AVMC_Queue& queue, uint8_t ipass) const
         // Encode arguments.
         avmcp.sloc = altr.sloc;
         avmcp.code_body = altr.code_body;
+        do_solidify_queue(avmcp.queue_body, altr.code_body);
         // Push a new node.
         return avmcp.output<do_defer_expression>(queue);
       }
 
+    case index_push_std_member: {
+        const auto& altr = this->m_stor.as<index_push_std_member>();
+        // `pu` is unused.
+        // `pv` points to the names and the cached value.
+        AVMC_Appender<Pv_std_member> avmcp;
+        if(ipass == 0) {
+          return avmcp.request(queue);
+        }
+        // Encode arguments.
+        avmcp.module = altr.module;
+        avmcp.member = altr.member;
+        // Push a new node.
+        return avmcp.output<do_push_std_member>(queue);
+      }
+
+    case index_register_expression: {
+        const auto& altr = this->m_stor.as<index_register_expression>();
+        // `pu` is unused.
+        // `pv` points to the steps, operands and the solidified form of stack-based code.
+        AVMC_Appender<Pv_register_expression> avmcp;
+        if(ipass == 0) {
+          return avmcp.request(queue);
+        }
+        // Encode arguments.
+        avmcp.steps = altr.steps;
+        avmcp.consts = altr.consts;
+        avmcp.refs = altr.refs;
+        avmcp.target = altr.target;
+        do_solidify_queue(avmcp.queue_stack, altr.code_stack);
+        // Push a new node.
+        return avmcp.output<do_register_expression>(queue);
+      }
+
     default:
       ASTERIA_TERMINATE("invalid AIR node type (index `$1`)", this->index());
     }
   }
 
+bool AIR_Node::do_solidify_fused(AVMC_Queue& queue, uint8_t ipass, const AIR_Node& head, const AIR_Node& tail)
+  {
+    switch(::rocket::weaken_enum(head.index())) {
+    case index_push_local_reference: {
+        const auto& altr = head.m_stor.as<index_push_local_reference>();
+        if((altr.slot == UINT32_MAX) || (altr.depth > UINT16_MAX)) {
+          return false;
+        }
+        switch(::rocket::weaken_enum(tail.index())) {
+        case index_member_access: {
+            const auto& altr2 = tail.m_stor.as<index_member_access>();
+            // `pu.x32` is `slot`.
+            // `pu.x16` is `depth`.
+            // `pv` points to the name.
+            AVMC_Appender<Pv_name> avmcp;
+            if(ipass == 0) {
+              return avmcp.request(queue), true;
+            }
+            // Encode arguments.
+            avmcp.pu.x32 = altr.slot;
+            avmcp.pu.x16 = static_cast<uint16_t>(altr.depth);
+            avmcp.name = altr2.name;
+            // Push a new node.
+            return avmcp.output<do_fused_u_v<do_push_local_slot, do_member_access>>(queue), true;
+          }
+
+        case index_glvalue_to_rvalue: {
+            // `pu.x32` is `slot`.
+            // `pu.x16` is `depth`.
+            // `pv` is unused.
+            AVMC_Appender<void> avmcp;
+            if(ipass == 0) {
+              return avmcp.request(queue), true;
+            }
+            // Encode arguments.
+            avmcp.pu.x32 = altr.slot;
+            avmcp.pu.x16 = static_cast<uint16_t>(altr.depth);
+            // Push a new node.
+            return avmcp.output<do_fused_u_v<do_push_local_slot, do_glvalue_to_rvalue>>(queue), true;
+          }
+
+        case index_apply_operator: {
+            const auto& altr2 = tail.m_stor.as<index_apply_operator>();
+            // Only increment and decrement operators are fused.
+            switch(::rocket::weaken_enum(altr2.xop)) {
+            case xop_inc_post:
+            case xop_dec_post:
+            case xop_inc_pre:
+            case xop_dec_pre:
+              break;
+            default:
+              return false;
+            }
+            // `pu.x32` is `slot`.
+            // `pu.x16` is `depth`.
+            // `pv` is unused.
+            AVMC_Appender<void> avmcp;
+            if(ipass == 0) {
+              return avmcp.request(queue), true;
+            }
+            // Encode arguments.
+            avmcp.pu.x32 = altr.slot;
+            avmcp.pu.x16 = static_cast<uint16_t>(altr.depth);
+            // Push a new node.
+            switch(::rocket::weaken_enum(altr2.xop)) {
+            case xop_inc_post:
+              return avmcp.output<do_fused_u_v<do_push_local_slot, do_apply_xop_INC_POST>>(queue), true;
+            case xop_dec_post:
+              return avmcp.output<do_fused_u_v<do_push_local_slot, do_apply_xop_DEC_POST>>(queue), true;
+            case xop_inc_pre:
+              return avmcp.output<do_fused_u_v<do_push_local_slot, do_apply_xop_INC_PRE>>(queue), true;
+            default:
+              return avmcp.output<do_fused_u_v<do_push_local_slot, do_apply_xop_DEC_PRE>>(queue), true;
+            }
+          }
+
+        default:
+          return false;
+        }
+      }
+
+    case index_member_access: {
+        const auto& altr = head.m_stor.as<index_member_access>();
+        if(tail.index() != index_glvalue_to_rvalue) {
+          return false;
+        }
+        // `pu` is unused.
+        // `pv` points to the name.
+        AVMC_Appender<Pv_name> avmcp;
+        if(ipass == 0) {
+          return avmcp.request(queue), true;
+        }
+        // Encode arguments.
+        avmcp.name = altr.name;
+        // Push a new node.
+        return avmcp.output<do_fused_v_u<do_member_access, do_glvalue_to_rvalue>>(queue), true;
+      }
+
+    case index_push_immediate: {
+        const auto& altr = head.m_stor.as<index_push_immediate>();
+        if(tail.index() != index_apply_operator) {
+          return false;
+        }
+        const auto& altr2 = tail.m_stor.as<index_apply_operator>();
+        // Only common binary operators are fused.
+        if(!do_is_fusable_xop(altr2.xop)) {
+          return false;
+        }
+        // `pu` is the same as that of the operator.
+        // `pv` points to a copy of `val`.
+        AVMC_Appender<Value> avmcp;
+        if(ipass == 0) {
+          return avmcp.request(queue), true;
+        }
+        // Encode arguments.
+        avmcp.pu = do_encode_xop(altr2.xop, altr2.assign);
+        static_cast<Value&>(avmcp) = altr.val;
+        // Push a new node.
+        switch(::rocket::weaken_enum(altr2.xop)) {
+        case xop_cmp_eq:
+        case xop_cmp_ne:
+          return avmcp.output<do_fused_v_u<do_push_immediate, do_apply_xop_CMP_XEQ_typed>>(queue), true;
+        case xop_cmp_lt:
+        case xop_cmp_gt:
+        case xop_cmp_lte:
+        case xop_cmp_gte:
+          return avmcp.output<do_fused_v_u<do_push_immediate, do_apply_xop_CMP_XREL_typed>>(queue), true;
+        case xop_add:
+          return avmcp.output<do_fused_v_u<do_push_immediate, do_apply_xop_ADD_typed>>(queue), true;
+        case xop_sub:
+          return avmcp.output<do_fused_v_u<do_push_immediate, do_apply_xop_SUB_typed>>(queue), true;
+        case xop_mul:
+          return avmcp.output<do_fused_v_u<do_push_immediate, do_apply_xop_MUL_typed>>(queue), true;
+        case xop_div:
+          return avmcp.output<do_fused_v_u<do_push_immediate, do_apply_xop_DIV_typed>>(queue), true;
+        case xop_mod:
+          return avmcp.output<do_fused_v_u<do_push_immediate, do_apply_xop_MOD_typed>>(queue), true;
+        case xop_andb:
+          return avmcp.output<do_fused_v_u<do_push_immediate, do_apply_xop_ANDB>>(queue), true;
+        case xop_orb:
+          return avmcp.output<do_fused_v_u<do_push_immediate, do_apply_xop_ORB>>(queue), true;
+        case xop_xorb:
+          return avmcp.output<do_fused_v_u<do_push_immediate, do_apply_xop_XORB>>(queue), true;
+        default:
+          return avmcp.output<do_fused_v_u<do_push_immediate, do_apply_xop_ASSIGN>>(queue), true;
+        }
+      }
+
+    case index_apply_operator: {
+        const auto& altr = head.m_stor.as<index_apply_operator>();
+        if(tail.index() != index_if_statement) {
+          return false;
+        }
+        const auto& altr2 = tail.m_stor.as<index_if_statement>();
+        // Only comparison operators are fused.
+        switch(::rocket::weaken_enum(altr.xop)) {
+        case xop_cmp_eq:
+        case xop_cmp_ne:
+        case xop_cmp_lt:
+        case xop_cmp_gt:
+        case xop_cmp_lte:
+        case xop_cmp_gte:
+          break;
+        default:
+          return false;
+        }
+        // `pu.u8s[0]`, `pu.u8s[1]` and `pu.u8s[2]` are the same as those of the operator.
+        // `pu.u8s[3]` is `negative`.
+        // `pv` points to the two branches.
+        AVMC_Appender<Pv_queues_fixed<2>> avmcp;
+        if(ipass == 0) {
+          return avmcp.request(queue), true;
+        }
+        // Encode arguments.
+        avmcp.pu = do_encode_xop(altr.xop, altr.assign);
+        avmcp.pu.u8s[3] = altr2.negative;
+        do_solidify_queue(avmcp.queues[0], altr2.code_true);
+        do_solidify_queue(avmcp.queues[1], altr2.code_false);
+        // Push a new node.
+        if((altr.xop == xop_cmp_eq) || (altr.xop == xop_cmp_ne)) {
+          return avmcp.output<do_compare_and_branch<do_apply_xop_CMP_XEQ_typed>>(queue), true;
+        }
+        return avmcp.output<do_compare_and_branch<do_apply_xop_CMP_XREL_typed>>(queue), true;
+      }
+
+    default:
+      return false;
+    }
+  }
+
+AVMC_Queue& AIR_Node::solidify_all(AVMC_Queue& queue, const cow_vector<AIR_Node>& code)
+  {
+    bool count_pairs = s_pair_counter_mode.load(::std::memory_order_relaxed);
+    for(uint8_t ipass = 0;  ipass != 2;  ++ipass) {
+      size_t k = 0;
+      while(k != code.size()) {
+        if(count_pairs) {
+          // Record the pair of this node and the previous one, if any.
+          if(k != 0) {
+            AVMC_Appender<void> avmcp;
+            if(ipass == 0) {
+              avmcp.request(queue);
+            }
+            else {
+              avmcp.pu.u8s[0] = code[k-1].index();
+              avmcp.pu.u8s[1] = code[k].index();
+              avmcp.output<do_count_pair>(queue);
+            }
+          }
+        }
+        else if((k + 1 != code.size()) && do_solidify_fused(queue, ipass, code[k], code[k+1])) {
+          // Two nodes have been consumed.
+          k += 2;
+          continue;
+        }
+        code[k].solidify(queue, ipass);
+        k += 1;
+      }
+    }
+    return queue;
+  }
+
+void AIR_Node::set_pair_counter_mode(bool enabled) noexcept
+  {
+    s_pair_counter_mode.store(enabled, ::std::memory_order_relaxed);
+  }
+
+tinyfmt& AIR_Node::print_pair_counts(tinyfmt& fmt, size_t limit)
+  {
+    // Collect all pairs that have been executed at least once.
+    cow_vector<pair<uint64_t, size_t>> pairs;
+    for(size_t i = 0;  i < nindices * nindices;  ++i) {
+      auto count = s_pair_counts[i / nindices][i % nindices].load(::std::memory_order_relaxed);
+      if(count != 0)
+        pairs.emplace_back(count, i);
+    }
+    // Sort them by their counts, in descending order.
+    ::std::sort(pairs.mut_begin(), pairs.mut_end(),
+                [&](const pair<uint64_t, size_t>& x, const pair<uint64_t, size_t>& y) { return x.first > y.first;  });
+    if(pairs.size() > limit) {
+      pairs.erase(limit);
+    }
+    // Print them, one pair per line.
+    for(const auto& p : pairs) {
+      fmt << p.first << '\t' << do_describe_index(p.second / nindices)
+          << " + " << do_describe_index(p.second % nindices) << '\n';
+    }
+    return fmt;
+  }
+
 Variable_Callback& AIR_Node::enumerate_variables(Variable_Callback& callback) const
   {
     switch(this->index()) {
@@ -3645,6 +6152,16 @@ Variable_Callback& AIR_Node::enumerate_variables(Variable_Callback& callback) co
         return callback;
       }
 
+    case index_counted_for_statement: {
+        const auto& altr = this->m_stor.as<index_counted_for_statement>();
+        ::rocket::for_each(altr.code_init, callback);
+        ::rocket::for_each(altr.code_cond, callback);
+        ::rocket::for_each(altr.code_step, callback);
+        ::rocket::for_each(altr.code_body, callback);
+        callback(altr.bound_ref);
+        return callback;
+      }
+
     case index_try_statement: {
         const auto& altr = this->m_stor.as<index_try_statement>();
         ::rocket::for_each(altr.code_try, callback);
@@ -3666,7 +6183,8 @@ Variable_Callback& AIR_Node::enumerate_variables(Variable_Callback& callback) co
       }
 
     case index_push_global_reference:
-    case index_push_local_reference: {
+    case index_push_local_reference:
+    case index_push_captured_reference: {
         return callback;
       }
 
@@ -3714,6 +6232,18 @@ Variable_Callback& AIR_Node::enumerate_variables(Variable_Callback& callback) co
         return callback;
       }
 
+    case index_push_std_member: {
+        return callback;
+      }
+
+    case index_register_expression: {
+        const auto& altr = this->m_stor.as<index_register_expression>();
+        ::rocket::for_each(altr.consts, callback);
+        ::rocket::for_each(altr.refs, callback);
+        ::rocket::for_each(altr.code_stack, callback);
+        return callback;
+      }
+
     default:
       ASTERIA_TERMINATE("invalid AIR node type (index `$1`)", this->index());
     }
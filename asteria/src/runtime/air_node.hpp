@@ -14,6 +14,40 @@ namespace Asteria {
 class AIR_Node
   {
   public:
+    // These describe register-based expressions. Each step applies a binary operator and stores its result
+    // in the temporary register whose index is that of the step. The result of the last step is the result
+    // of the whole expression.
+    enum Register_Kind : uint8_t
+      {
+        register_none     = 0,  // no operand
+        register_temp     = 1,  // result of a previous step
+        register_const    = 2,  // constant value
+        register_slot     = 3,  // local variable in a frame slot
+        register_bound    = 4,  // bound reference
+        register_capture  = 5,  // reference captured by the enclosing function
+      };
+    struct Register_Operand
+      {
+        Register_Kind kind;
+        uint16_t depth;  // for `register_slot` and `register_capture` only
+        uint32_t index;  // index of a step, constant, slot, bound reference or captured reference
+      };
+    struct Register_Step
+      {
+        Xop xop;
+        Register_Operand lhs;
+        Register_Operand rhs;
+      };
+
+    // This describes a reference that a function captures when it is defined.
+    struct Capture
+      {
+        Register_Kind kind;  // `register_slot` or `register_capture`
+        uint32_t depth;  // of the context where the reference is located, from the defining context
+        uint32_t index;  // slot or captured reference; for slots, `UINT32_MAX` if the name is to be looked up
+        phsh_string name;  // for slots that are looked up by name only
+      };
+
     struct S_clear_stack
       {
       };
@@ -25,6 +59,8 @@ class AIR_Node
       {
         Source_Location sloc;
         phsh_string name;
+        uint32_t slot;
+        bool untracked;  // set by escape analysis if no other variable may reference this one
       };
     struct S_initialize_variable
       {
@@ -40,7 +76,6 @@ class AIR_Node
       {
         cow_vector<cow_vector<AIR_Node>> code_labels;
         cow_vector<cow_vector<AIR_Node>> code_bodies;
-        cow_vector<cow_vector<phsh_string>> names_added;
       };
     struct S_do_while_statement
       {
@@ -57,7 +92,9 @@ class AIR_Node
     struct S_for_each_statement
       {
         phsh_string name_key;
+        uint32_t slot_key;
         phsh_string name_mapped;
+        uint32_t slot_mapped;
         cow_vector<AIR_Node> code_init;
         cow_vector<AIR_Node> code_body;
       };
@@ -73,6 +110,7 @@ class AIR_Node
         cow_vector<AIR_Node> code_try;
         Source_Location sloc;
         phsh_string name_except;
+        uint32_t slot_except;
         cow_vector<AIR_Node> code_catch;
       };
     struct S_throw_statement
@@ -104,6 +142,7 @@ class AIR_Node
       {
         uint32_t depth;
         phsh_string name;
+        uint32_t slot;  // `UINT32_MAX` if the name is to be looked up dynamically
       };
     struct S_push_bound_reference
       {
@@ -165,6 +204,8 @@ class AIR_Node
         bool immutable;
         Source_Location sloc;
         phsh_string name;
+        uint32_t slot;
+        bool untracked;  // set by escape analysis if no other variable may reference this one
       };
     struct S_single_step_trap
       {
@@ -180,78 +221,119 @@ class AIR_Node
         Source_Location sloc;
         cow_vector<AIR_Node> code_body;
       };
+    struct S_push_std_member
+      {
+        phsh_string module;
+        phsh_string member;
+      };
+    struct S_register_expression
+      {
+        cow_vector<Register_Step> steps;
+        cow_vector<Value> consts;
+        cow_vector<Reference> refs;
+        Register_Operand target;  // if not `register_none`, the result is assigned to this
+        cow_vector<AIR_Node> code_stack;  // equivalent stack-based code
+      };
+    struct S_push_captured_reference
+      {
+        uint32_t depth;  // of the context of the function that captures it
+        uint32_t index;
+      };
+    struct S_counted_for_statement
+      {
+        cow_vector<AIR_Node> code_init;
+        cow_vector<AIR_Node> code_cond;  // equivalent code of the condition
+        cow_vector<AIR_Node> code_step;  // equivalent code of the increment
+        cow_vector<AIR_Node> code_body;
+        uint32_t slot;  // of the loop variable in the context of the `for` statement
+        bool materialize;  // whether the loop variable may be referenced other than by the triplet
+        Xop xop_cond;  // one of `xop_cmp_lt`, `xop_cmp_gt`, `xop_cmp_lte` and `xop_cmp_gte`
+        Register_Operand bound;  // `register_const`, `register_slot`, `register_bound` or `register_capture`
+        int64_t bound_const;  // for `register_const` only
+        Reference bound_ref = Reference_root::S_void();  // for `register_bound` only
+        Xop xop_step;  // either `xop_add` or `xop_sub`
+        int64_t step;
+      };
 
     enum Index : uint8_t
       {
-        index_clear_stack            =  0,
-        index_execute_block          =  1,
-        index_declare_variable       =  2,
-        index_initialize_variable    =  3,
-        index_if_statement           =  4,
-        index_switch_statement       =  5,
-        index_do_while_statement     =  6,
-        index_while_statement        =  7,
-        index_for_each_statement     =  8,
-        index_for_statement          =  9,
-        index_try_statement          = 10,
-        index_throw_statement        = 11,
-        index_assert_statement       = 12,
-        index_simple_status          = 13,
-        index_glvalue_to_rvalue      = 14,
-        index_push_immediate         = 15,
-        index_push_global_reference  = 16,
-        index_push_local_reference   = 17,
-        index_push_bound_reference   = 18,
-        index_define_function        = 19,
-        index_branch_expression      = 20,
-        index_coalescence            = 21,
-        index_function_call          = 22,
-        index_member_access          = 23,
-        index_push_unnamed_array     = 24,
-        index_push_unnamed_object    = 25,
-        index_apply_operator         = 26,
-        index_unpack_struct_array    = 27,
-        index_unpack_struct_object   = 28,
-        index_define_null_variable   = 29,
-        index_single_step_trap       = 30,
-        index_variadic_call          = 31,
-        index_defer_expression       = 32,
+        index_clear_stack              =  0,
+        index_execute_block            =  1,
+        index_declare_variable         =  2,
+        index_initialize_variable      =  3,
+        index_if_statement             =  4,
+        index_switch_statement         =  5,
+        index_do_while_statement       =  6,
+        index_while_statement          =  7,
+        index_for_each_statement       =  8,
+        index_for_statement            =  9,
+        index_try_statement            = 10,
+        index_throw_statement          = 11,
+        index_assert_statement         = 12,
+        index_simple_status            = 13,
+        index_glvalue_to_rvalue        = 14,
+        index_push_immediate           = 15,
+        index_push_global_reference    = 16,
+        index_push_local_reference     = 17,
+        index_push_bound_reference     = 18,
+        index_define_function          = 19,
+        index_branch_expression        = 20,
+        index_coalescence              = 21,
+        index_function_call            = 22,
+        index_member_access            = 23,
+        index_push_unnamed_array       = 24,
+        index_push_unnamed_object      = 25,
+        index_apply_operator           = 26,
+        index_unpack_struct_array      = 27,
+        index_unpack_struct_object     = 28,
+        index_define_null_variable     = 29,
+        index_single_step_trap         = 30,
+        index_variadic_call            = 31,
+        index_defer_expression         = 32,
+        index_push_std_member          = 33,
+        index_register_expression      = 34,
+        index_counted_for_statement    = 35,
+        index_push_captured_reference  = 36,
       };
     using Xvariant = variant<
       ROCKET_CDR(
-      , S_clear_stack            //  0,
-      , S_execute_block          //  1,
-      , S_declare_variable       //  2,
-      , S_initialize_variable    //  3,
-      , S_if_statement           //  4,
-      , S_switch_statement       //  5,
-      , S_do_while_statement     //  6,
-      , S_while_statement        //  7,
-      , S_for_each_statement     //  8,
-      , S_for_statement          //  9,
-      , S_try_statement          // 10,
-      , S_throw_statement        // 11,
-      , S_assert_statement       // 12,
-      , S_simple_status          // 13,
-      , S_glvalue_to_rvalue      // 14,
-      , S_push_immediate         // 15,
-      , S_push_global_reference  // 16,
-      , S_push_local_reference   // 17,
-      , S_push_bound_reference   // 18,
-      , S_define_function        // 19,
-      , S_branch_expression      // 20,
-      , S_coalescence            // 21,
-      , S_function_call          // 22,
-      , S_member_access          // 23,
-      , S_push_unnamed_array     // 24,
-      , S_push_unnamed_object    // 25,
-      , S_apply_operator         // 26,
-      , S_unpack_struct_array    // 27,
-      , S_unpack_struct_object   // 28,
-      , S_define_null_variable   // 29,
-      , S_single_step_trap       // 30,
-      , S_variadic_call          // 31,
-      , S_defer_expression       // 32,
+      , S_clear_stack              //  0,
+      , S_execute_block            //  1,
+      , S_declare_variable         //  2,
+      , S_initialize_variable      //  3,
+      , S_if_statement             //  4,
+      , S_switch_statement         //  5,
+      , S_do_while_statement       //  6,
+      , S_while_statement          //  7,
+      , S_for_each_statement       //  8,
+      , S_for_statement            //  9,
+      , S_try_statement            // 10,
+      , S_throw_statement          // 11,
+      , S_assert_statement         // 12,
+      , S_simple_status            // 13,
+      , S_glvalue_to_rvalue        // 14,
+      , S_push_immediate           // 15,
+      , S_push_global_reference    // 16,
+      , S_push_local_reference     // 17,
+      , S_push_bound_reference     // 18,
+      , S_define_function          // 19,
+      , S_branch_expression        // 20,
+      , S_coalescence              // 21,
+      , S_function_call            // 22,
+      , S_member_access            // 23,
+      , S_push_unnamed_array       // 24,
+      , S_push_unnamed_object      // 25,
+      , S_apply_operator           // 26,
+      , S_unpack_struct_array      // 27,
+      , S_unpack_struct_object     // 28,
+      , S_define_null_variable     // 29,
+      , S_single_step_trap         // 30,
+      , S_variadic_call            // 31,
+      , S_defer_expression         // 32,
+      , S_push_std_member          // 33,
+      , S_register_expression      // 34,
+      , S_counted_for_statement    // 35,
+      , S_push_captured_reference  // 36,
       )>;
     static_assert(::std::is_nothrow_copy_assignable<Xvariant>::value, "");
 
@@ -282,10 +364,43 @@ class AIR_Node
         return *this;
       }
 
+  private:
+    static cow_vector<AIR_Node>& do_append_optimized(cow_vector<AIR_Node>& code, AIR_Node&& node,
+                                                     const Compiler_Options& opts);
+    static bool do_lower_to_registers(cow_vector<AIR_Node>& code, const S_apply_operator& altr);
+    static bool do_refers_to_local(const cow_vector<AIR_Node>& code, const phsh_string& name);
+    static bool do_specialize_counted_for(cow_vector<AIR_Node>& code, const S_for_statement& altr);
+    static cow_vector<AIR_Node>& do_optimize_nested(cow_vector<AIR_Node>& code, const Compiler_Options& opts);
+    static bool do_may_escape(cow_vector<uint8_t>& stack, const cow_vector<AIR_Node>& code, size_t start,
+                              const phsh_string& name);
+    static void do_mark_untracked(cow_vector<AIR_Node>& code, const cow_vector<const cow_vector<AIR_Node>*>& scope);
+    static uint32_t do_add_capture(cow_vector<Capture>& captures, Capture&& cap);
+    static bool do_rebind_operand(Register_Operand& op, cow_vector<Reference>& refs, const Abstract_Context& ctx);
+    static bool do_solidify_fused(AVMC_Queue& queue, uint8_t ipass, const AIR_Node& head, const AIR_Node& tail);
+
+  public:
+    // Optimize a sequence of nodes in place, recursively.
+    // Operators with constant operands are folded, branches with constant conditions are eliminated,
+    // and nodes that follow a `return`, `break`, `continue` or `throw` are discarded.
+    // If `bind_std_members` is set, `std.<module>.<member>` is replaced with a node that caches its value.
+    // If `register_expressions` is set, operators on local variables and constants are lowered to registers.
+    // `for` statements that count an integer variable towards a bound are replaced with counted loops.
+    // Bodies of nested functions are not touched, as they are supposed to have been optimized.
+    // After that, escape analysis is performed on the whole body. Variables that are never captured by nested
+    // functions, passed or returned by reference, or bound to `this`, are not tracked by the garbage collector,
+    // because no other variable may reference them.
+    static cow_vector<AIR_Node>& optimize(cow_vector<AIR_Node>& code, const Compiler_Options& opts);
+
     // Rebind this node.
     // If this node refers to a local reference, which has been allocated in an executive context now,
     // we need to replace `*this` with a copy of it.
+    // If a function context with a capture list is passed through, the reference is captured instead: A
+    // descriptor that locates it from the defining context of that function is appended to the list, and `*this`
+    // is replaced with a `push_captured_reference` node, so the body does not depend on the defining context.
     opt<AIR_Node> rebind_opt(const Abstract_Context& ctx) const;
+    // Get references for a new instance of a function, with the capture list of its body.
+    static cow_vector<Reference>& capture_references(cow_vector<Reference>& refs, const cow_vector<Capture>& captures,
+                                                     const Executive_Context& ctx);
 
     // Compress this IR node.
     // Be advised that solid nodes cannot be copied or moved because they occupy variant numbers of bytes.
@@ -293,6 +408,16 @@ class AIR_Node
     // as a whole at the end of the first pass, where nodes are constructed in the second pass.
     // The argument for `ipass` shall be `0` for the first pass and `1` for the second pass.
     AVMC_Queue& solidify(AVMC_Queue& queue, uint8_t ipass) const;
+    // Compress a sequence of IR nodes, performing both passes.
+    // Adjacent nodes that match common patterns, such as a local reference followed by a member access, or
+    // an immediate value followed by a binary operator, are fused into single AVMC nodes (superinstructions).
+    static AVMC_Queue& solidify_all(AVMC_Queue& queue, const cow_vector<AIR_Node>& code);
+
+    // Enable or disable the pair counter mode, which affects sequences that are solidified afterwards.
+    // In this mode, no nodes are fused. Instead, the number of times that each pair of adjacent nodes has
+    // been executed is recorded. `print_pair_counts()` prints the `limit` most frequent pairs.
+    static void set_pair_counter_mode(bool enabled) noexcept;
+    static tinyfmt& print_pair_counts(tinyfmt& fmt, size_t limit);
 
     Variable_Callback& enumerate_variables(Variable_Callback& callback) const;
   };
@@ -14,6 +14,8 @@ Analytic_Context::~Analytic_Context()
 void Analytic_Context::do_prepare_function(const cow_vector<phsh_string>& params)
   {
     // Set parameters, which are local references.
+    // The slot of a parameter is always its subscript in the parameter list.
+    // N.B. If you have ever changed this, remember to update 'executive_context.cpp' as well.
     for(size_t i = 0;  i < params.size();  ++i) {
       const auto& name = params.at(i);
       if(name.empty()) {
@@ -29,6 +31,8 @@ void Analytic_Context::do_prepare_function(const cow_vector<phsh_string>& params
       }
       // Its contents are out of interest.
       this->open_named_reference(name) /*= Reference_root::S_void()*/;
+      this->m_slots.insert_or_assign(name, static_cast<uint32_t>(i));
+      this->m_nslots = static_cast<uint32_t>(i + 1);
     }
     // Set pre-defined references.
     // N.B. If you have ever changed these, remember to update 'executive_context.cpp' as well.
@@ -37,6 +41,20 @@ void Analytic_Context::do_prepare_function(const cow_vector<phsh_string>& params
     this->open_named_reference(::rocket::sref("__func")) /*= Reference_root::S_void()*/;
   }
 
+uint32_t Analytic_Context::declare_slot(const phsh_string& name)
+  {
+    // Just ensure the name exists.
+    this->open_named_reference(name) /*= Reference_root::S_void()*/;
+    // Allocate a new slot, even if the name has been declared in this context. The old reference
+    // must not be overwritten, as it may still be read by deferred expressions.
+    // `UINT32_MAX` is reserved for names that are looked up dynamically.
+    if(this->m_nslots == UINT32_MAX) {
+      ASTERIA_THROW("too many local references in a single scope (name `$1`)", name);
+    }
+    this->m_slots.insert_or_assign(name, this->m_nslots);
+    return this->m_nslots++;
+  }
+
 bool Analytic_Context::do_is_analytic() const noexcept
   {
     return this->is_analytic();
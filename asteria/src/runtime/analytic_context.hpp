@@ -6,6 +6,7 @@
 
 #include "../fwd.hpp"
 #include "abstract_context.hpp"
+#include "air_node.hpp"
 
 namespace Asteria {
 
@@ -14,6 +15,14 @@ class Analytic_Context : public Abstract_Context
   private:
     const Abstract_Context* m_parent_opt;
 
+    // This maps names of local references to slots in the executive context that is to be created
+    // for this context. Pre-defined references are not assigned slots and are looked up by name.
+    cow_dictionary<uint32_t> m_slots;
+    uint32_t m_nslots = 0;
+    // If this is the context of a function whose body is being compiled into a shared template, references
+    // to enclosing contexts are captured, and descriptors that locate them are appended here.
+    cow_vector<AIR_Node::Capture>* m_captures_opt = nullptr;
+
   public:
     Analytic_Context(ref_to<const Abstract_Context> parent, nullptr_t)  // for non-functions
       :
@@ -27,6 +36,13 @@ class Analytic_Context : public Abstract_Context
       {
         this->do_prepare_function(params);
       }
+    Analytic_Context(const Abstract_Context* parent_opt,  // for functions whose bodies are shared
+                     const cow_vector<phsh_string>& params, cow_vector<AIR_Node::Capture>& captures)
+      :
+        m_parent_opt(parent_opt), m_captures_opt(::std::addressof(captures))
+      {
+        this->do_prepare_function(params);
+      }
     ~Analytic_Context() override;
 
   private:
@@ -46,6 +62,22 @@ class Analytic_Context : public Abstract_Context
       {
         return this->m_parent_opt;
       }
+
+    uint32_t count_slots() const noexcept
+      {
+        return this->m_nslots;
+      }
+    const uint32_t* get_slot_opt(const phsh_string& name) const
+      {
+        return this->m_slots.get_ptr(name);
+      }
+    // Declare a local reference and allocate a new slot for it.
+    uint32_t declare_slot(const phsh_string& name);
+
+    cow_vector<AIR_Node::Capture>* get_captures_opt() const noexcept
+      {
+        return this->m_captures_opt;
+      }
   };
 
 }  // namespace Asteria
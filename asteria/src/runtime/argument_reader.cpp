@@ -7,13 +7,37 @@
 
 namespace Asteria {
 
+void Argument_Reader::do_record_history(char code)
+  {
+    // Overloads that have a lot of parameters are rare.
+    if(ROCKET_EXPECT(this->m_state.nhist < State::nhist_inline)) {
+      this->m_state.history[this->m_state.nhist++] = code;
+      return;
+    }
+    this->m_state.history_ext.push_back(code);
+  }
+
+void Argument_Reader::do_record_overload()
+  {
+    // Append the current overload to the overload list as a single operation.
+    cow_string ovld(this->m_state.history, this->m_state.nhist);
+    ovld.append(this->m_state.history_ext);
+    ovld.push_back('\0');
+    this->m_ovlds.append(ovld);
+  }
+
+// Parameters are encoded as follows:
+//   A required parameter of type `vtype` is `'A' + vtype`.
+//   An optional parameter of type `vtype` is `'a' + vtype`.
+//   A generic parameter is `'*'`.
+//   The variadic parameter placeholder is `'.'`.
 void Argument_Reader::do_record_parameter_required(Vtype vtype)
   {
     if(this->m_state.finished) {
       ASTERIA_THROW("argument reader finished and disposed");
     }
     // Record a parameter and increment the number of parameters in total.
-    this->m_state.history << ", " << describe_vtype(vtype);
+    this->do_record_history(static_cast<char>('A' + vtype));
     this->m_state.nparams++;
   }
 
@@ -23,7 +47,7 @@ void Argument_Reader::do_record_parameter_optional(Vtype vtype)
       ASTERIA_THROW("argument reader finished and disposed");
     }
     // Record a parameter and increment the number of parameters in total.
-    this->m_state.history << ", [" << describe_vtype(vtype) << ']';
+    this->do_record_history(static_cast<char>('a' + vtype));
     this->m_state.nparams++;
   }
 
@@ -33,7 +57,7 @@ void Argument_Reader::do_record_parameter_generic()
       ASTERIA_THROW("argument reader finished and disposed");
     }
     // Record a parameter and increment the number of parameters in total.
-    this->m_state.history << ", <generic>";
+    this->do_record_history('*');
     this->m_state.nparams++;
   }
 
@@ -43,7 +67,7 @@ void Argument_Reader::do_record_parameter_variadic()
       ASTERIA_THROW("argument reader finished and disposed");
     }
     // Terminate the parameter list.
-    this->m_state.history << ", ...";
+    this->do_record_history('.');
   }
 
 void Argument_Reader::do_record_parameter_finish()
@@ -51,10 +75,10 @@ void Argument_Reader::do_record_parameter_finish()
     if(this->m_state.finished) {
       ASTERIA_THROW("argument reader finished and disposed");
     }
-    // Terminate this overload.
-    this->m_state.history.push_back('\0');
-    // Append it to the overload list as a single operation.
-    this->m_ovlds.append(this->m_state.history);
+    // Terminate this overload. Record it only if it has failed.
+    if(!this->m_state.succeeded) {
+      this->do_record_overload();
+    }
   }
 
 const Reference* Argument_Reader::do_peek_argument_opt() const
@@ -82,7 +106,8 @@ opt<size_t> Argument_Reader::do_check_finish_opt() const
 Argument_Reader& Argument_Reader::I() noexcept
   {
     // Clear internal states.
-    this->m_state.history.clear();
+    this->m_state.nhist = 0;
+    this->m_state.history_ext.clear();
     this->m_state.nparams = 0;
     this->m_state.finished = false;
     this->m_state.succeeded = true;
@@ -139,6 +164,7 @@ bool Argument_Reader::F()
     auto nargs = this->m_args->size();
     if(nargs > *qvoff) {
       this->m_state.succeeded = false;
+      this->do_record_overload();
       return false;
     }
     return true;
@@ -569,14 +595,24 @@ void Argument_Reader::throw_no_matching_function_call() const
       size_t k = 0;
       for(;;) {
         ovlds << '`' << this->m_name << '(';
-        // Get the current parameter list.
+        // Describe parameters of the current overload.
         const char* s = this->m_ovlds.data() + k;
         size_t n = ::std::strlen(s);
-        // If the parameter list is not empty, it always start with a ", ".
-        if(n != 0) {
-          ovlds.append(s + 2, n - 2);
-          k += n;
+        for(size_t i = 0;  i < n;  ++i) {
+          if(i != 0) {
+            ovlds << ", ";
+          }
+          char c = s[i];
+          if((c >= 'A') && (c <= 'A' + vtype_object))
+            ovlds << describe_vtype(static_cast<Vtype>(c - 'A'));
+          else if((c >= 'a') && (c <= 'a' + vtype_object))
+            ovlds << '[' << describe_vtype(static_cast<Vtype>(c - 'a')) << ']';
+          else if(c == '*')
+            ovlds << "<generic>";
+          else
+            ovlds << "...";
         }
+        k += n;
         ovlds << ')' << '`';
         // Seek to the next overload.
         if(++k == this->m_ovlds.size())
@@ -15,17 +15,26 @@ class Argument_Reader
   public:
     struct State
       {
-        cow_string history;
+        // Parameters are recorded as one character each, and are not described until an
+        // exception is to be thrown. See `do_record_parameter_*()` for details.
+        // The inline buffer makes all fields before `history_ext` occupy 32 bytes, which is enough
+        // for almost all overloads. Characters that don't fit are appended to `history_ext`.
+        static constexpr size_t nhist_inline = 25;
+
         uint32_t nparams;
         bool finished;
         bool succeeded;
+        uint8_t nhist;  // number of characters in `history`
+        char history[nhist_inline];
+        cow_string history_ext;
       };
 
   private:
     ref_to<const cow_vector<Reference>> m_args;
     cow_string m_name;
 
-    // `m_ovlds` contains all overloads that have been tested so far.
+    // `m_ovlds` contains all overloads that have failed so far, each of which is terminated by a null
+    // character. Overloads that match are not recorded, as no exception will be thrown for them.
     cow_string m_ovlds;
     // `m_state` can be copied elsewhere and back; any further operations will resume from that point.
     State m_state = { };
@@ -43,6 +52,8 @@ class Argument_Reader
       = delete;
 
   private:
+    inline void do_record_history(char code);
+    inline void do_record_overload();
     inline void do_record_parameter_optional(Vtype vtype);
     inline void do_record_parameter_required(Vtype vtype);
     inline void do_record_parameter_generic();
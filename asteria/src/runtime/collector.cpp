@@ -6,6 +6,10 @@
 #include "variable.hpp"
 #include "variable_callback.hpp"
 #include "../utilities.hpp"
+#include <time.h>  // ::clock_gettime(), ::timespec
+#include <thread>  // ::std::thread, ::std::this_thread::yield()
+#include <mutex>  // ::std::mutex, ::std::lock_guard, ::std::unique_lock
+#include <condition_variable>  // ::std::condition_variable
 
 namespace Asteria {
 namespace {
@@ -76,16 +80,284 @@ struct Variable_Wiper final : Variable_Callback
       }
   };
 
+// Variables that are tracked by older generations are not staged. References from them are counted by
+// reference counts but not gcref counters, so their children are deemed reachable from outside, which is what
+// a remembered set would tell a tracing collector. Cycles through them are collected with older generations.
+inline bool do_is_tracked_by_older(const Variable& var, uint8_t level) noexcept
+  {
+    return (var.get_gclevel() != 0) && (var.get_gclevel() < level);
+  }
+
+// This is the gcref counter of a variable that has been wiped out but is still in `m_staging`.
+constexpr long gcref_wiped = LONG_MIN;
+
+// These are bounds of thresholds that are tuned automatically.
+constexpr uint32_t threshold_min = 10;
+constexpr uint32_t threshold_max = 1000000;
+
+class Unlimited_Budget
+  {
+  public:
+    static constexpr bool suspendable = false;
+
+    constexpr bool exhausted() const noexcept
+      {
+        return false;
+      }
+  };
+
+int64_t do_now_us() noexcept
+  {
+    ::timespec ts;
+    ::clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+  }
+
+class Timed_Budget
+  {
+  private:
+    int64_t m_deadline;
+    uint32_t m_count = 0;
+
+  public:
+    static constexpr bool suspendable = true;
+
+    explicit Timed_Budget(uint32_t budget_us) noexcept
+      :
+        m_deadline(do_now_us() + budget_us)
+      {
+      }
+
+  public:
+    bool exhausted() noexcept
+      {
+        // Reading the clock is not free, so do it every so often.
+        if(++(this->m_count) % 64 != 0) {
+          return false;
+        }
+        return do_now_us() >= this->m_deadline;
+      }
+  };
+
+#ifdef ROCKET_NO_ATOMIC_REFERENCE_COUNTS
+// Traversal may copy pointers to variables, so reference counts would be modified by multiple threads.
+constexpr bool parallel_marking_supported = false;
+#else
+constexpr bool parallel_marking_supported = true;
+#endif
+
+// Waking threads is not free, so small cycles are always run by the calling thread.
+constexpr size_t parallel_min_staged = 4096;
+constexpr size_t parallel_max_workers = 64;
+constexpr size_t buckets_per_task = 256;
+
+// This is the gcref counter of a variable that is reachable from outside but whose children have not been
+// marked, during parallel marking.
+constexpr long gcref_root = -2;
+
 }  // namespace
 
+// Worker threads are started when parallel marking is performed for the first time, and sleep between phases.
+// Each worker thread has a deque of tasks. It takes tasks from the back of its own deque, and steals tasks from
+// the front of others' deques when it runs out of work.
+class Collector::Worker_Pool
+  {
+  public:
+    struct Task
+      {
+        size_t bpos;  // beginning of a range of buckets
+        size_t epos;  // end of a range of buckets
+        Variable* var;  // a single variable if this is not null
+      };
+
+    using Callback = void (void* param, size_t index, const Task& task);
+
+  private:
+    struct Deque
+      {
+        ::std::mutex mutex;
+        cow_vector<Task> tasks;
+        size_t head = 0;  // the first task that has not been stolen
+      };
+
+    size_t m_nworkers;
+    Deque m_deques[parallel_max_workers];
+    ::std::atomic<size_t> m_npending;  // number of tasks that have been pushed but not finished
+
+    // These are protected by `m_mutex`.
+    ::std::mutex m_mutex;
+    ::std::condition_variable m_start;
+    ::std::condition_variable m_done;
+    uint64_t m_serial = 0;  // incremented when a phase is started
+    size_t m_nbusy = 0;  // number of threads that have not finished the current phase
+    bool m_exit = false;
+    Callback* m_callback = nullptr;
+    void* m_param = nullptr;
+
+    size_t m_nthreads = 0;
+    ::std::thread m_threads[parallel_max_workers];
+
+  public:
+    explicit Worker_Pool(size_t nworkers)
+      :
+        m_nworkers(::rocket::clamp(nworkers, size_t(1), parallel_max_workers)), m_npending(0)
+      {
+        // The calling thread is worker #0.
+        for(size_t k = 1;  k < this->m_nworkers;  ++k) {
+          try {
+            this->m_threads[k] = ::std::thread([this, k] { this->do_thread_loop(k);  });
+          }
+          catch(::std::system_error& /*stdex*/) {
+            // Tasks of threads that could not be started will be stolen by others.
+            break;
+          }
+          this->m_nthreads++;
+        }
+      }
+    ~Worker_Pool()
+      {
+        ::std::unique_lock<::std::mutex> lock(this->m_mutex);
+        this->m_exit = true;
+        this->m_start.notify_all();
+        lock.unlock();
+        for(auto& thr : this->m_threads) {
+          if(thr.joinable())
+            thr.join();
+        }
+      }
+
+    Worker_Pool(const Worker_Pool&)
+      = delete;
+    Worker_Pool& operator=(const Worker_Pool&)
+      = delete;
+
+  private:
+    bool do_pop(size_t index, Task& task)
+      {
+        for(size_t k = 0;  k < this->m_nworkers;  ++k) {
+          auto& deque = this->m_deques[(index + k) % this->m_nworkers];
+          ::std::lock_guard<::std::mutex> lock(deque.mutex);
+          if(deque.tasks.size() <= deque.head) {
+            continue;
+          }
+          if(k == 0) {
+            // Take the most recent task of our own.
+            task = deque.tasks.back();
+            deque.tasks.pop_back();
+          }
+          else {
+            // Steal the oldest task of another thread.
+            task = deque.tasks[deque.head++];
+          }
+          if(deque.tasks.size() <= deque.head) {
+            deque.tasks.clear();
+            deque.head = 0;
+          }
+          return true;
+        }
+        return false;
+      }
+
+    void do_work(size_t index)
+      {
+        Task task;
+        for(;;) {
+          if(this->do_pop(index, task)) {
+            (*(this->m_callback))(this->m_param, index, task);
+            this->m_npending.fetch_sub(1, ::std::memory_order_acq_rel);
+            continue;
+          }
+          // Tasks are only pushed by threads that are working on others, so there will be no more work if
+          // all tasks have been finished.
+          if(this->m_npending.load(::std::memory_order_acquire) == 0) {
+            break;
+          }
+          ::std::this_thread::yield();
+        }
+      }
+
+    void do_thread_loop(size_t index)
+      {
+        uint64_t serial = 0;
+        ::std::unique_lock<::std::mutex> lock(this->m_mutex);
+        for(;;) {
+          // Wait for the next phase.
+          while(!this->m_exit && (this->m_serial == serial))
+            this->m_start.wait(lock);
+          if(this->m_exit)
+            break;
+          serial = this->m_serial;
+          lock.unlock();
+          this->do_work(index);
+          lock.lock();
+          // Notify the calling thread if this is the last one.
+          if(--(this->m_nbusy) == 0)
+            this->m_done.notify_one();
+        }
+      }
+
+  public:
+    size_t size() const noexcept
+      {
+        return this->m_nworkers;
+      }
+
+    void push(size_t index, const Task& task)
+      {
+        this->m_npending.fetch_add(1, ::std::memory_order_relaxed);
+        auto& deque = this->m_deques[index];
+        ::std::lock_guard<::std::mutex> lock(deque.mutex);
+        deque.tasks.emplace_back(task);
+      }
+    void push_buckets(size_t nbkt)
+      {
+        // Distribute ranges of buckets to all threads evenly.
+        for(size_t bpos = 0;  bpos < nbkt;  bpos += buckets_per_task) {
+          Task task = { bpos, ::rocket::min(bpos + buckets_per_task, nbkt), nullptr };
+          this->push(bpos / buckets_per_task % this->m_nworkers, task);
+        }
+      }
+
+    // This runs a phase. All threads have finished the phase when this function returns, so it is also a
+    // barrier between phases.
+    template<typename FuncT> void run(FuncT&& func)
+      {
+        using Func = typename ::std::remove_reference<FuncT>::type;
+        ::std::unique_lock<::std::mutex> lock(this->m_mutex);
+        this->m_callback = [](void* param, size_t index, const Task& task) {
+                             (*static_cast<Func*>(param))(index, task);  };
+        this->m_param = ::std::addressof(func);
+        this->m_nbusy = this->m_nthreads;
+        this->m_serial++;
+        this->m_start.notify_all();
+        lock.unlock();
+        // The calling thread works, too.
+        this->do_work(0);
+        lock.lock();
+        while(this->m_nbusy != 0)
+          this->m_done.wait(lock);
+      }
+  };
+
+Collector::~Collector()
+  {
+    delete this->m_workers;
+  }
+
 bool Collector::track_variable(const rcptr<Variable>& var)
   {
     if(!this->m_tracked.insert(var)) {
       return false;
     }
+    var->set_gclevel(this->m_level);
     this->m_counter++;
     // Perform automatic garbage collection on `*this`.
     if(ROCKET_UNEXPECT(this->m_counter > this->m_threshold)) {
+      if(this->m_step_budget != 0) {
+        // Perform a single step.
+        this->do_collect_step_chain();
+        return true;
+      }
       auto qnext = this;
       do {
         qnext = qnext->collect_single_opt();
@@ -99,155 +371,535 @@ bool Collector::untrack_variable(const rcptr<Variable>& var) noexcept
     if(!this->m_tracked.erase(var)) {
       return false;
     }
+    var->set_gclevel(0);
     this->m_counter--;
     return true;
   }
 
-Collector* Collector::collect_single_opt()
+void Collector::do_collect_step_chain()
+  {
+    // Resume the cycle in progress on the oldest generation. As the counter of `*this` is only reset when its
+    // cycle completes, a step is performed for each variable that is tracked until then.
+    auto qcoll = this;
+    for(auto qtied = this->m_tied_opt;  qtied;  qtied = qtied->m_tied_opt)
+      if(qtied->m_phase != phase_idle)
+        qcoll = qtied;
+    // If the tied collector should be collected as well, start its cycle, which will be resumed later.
+    auto qnext = qcoll->collect_step_opt(this->m_step_budget);
+    if(qnext && (qnext->m_phase == phase_idle)) {
+      qnext->m_phase = phase_staging;
+      qnext->m_cursor = 0;
+      qnext->m_interrupted = true;
+      qnext->m_counter_base = qnext->m_counter;
+    }
+  }
+
+template<typename BudgetT> Collector* Collector::do_collect_steps(BudgetT& budget)
   {
     // Ignore recursive requests.
     const Sentry sentry(this->m_recur);
     if(!sentry)
       return nullptr;
+    auto start_us = do_now_us();
+    auto next = this->do_run_phases(budget);
+    auto end_us = do_now_us();
+    // Update statistics of the current cycle.
+    auto pause_us = static_cast<uint32_t>(::rocket::min(end_us - start_us, INT32_MAX));
+    this->m_current.pause_us = ::rocket::max(this->m_current.pause_us, pause_us);
+    this->m_current.time_us += ::rocket::min(pause_us, UINT32_MAX - this->m_current.time_us);
+    if(this->m_phase != phase_idle)
+      return nullptr;
+    // The cycle has completed.
+    if(this->m_last_end_us != 0)
+      this->m_current.interval_us = static_cast<uint32_t>(::rocket::min(end_us - this->m_last_end_us, INT32_MAX));
+    this->m_last_end_us = end_us;
+    this->m_current.cycles = this->m_stats.cycles + 1;
+    this->m_stats = ::std::exchange(this->m_current, GC_Statistics());
+    this->do_tune_threshold();
+    return next;
+  }
+
+template<typename BudgetT> Collector* Collector::do_run_phases(BudgetT& budget)
+  {
     Collector* next = nullptr;
     auto output = this->m_output_opt;
     auto tied = this->m_tied_opt;
+    auto level = this->m_level;
     // The algorithm here is basically described at
     //   https://pythoninternal.wordpress.com/2014/08/04/the-garbage-collector/
     // We initialize `gcref` to zero then increment it, rather than initialize `gcref` to
     // the reference count then decrement it. This saves a phase below for us.
-    this->m_staging.clear();
+    // Each phase may be suspended when the budget runs out, and resumed at `m_cursor`, which is an index into
+    // the bucket table of the set being iterated over.
+    if(this->m_phase == phase_idle) {
+      // Tables are not shrunk automatically, so a cycle could spend a lot of time on empty buckets after the
+      // number of variables has dropped.
+      this->m_tracked.shrink_to_fit();
+      this->m_staging.clear().shrink_to_fit(this->m_stats.staged);
+      this->m_candidates.shrink_to_fit();
+      this->m_phase = phase_staging;
+      this->m_cursor = 0;
+      this->m_interrupted = false;
+      this->m_counter_base = this->m_counter;
+    }
 
     ///////////////////////////////////////////////////////////////////////////
     // Phase 1
     //   Add variables that are either tracked or reachable from tracked ones
     //   into the staging area.
     ///////////////////////////////////////////////////////////////////////////
-    do_traverse(this->m_tracked,
-      [&](const rcptr<Variable>& root) {
-        // Add a variable that is reachable directly.
-        // The reference from `m_tracked` should be excluded, so we initialize the gcref
-        // counter to 1.
-        root->reset_gcref(1);
-        // If this variable has been inserted indirectly, finish.
-        if(!this->m_staging.insert(root)) {
+    while(this->m_phase == phase_staging) {
+      if(this->m_cursor >= this->m_tracked.bucket_count()) {
+        this->m_current.staged = static_cast<uint32_t>(this->m_staging.size());
+        this->m_phase = phase_counting;
+        this->m_cursor = 0;
+        break;
+      }
+      if(budget.exhausted()) {
+        this->m_interrupted = true;
+        return nullptr;
+      }
+      auto qroot = this->m_tracked.get_bucket_opt(this->m_cursor++);
+      if(!qroot) {
+        continue;
+      }
+      const auto& root = *qroot;
+      // Add a variable that is reachable directly.
+      // The reference from `m_tracked` should be excluded, so we initialize the gcref
+      // counter to 1.
+      root->reset_gcref(1);
+      // If this variable has been inserted indirectly, finish.
+      if(!this->m_staging.insert(root)) {
+        continue;
+      }
+      // Enumerate variables that are reachable from `root` indirectly.
+      do_traverse(*root,
+        [&](const rcptr<Variable>& child) {
+          // Leave variables of older generations alone.
+          if(do_is_tracked_by_older(*child, level)) {
+            return false;
+          }
+          // If this variable has been inserted indirectly, finish.
+          if(!this->m_staging.insert(child)) {
+            return false;
+          }
+          // Initialize the gcref counter.
+          // N.B. If this variable is encountered later from `m_tracked`, the gcref counter
+          // will be overwritten with 1.
+          child->reset_gcref(0);
+          // Decend into grandchildren.
+          return true;
+        });
+    }
+
+    // Phases 2 and 3 may be run by multiple threads if they will not be suspended.
+    if(!BudgetT::suspendable && parallel_marking_supported && (this->m_phase == phase_counting) &&
+       (this->m_cursor == 0) && (this->m_nworkers > 1) && (this->m_staging.size() >= parallel_min_staged)) {
+      this->do_count_and_mark_parallel();
+      this->m_phase = phase_selecting;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Phase 2
+    //   Drop references directly or indirectly from `m_staging`.
+    ///////////////////////////////////////////////////////////////////////////
+    while(this->m_phase == phase_counting) {
+      if(this->m_cursor >= this->m_staging.bucket_count()) {
+        this->m_phase = phase_marking;
+        this->m_cursor = 0;
+        break;
+      }
+      if(budget.exhausted()) {
+        this->m_interrupted = true;
+        return nullptr;
+      }
+      auto qroot = this->m_staging.get_bucket_opt(this->m_cursor++);
+      if(!qroot) {
+        continue;
+      }
+      const auto& root = *qroot;
+      // Drop a direct reference.
+      root->increment_gcref(1);
+      ROCKET_ASSERT(this->m_interrupted || (root->get_gcref() <= root->use_count()));
+      // Skip variables that cannot have any children.
+      auto split = root->gcref_split();
+      if(split <= 0) {
+        continue;
+      }
+      // Enumerate variables that are reachable from `root` indirectly.
+      do_traverse(*root,
+        [&](const rcptr<Variable>& child) {
+          // Variables of older generations have not been staged.
+          if(do_is_tracked_by_older(*child, level)) {
+            return false;
+          }
+          // Drop an indirect reference.
+          child->increment_gcref(split);
+          ROCKET_ASSERT(this->m_interrupted || (child->get_gcref() <= child->use_count()));
+          // This is not going to be recursive.
           return false;
+        });
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Phase 3
+    //   Mark variables reachable indirectly from those reachable directly.
+    ///////////////////////////////////////////////////////////////////////////
+    while(this->m_phase == phase_marking) {
+      if(this->m_cursor >= this->m_staging.bucket_count()) {
+        this->m_phase = phase_selecting;
+        this->m_cursor = 0;
+        break;
+      }
+      if(budget.exhausted()) {
+        this->m_interrupted = true;
+        return nullptr;
+      }
+      auto qroot = this->m_staging.get_bucket_opt(this->m_cursor++);
+      if(!qroot) {
+        continue;
+      }
+      const auto& root = *qroot;
+      // Skip variables that are possibly unreachable.
+      if(root->get_gcref() >= root->use_count()) {
+        continue;
+      }
+      // Make this variable reachable, ...
+      root->reset_gcref(-1);
+      // ... as well as all children.
+      do_traverse(*root,
+        [&](const rcptr<Variable>& child) {
+          // Skip variables that have already been marked, or that have not been staged.
+          if((child->get_gcref() < 0) || do_is_tracked_by_older(*child, level)) {
+            return false;
+          }
+          // Mark it, ...
+          child->reset_gcref(-1);
+          // ... as well as all grandchildren.
+          return true;
+        });
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Phase 4
+    //   Wipe out variables whose `gcref` counters have excceeded their
+    //   reference counts. If the mutator has run between steps, they have
+    //   to be verified first.
+    ///////////////////////////////////////////////////////////////////////////
+    while(this->m_phase == phase_selecting) {
+      if(this->m_cursor >= this->m_staging.bucket_count()) {
+        if(!this->m_candidates.empty())
+          this->do_verify_candidates();
+        this->m_phase = phase_promoting;
+        this->m_cursor = 0;
+        break;
+      }
+      if(budget.exhausted()) {
+        this->m_interrupted = true;
+        return nullptr;
+      }
+      auto qroot = this->m_staging.get_bucket_opt(this->m_cursor++);
+      if(!qroot) {
+        continue;
+      }
+      const auto& root = *qroot;
+      // All reachable variables will have negative gcref counters.
+      if(root->get_gcref() < 0) {
+        continue;
+      }
+      if(this->m_interrupted) {
+        // Verify it later.
+        this->m_candidates.insert(root);
+        continue;
+      }
+      // Nothing has changed since marking, so this variable is unreachable. It can't be erased from
+      // `m_staging` which is being iterated over, so it is moved into the pool in the next phase.
+      this->m_graveyard.emplace_back(::std::move(root->open_value()));
+      root->uninitialize();
+      root->reset_gcref(gcref_wiped);
+      this->m_tracked.erase(root);
+      this->m_current.collected++;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Phase 5
+    //   Put variables that have been wiped out into the pool, and transfer
+    //   ones that have survived to the tied collector.
+    ///////////////////////////////////////////////////////////////////////////
+    while(this->m_phase == phase_promoting) {
+      if(this->m_cursor >= this->m_staging.bucket_count()) {
+        this->m_phase = phase_sweeping;
+        this->m_cursor = 0;
+        break;
+      }
+      if(budget.exhausted()) {
+        this->m_interrupted = true;
+        return nullptr;
+      }
+      auto qroot = this->m_staging.get_bucket_opt(this->m_cursor++);
+      if(!qroot) {
+        continue;
+      }
+      const auto& root = *qroot;
+      // Nobody else can access a variable that has been wiped out, so its gcref counter is intact.
+      if(root->get_gcref() == gcref_wiped) {
+        // Cache this variable if a pool is specified.
+        if(output) {
+          output->insert(root);
         }
-        // If `root` is the last reference to this variable, it can be marked for collection
-        // immediately.
-        auto nref = root->use_count();
-        if(nref <= 1) {
-          root->uninitialize();
-          return false;
+        continue;
+      }
+      if(!tied) {
+        // Leave this variable intact.
+        continue;
+      }
+      // Transfer this variable to the next generational collector, if one has been tied.
+      tied->m_tracked.insert(root);
+      root->set_gclevel(tied->m_level);
+      // Check whether the next generation needs to be checked as well.
+      if(tied->m_counter++ >= tied->m_threshold) {
+        next = tied;
+      }
+      this->m_tracked.erase(root);
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Phase 6
+    //   Destroy values of variables that have been wiped out.
+    ///////////////////////////////////////////////////////////////////////////
+    while(this->m_phase == phase_sweeping) {
+      if(this->m_graveyard.empty()) {
+        this->m_phase = phase_idle;
+        break;
+      }
+      if(budget.exhausted()) {
+        this->m_interrupted = true;
+        return nullptr;
+      }
+      this->m_graveyard.pop_back();
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Finish
+    ///////////////////////////////////////////////////////////////////////////
+    this->m_staging.clear();
+    // Variables that have been tracked since the cycle started might not have been staged, so they are left
+    // for the next cycle.
+    this->m_counter -= ::rocket::min(this->m_counter, this->m_counter_base);
+    return next;
+  }
+
+void Collector::do_count_and_mark_parallel()
+  {
+    const auto& staging = this->m_staging;
+    auto level = this->m_level;
+    // Start worker threads if none have been started, or if the number has been changed.
+    auto nworkers = ::rocket::clamp(size_t(this->m_nworkers), size_t(1), parallel_max_workers);
+    if(!this->m_workers || (this->m_workers->size() != nworkers)) {
+      delete ::std::exchange(this->m_workers, nullptr);
+      this->m_workers = new Worker_Pool(nworkers);
+    }
+    auto& pool = *(this->m_workers);
+
+    // Phase 2
+    //   A variable may be referenced by variables in different tasks, so its gcref counter is incremented
+    //   atomically.
+    pool.push_buckets(staging.bucket_count());
+    pool.run(
+      [&](size_t /*index*/, const Worker_Pool::Task& task) {
+        for(size_t i = task.bpos;  i < task.epos;  ++i) {
+          auto qroot = staging.get_bucket_opt(i);
+          if(!qroot) {
+            continue;
+          }
+          const auto& root = *qroot;
+          root->increment_gcref_shared(1);
+          auto split = root->gcref_split();
+          if(split <= 0) {
+            continue;
+          }
+          do_traverse(*root,
+            [&](const rcptr<Variable>& child) {
+              if(!do_is_tracked_by_older(*child, level)) {
+                child->increment_gcref_shared(split);
+              }
+              return false;
+            });
         }
-        // Enumerate variables that are reachable from `root` indirectly.
-        do_traverse(*root,
-          [&](const rcptr<Variable>& child) {
-            // If this variable has been inserted indirectly, finish.
-            if(!this->m_staging.insert(child)) {
+      });
+
+    // Phase 3
+    //   Find variables that are reachable from outside first. Reference counts may be modified by copies of
+    //   pointers made during traversal, so they are read when nothing is being traversed.
+    pool.push_buckets(staging.bucket_count());
+    pool.run(
+      [&](size_t /*index*/, const Worker_Pool::Task& task) {
+        for(size_t i = task.bpos;  i < task.epos;  ++i) {
+          auto qroot = staging.get_bucket_opt(i);
+          if(!qroot) {
+            continue;
+          }
+          const auto& root = *qroot;
+          if(root->get_gcref() < root->use_count()) {
+            root->reset_gcref(gcref_root);
+          }
+        }
+      });
+    //   Then mark their children. Each variable that has been marked becomes a task, which may be stolen by
+    //   another thread.
+    pool.push_buckets(staging.bucket_count());
+    pool.run(
+      [&](size_t index, const Worker_Pool::Task& task) {
+        auto mark_children = [&](const Variable& var) {
+          do_traverse(var,
+            [&](const rcptr<Variable>& child) {
+              // Only one thread may mark a variable. Roots are marked by their own tasks.
+              if(!do_is_tracked_by_older(*child, level) && child->mark_gcref_shared()) {
+                Worker_Pool::Task next = { 0, 0, child.get() };
+                pool.push(index, next);
+              }
               return false;
-            }
-            // Initialize the gcref counter.
-            // N.B. If this variable is encountered later from `m_tracked`, the gcref counter
-            // will be overwritten with 1.
-            child->reset_gcref(0);
-            // Decend into grandchildren.
-            return true;
-          });
-        return false;
+            });
+        };
+        if(task.var) {
+          mark_children(*(task.var));
+          return;
+        }
+        for(size_t i = task.bpos;  i < task.epos;  ++i) {
+          auto qroot = staging.get_bucket_opt(i);
+          if(!qroot) {
+            continue;
+          }
+          const auto& root = *qroot;
+          if(root->get_gcref() != gcref_root) {
+            continue;
+          }
+          root->reset_gcref(-1);
+          mark_children(*root);
+        }
       });
+  }
 
-    ///////////////////////////////////////////////////////////////////////////
-    // Phase 2
-    //   Drop references directly or indirectly from `m_staging`.
-    ///////////////////////////////////////////////////////////////////////////
-    do_traverse(this->m_staging,
+void Collector::do_verify_candidates()
+  {
+    auto output = this->m_output_opt;
+
+    // As the mutator may have run between steps, phases above might have been misled by references that
+    // have been added or removed, so candidates are merely a heuristic. Verify them by trial deletion, which
+    // is restricted to candidates: A variable is garbage only if all references to it come from other
+    // garbage variables. References from `m_staging`, `m_candidates` and `m_tracked` are excluded.
+    do_traverse(this->m_candidates,
+      [&](const rcptr<Variable>& root) {
+        root->reset_gcref(2 + this->m_tracked.has(root));
+        return false;
+      });
+    do_traverse(this->m_candidates,
       [&](const rcptr<Variable>& root) {
-        // Drop a direct reference.
-        root->increment_gcref(1);
-        ROCKET_ASSERT(root->get_gcref() <= root->use_count());
         // Skip variables that cannot have any children.
         auto split = root->gcref_split();
         if(split <= 0) {
           return false;
         }
-        // Enumerate variables that are reachable from `root` indirectly.
+        // Drop references from other candidates.
         do_traverse(*root,
           [&](const rcptr<Variable>& child) {
-            // Drop an indirect reference.
-            child->increment_gcref(split);
-            ROCKET_ASSERT(child->get_gcref() <= child->use_count());
-            // This is not going to be recursive.
+            if(this->m_candidates.has(child)) {
+              child->increment_gcref(split);
+            }
             return false;
           });
         return false;
       });
-
-    ///////////////////////////////////////////////////////////////////////////
-    // Phase 3
-    //   Mark variables reachable indirectly from those reachable directly.
-    ///////////////////////////////////////////////////////////////////////////
-    do_traverse(this->m_staging,
+    do_traverse(this->m_candidates,
       [&](const rcptr<Variable>& root) {
         // Skip variables that are possibly unreachable.
         if(root->get_gcref() >= root->use_count()) {
           return false;
         }
-        // Make this variable reachable, ...
+        // Make this variable reachable, as well as all candidates reachable from it.
         root->reset_gcref(-1);
-        // ... as well as all children.
         do_traverse(*root,
           [&](const rcptr<Variable>& child) {
-            // Skip variables that have already been marked.
-            if(child->get_gcref() < 0) {
+            if(!this->m_candidates.has(child) || (child->get_gcref() < 0)) {
               return false;
             }
-            // Mark it, ...
             child->reset_gcref(-1);
-            // ... as well as all grandchildren.
             return true;
           });
         return false;
       });
 
-    ///////////////////////////////////////////////////////////////////////////
-    // Phase 4
-    //   Wipe out variables whose `gcref` counters have excceeded their
-    //   reference counts.
-    ///////////////////////////////////////////////////////////////////////////
-    do_traverse(this->m_staging,
+    // Wipe out variables that remain unreachable.
+    do_traverse(this->m_candidates,
       [&](const rcptr<Variable>& root) {
-        // All reachable variables will have negative gcref counters.
-        if(root->get_gcref() >= 0) {
-          // Overwrite the value of this variable with a scalar value to break reference cycles.
-          root->uninitialize();
-          // Cache this variable if a pool is specified.
-          if(output) {
-            output->insert(root);
-          }
-          this->m_tracked.erase(root);
+        if(root->get_gcref() < 0) {
           return false;
         }
-        if(tied) {
-          // Transfer this variable to the next generational collector, if one has been tied.
-          tied->m_tracked.insert(root);
-          // Check whether the next generation needs to be checked as well.
-          if(tied->m_counter++ >= tied->m_threshold) {
-            next = tied;
-          }
-          this->m_tracked.erase(root);
-          return false;
+        // Overwrite the value of this variable with a scalar value to break reference cycles. The old value is
+        // destroyed later, which may take long.
+        this->m_graveyard.emplace_back(::std::move(root->open_value()));
+        root->uninitialize();
+        // Cache this variable if a pool is specified.
+        if(output) {
+          output->insert(root);
         }
-        // Leave this variable intact.
+        this->m_tracked.erase(root);
+        this->m_staging.erase(root);
+        this->m_current.collected++;
         return false;
       });
+    this->m_candidates.clear();
+  }
 
-    ///////////////////////////////////////////////////////////////////////////
-    // Finish
-    ///////////////////////////////////////////////////////////////////////////
-    this->m_staging.clear();
-    this->m_counter = 0;
-    return next;
+void Collector::do_tune_threshold() noexcept
+  {
+    auto& stats = this->m_stats;
+    if(this->m_policy != gc_policy_adaptive) {
+      stats.decision = gc_decision_none;
+      return;
+    }
+    // These rules are applied in order of priority, like JVM ergonomics: the pause goal comes first, then
+    // throughput, then footprint.
+    // The cost of a cycle is proportional to the number of variables that are staged. If most of them are
+    // garbage, it is proportional to the threshold, and collecting less often doesn't save much time. Only if
+    // most of them survive, which are staged again and again, does a larger threshold improve throughput.
+    // Hence the threshold is only raised beyond the explicit one in the latter case, and is lowered for
+    // footprint no further than the explicit one.
+    uint64_t thres = this->m_threshold;
+    uint64_t base = this->m_threshold_base;
+    uint64_t gc_scaled = uint64_t(stats.time_us) * (uint64_t(this->m_time_ratio) + 1);
+    bool mostly_garbage = uint64_t(stats.collected) * 2 > stats.staged;
+    if(stats.pause_us > this->m_pause_goal_us) {
+      thres -= thres / 4;
+      stats.decision = gc_decision_shrink_for_pause;
+    }
+    else if((stats.interval_us != 0) && (gc_scaled > stats.interval_us) && (!mostly_garbage || (thres < base))) {
+      thres += thres / 2 + 1;
+      stats.decision = gc_decision_grow_for_throughput;
+    }
+    else if((stats.interval_us != 0) && (gc_scaled * 4 < stats.interval_us) && mostly_garbage && (thres > base)) {
+      thres = ::rocket::max(thres - thres / 8, base);
+      stats.decision = gc_decision_shrink_for_footprint;
+    }
+    else {
+      stats.decision = gc_decision_keep;
+    }
+    // Don't move the threshold out of range, but keep explicit settings that are already beyond it.
+    thres = ::rocket::clamp(thres, ::rocket::min(this->m_threshold, threshold_min),
+                                   ::rocket::max(this->m_threshold, threshold_max));
+    this->m_threshold = static_cast<uint32_t>(thres);
+  }
+
+Collector* Collector::collect_step_opt(uint32_t budget_us)
+  {
+    Timed_Budget budget(budget_us);
+    return this->do_collect_steps(budget);
+  }
+
+Collector* Collector::collect_single_opt()
+  {
+    Unlimited_Budget budget;
+    return this->do_collect_steps(budget);
   }
 
 Collector& Collector::wipe_out_variables() noexcept
@@ -256,9 +908,17 @@ Collector& Collector::wipe_out_variables() noexcept
     const Sentry sentry(this->m_recur);
     if(!sentry)
       return *this;
+    // Abandon the cycle in progress.
+    this->m_phase = phase_idle;
+    this->m_staging.clear();
+    this->m_candidates.clear();
     // Wipe all variables recursively.
     Variable_Wiper wiper;
     this->m_tracked.enumerate_variables(wiper);
+    // Values of variables that have been collected may refer to other variables, too.
+    for(auto& value : this->m_graveyard)
+      value.enumerate_variables(wiper);
+    this->m_graveyard.clear();
     return *this;
   }
 
@@ -9,30 +9,91 @@
 
 namespace Asteria {
 
+struct GC_Statistics
+  {
+    uint64_t cycles = 0;  // number of cycles that have completed
+    uint32_t staged = 0;  // number of variables that were examined in the last cycle
+    uint32_t collected = 0;  // number of variables that were collected in the last cycle
+    uint32_t pause_us = 0;  // longest step of the last cycle, in microseconds
+    uint32_t time_us = 0;  // total time of the last cycle, in microseconds
+    uint32_t interval_us = 0;  // time between ends of the last two cycles, in microseconds
+    GC_Decision decision = gc_decision_none;  // how the threshold was changed after the last cycle
+  };
+
 class Collector
   {
+  public:
+    class Worker_Pool;  // This is opaque.
+
   private:
+    enum Phase : uint8_t
+      {
+        phase_idle       = 0,
+        phase_staging    = 1,  // adding tracked variables and their children into `m_staging`
+        phase_counting   = 2,  // counting references from staged variables
+        phase_marking    = 3,  // marking staged variables that are reachable from outside
+        phase_selecting  = 4,  // moving unmarked ones into `m_candidates`
+        phase_promoting  = 5,  // transferring survivors to the tied collector
+        phase_sweeping   = 6,  // destroying values of collected variables
+      };
+
     Variable_HashSet* m_output_opt;
     Collector* m_tied_opt;
+    uint8_t m_level;  // older generations have lower levels
     uint32_t m_threshold;
+    uint32_t m_threshold_base;  // the threshold that has been set explicitly
 
     uint32_t m_counter = 0;
     long m_recur = 0;
     Variable_HashSet m_tracked;
     Variable_HashSet m_staging;
 
+    // These are states of incremental collection.
+    uint32_t m_step_budget = 0;
+    uint32_t m_nworkers = 1;  // number of threads for phases 2 and 3
+    Worker_Pool* m_workers = nullptr;  // This is created on demand.
+    Phase m_phase = phase_idle;
+    bool m_interrupted = false;
+    uint32_t m_counter_base = 0;  // value of `m_counter` when the cycle started
+    size_t m_cursor = 0;
+    Variable_HashSet m_candidates;
+    cow_vector<Value> m_graveyard;
+
+    // These are states of threshold tuning.
+    GC_Policy m_policy = gc_policy_adaptive;
+    uint32_t m_pause_goal_us = 1000;
+    uint32_t m_time_ratio = 19;  // mutator time divided by collection time
+    int64_t m_last_end_us = 0;
+    GC_Statistics m_current;
+    GC_Statistics m_stats;
+
   public:
     Collector(Variable_HashSet* output_opt, Collector* tied_opt, uint32_t threshold) noexcept
       :
-        m_output_opt(output_opt), m_tied_opt(tied_opt), m_threshold(threshold)
+        m_output_opt(output_opt), m_tied_opt(tied_opt), m_level(do_level_after(tied_opt)),
+        m_threshold(threshold), m_threshold_base(threshold)
       {
       }
+    ~Collector();
 
     Collector(const Collector&)
       = delete;
     Collector& operator=(const Collector&)
       = delete;
 
+  private:
+    static uint8_t do_level_after(const Collector* tied_opt) noexcept
+      {
+        return static_cast<uint8_t>(tied_opt ? (tied_opt->m_level + 1) : 1);
+      }
+
+    template<typename BudgetT> Collector* do_collect_steps(BudgetT& budget);
+    template<typename BudgetT> Collector* do_run_phases(BudgetT& budget);
+    void do_count_and_mark_parallel();
+    void do_verify_candidates();
+    void do_collect_step_chain();
+    void do_tune_threshold() noexcept;
+
   public:
     Variable_HashSet* get_output_pool_opt() const noexcept
       {
@@ -43,13 +104,17 @@ class Collector
         return this->m_output_opt = output_opt, *this;
       }
 
+    // Variables that are tracked by the tied collector, which is of an older generation, are not traversed by
+    // `*this`, so the cost of a cycle is proportional to the number of young variables.
     Collector* get_tied_collector_opt() const noexcept
       {
         return this->m_tied_opt;
       }
     Collector& tie_collector(Collector* tied_opt) noexcept
       {
-        return this->m_tied_opt = tied_opt, *this;
+        this->m_tied_opt = tied_opt;
+        this->m_level = do_level_after(tied_opt);
+        return *this;
       }
 
     uint32_t get_threshold() const noexcept
@@ -58,16 +123,88 @@ class Collector
       }
     Collector& set_threshold(uint32_t threshold) noexcept
       {
-        return this->m_threshold = threshold, *this;
+        this->m_threshold = threshold;
+        this->m_threshold_base = threshold;
+        return *this;
+      }
+
+    // If the policy is adaptive, the threshold is tuned after each cycle. A smaller threshold is preferred if
+    // the longest pause exceeds the pause goal, and a larger one if the ratio of time spent in the mutator to
+    // time spent on collection is lower than the time ratio.
+    GC_Policy get_policy() const noexcept
+      {
+        return this->m_policy;
+      }
+    Collector& set_policy(GC_Policy policy) noexcept
+      {
+        return this->m_policy = policy, *this;
+      }
+
+    uint32_t get_pause_goal() const noexcept
+      {
+        return this->m_pause_goal_us;
+      }
+    Collector& set_pause_goal(uint32_t pause_goal_us) noexcept
+      {
+        return this->m_pause_goal_us = pause_goal_us, *this;
+      }
+
+    uint32_t get_time_ratio() const noexcept
+      {
+        return this->m_time_ratio;
+      }
+    Collector& set_time_ratio(uint32_t time_ratio) noexcept
+      {
+        return this->m_time_ratio = time_ratio, *this;
+      }
+
+    const GC_Statistics& get_statistics() const noexcept
+      {
+        return this->m_stats;
+      }
+
+    // If the budget is zero, automatic garbage collection pauses until all phases have completed. Otherwise it
+    // is performed in steps, each of which takes about that many microseconds.
+    uint32_t get_step_budget() const noexcept
+      {
+        return this->m_step_budget;
+      }
+    Collector& set_step_budget(uint32_t budget_us) noexcept
+      {
+        return this->m_step_budget = budget_us, *this;
+      }
+
+    // If this is greater than one, phases 2 and 3 of cycles that are not performed in steps are run by that
+    // many threads, provided that enough variables have been staged. This has no effect if reference counts
+    // are not atomic. Threads are started by the first such cycle, and are kept until `*this` is destroyed.
+    uint32_t get_parallel_workers() const noexcept
+      {
+        return this->m_nworkers;
+      }
+    Collector& set_parallel_workers(uint32_t nworkers) noexcept
+      {
+        return this->m_nworkers = nworkers, *this;
       }
 
     size_t count_tracked_variables() const noexcept
       {
         return this->m_tracked.size();
       }
+    uint32_t count_pending_variables() const noexcept
+      {
+        return this->m_counter;
+      }
+    bool is_collecting() const noexcept
+      {
+        return this->m_phase != phase_idle;
+      }
     bool track_variable(const rcptr<Variable>& var);
     bool untrack_variable(const rcptr<Variable>& var) noexcept;
 
+    // Each of these functions returns the tied collector if it should be collected as well.
+    // `collect_step_opt()` starts a new cycle or resumes the one in progress, and returns when the budget runs
+    // out. `collect_single_opt()` completes a cycle, which is started if none is in progress.
+    Collector* collect_step_opt(uint32_t budget_us);
     Collector* collect_single_opt();
     Collector& wipe_out_variables() noexcept;
   };
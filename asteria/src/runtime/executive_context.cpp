@@ -6,6 +6,7 @@
 #include "air_node.hpp"
 #include "runtime_error.hpp"
 #include "ptc_arguments.hpp"
+#include "global_context.hpp"
 #include "../llds/avmc_queue.hpp"
 #include "../utilities.hpp"
 
@@ -13,6 +14,17 @@ namespace Asteria {
 
 Executive_Context::~Executive_Context()
   {
+    // Recycle storage for slots.
+    if(this->m_slots.capacity())
+      this->m_global->release_reference_buffer(::std::move(this->m_slots));
+  }
+
+void Executive_Context::do_extend_slots(uint32_t slot)
+  {
+    // Borrow a buffer from the pool, so contexts that are created repeatedly don't allocate memory.
+    if(this->m_slots.capacity() == 0)
+      this->m_slots = this->m_global->acquire_reference_buffer();
+    this->m_slots.append(slot - this->m_slots.size() + 1, Reference_root::S_void());
   }
 
 void Executive_Context::do_bind_parameters(const cow_vector<phsh_string>& params, cow_vector<Reference>&& args)
@@ -20,6 +32,8 @@ void Executive_Context::do_bind_parameters(const cow_vector<phsh_string>& params
     // This is the subscript of the special parameter placeholder `...`.
     size_t elps = SIZE_MAX;
     // Set parameters, which are local references.
+    // The slot of a parameter is always its subscript in the parameter list.
+    // N.B. If you have ever changed this, remember to update 'analytic_context.cpp' as well.
     for(size_t i = 0;  i < params.size();  ++i) {
       const auto& name = params.at(i);
       if(name.empty()) {
@@ -36,9 +50,9 @@ void Executive_Context::do_bind_parameters(const cow_vector<phsh_string>& params
       }
       // Set the parameter.
       if(ROCKET_UNEXPECT(i >= args.size()))
-        this->open_named_reference(name) = Reference_root::S_constant();
+        this->open_slot(static_cast<uint32_t>(i)) = Reference_root::S_constant();
       else
-        this->open_named_reference(name) = ::std::move(args.mut(i));
+        this->open_slot(static_cast<uint32_t>(i)) = ::std::move(args.mut(i));
     }
     if((elps == SIZE_MAX) && (args.size() > params.size())) {
       // Disallow exceess arguments if the function is not variadic.
@@ -51,19 +65,42 @@ void Executive_Context::do_bind_parameters(const cow_vector<phsh_string>& params
       this->m_args = ::std::move(args);
   }
 
-void Executive_Context::do_defer_expression(const Source_Location& sloc, const cow_vector<AIR_Node>& code)
+void Executive_Context::do_bind_deferred_expressions()
   {
-    AVMC_Queue queue;
-    // Solidify the expression.
-    ::rocket::for_each(code, [&](const AIR_Node& node) { node.solidify(queue, 0);  });  // 1st pass
-    ::rocket::for_each(code, [&](const AIR_Node& node) { node.solidify(queue, 1);  });  // 2nd pass
-    // Append it.
-    this->m_defer.emplace_back(sloc, ::std::move(queue));
+    // Borrowed expressions may read local references of this context, which is about to be destroyed.
+    // Bind those references now and solidify the expressions again into queues that are owned.
+    for(const auto& qexpr : this->m_defer_refs) {
+      auto code = qexpr->code_body;
+      for(size_t i = 0;  i < code.size();  ++i) {
+        auto qnode = code[i].rebind_opt(*this);
+        if(qnode)
+          code.mut(i) = ::std::move(*qnode);
+      }
+      AVMC_Queue queue;
+      AIR_Node::solidify_all(queue, code);
+      this->m_defer.emplace_back(qexpr->sloc, ::std::move(queue));
+    }
+    this->m_defer_refs.clear();
   }
 
 void Executive_Context::do_on_scope_exit_void()
   {
     // Execute all deferred expressions backwards.
+    while(this->m_defer_refs.size()) {
+      // Pop an expression.
+      auto qexpr = this->m_defer_refs.back();
+      this->m_defer_refs.pop_back();
+      // Execute it. If an exception is thrown, append a frame and rethrow it.
+      ASTERIA_RUNTIME_TRY {
+        auto status = qexpr->queue_body.execute(*this);
+        ROCKET_ASSERT(status == air_status_next);
+      }
+      ASTERIA_RUNTIME_CATCH(Runtime_Error& except) {
+        except.push_frame_defer(qexpr->sloc);
+        this->do_on_scope_exit_exception(except);
+        throw;
+      }
+    }
     while(this->m_defer.size()) {
       // Pop an expression.
       auto pair = ::std::move(this->m_defer.mut_back());
@@ -88,6 +125,8 @@ void Executive_Context::do_on_scope_exit_return()
     this->m_self = this->m_stack->get_top();
     // If a PTC wrapper is returned, prepend all deferred expressions to it.
     if(auto tca = this->m_self.get_tail_call_opt()) {
+      // Deferred expressions will outlive this context.
+      this->do_bind_deferred_expressions();
       // Take advantage of reference counting.
       auto& defer = tca->open_defer_stack();
       if(defer.empty()) {
@@ -110,6 +149,20 @@ void Executive_Context::do_on_scope_exit_return()
 void Executive_Context::do_on_scope_exit_exception(Runtime_Error& except)
   {
     // Execute all deferred expressions backwards.
+    while(this->m_defer_refs.size()) {
+      // Pop an expression.
+      auto qexpr = this->m_defer_refs.back();
+      this->m_defer_refs.pop_back();
+      // Execute it. If an exception is thrown, replace `except` with it.
+      ASTERIA_RUNTIME_TRY {
+        auto status = qexpr->queue_body.execute(*this);
+        ROCKET_ASSERT(status == air_status_next);
+      }
+      ASTERIA_RUNTIME_CATCH(Runtime_Error& nested) {
+        except = nested;
+        except.push_frame_defer(qexpr->sloc);
+      }
+    }
     while(this->m_defer.size()) {
       // Pop an expression.
       auto pair = ::std::move(this->m_defer.mut_back());
@@ -9,11 +9,23 @@
 #include "variadic_arguer.hpp"
 #include "evaluation_stack.hpp"
 #include "enums.hpp"
+#include "../llds/avmc_queue.hpp"
+#include "../source_location.hpp"
 
 namespace Asteria {
 
 class Executive_Context : public Abstract_Context
   {
+  public:
+    // This is a deferred expression that has been solidified along with its enclosing function.
+    // It is owned by the function, and `defer` statements push only pointers to it.
+    struct Deferred_Expression
+      {
+        Source_Location sloc;
+        cow_vector<AIR_Node> code_body;
+        AVMC_Queue queue_body;
+      };
+
   private:
     const Executive_Context* m_parent_opt;
 
@@ -22,11 +34,19 @@ class Executive_Context : public Abstract_Context
     ref_to<Global_Context> m_global;
     ref_to<Evaluation_Stack> m_stack;
     ref_to<const rcptr<Variadic_Arguer>> m_zvarg;
+    // This points to references that have been captured by the enclosing function, if any.
+    const cow_vector<Reference>* m_captures_opt;
+
+    // This stores local references, whose slots have been assigned by the corresponding analytic context.
+    // Slots are allocated on demand, so a slot that has not been set yields a void reference.
+    cow_vector<Reference> m_slots;
 
     // These members are used for lazy initialization.
     Reference m_self;
     cow_vector<Reference> m_args;
-    // This stores deferred expressions.
+    // These store deferred expressions. Those pushed by `defer` statements are borrowed from the
+    // enclosing function. Those inherited from proper tail calls are owned.
+    cow_vector<const Deferred_Expression*> m_defer_refs;
     cow_bivector<Source_Location, AVMC_Queue> m_defer;
 
   public:
@@ -34,6 +54,7 @@ class Executive_Context : public Abstract_Context
       :
         m_parent_opt(parent.ptr()),
         m_global(parent->m_global), m_stack(parent->m_stack), m_zvarg(parent->m_zvarg),
+        m_captures_opt(parent->m_captures_opt),
         m_self(Reference_root::S_void())
       {
       }
@@ -42,16 +63,17 @@ class Executive_Context : public Abstract_Context
                       cow_bivector<Source_Location, AVMC_Queue>&& defer)  // for proper tail calls
       :
         m_parent_opt(nullptr),
-        m_global(xglobal), m_stack(xstack), m_zvarg(xzvarg),
+        m_global(xglobal), m_stack(xstack), m_zvarg(xzvarg), m_captures_opt(nullptr),
         m_self(Reference_root::S_void()), m_defer(::std::move(defer))
       {
       }
     Executive_Context(ref_to<Global_Context> xglobal, ref_to<Evaluation_Stack> xstack,
-                      ref_to<const rcptr<Variadic_Arguer>> xzvarg, const cow_vector<phsh_string>& params,
+                      ref_to<const rcptr<Variadic_Arguer>> xzvarg, ref_to<const cow_vector<Reference>> xcaptures,
+                      const cow_vector<phsh_string>& params,
                       Reference&& self, cow_vector<Reference>&& args)  // for functions
       :
         m_parent_opt(nullptr),
-        m_global(xglobal), m_stack(xstack), m_zvarg(xzvarg),
+        m_global(xglobal), m_stack(xstack), m_zvarg(xzvarg), m_captures_opt(xcaptures.ptr()),
         m_self(::std::move(self))
       {
         this->do_bind_parameters(params, ::std::move(args));
@@ -59,9 +81,10 @@ class Executive_Context : public Abstract_Context
     ~Executive_Context() override;
 
   private:
+    void do_extend_slots(uint32_t slot);
     void do_bind_parameters(const cow_vector<phsh_string>& params, cow_vector<Reference>&& args);
 
-    void do_defer_expression(const Source_Location& sloc, const cow_vector<AIR_Node>& code);
+    void do_bind_deferred_expressions();
     void do_on_scope_exit_void();
     void do_on_scope_exit_return();
     void do_on_scope_exit_exception(Runtime_Error& except);
@@ -94,9 +117,31 @@ class Executive_Context : public Abstract_Context
         return this->m_zvarg;
       }
 
-    Executive_Context& defer_expression(const Source_Location& sloc, const cow_vector<AIR_Node>& code)
+    const Reference* get_slot_opt(uint32_t slot) const noexcept
+      {
+        if(ROCKET_UNEXPECT(slot >= this->m_slots.size())) {
+          return nullptr;
+        }
+        return this->m_slots.data() + slot;
+      }
+    const Reference* get_capture_opt(uint32_t index) const noexcept
+      {
+        if(ROCKET_UNEXPECT(!this->m_captures_opt || (index >= this->m_captures_opt->size()))) {
+          return nullptr;
+        }
+        return this->m_captures_opt->data() + index;
+      }
+    Reference& open_slot(uint32_t slot)
+      {
+        if(ROCKET_UNEXPECT(slot >= this->m_slots.size())) {
+          this->do_extend_slots(slot);
+        }
+        return this->m_slots.mut(slot);
+      }
+
+    Executive_Context& defer_expression(const Deferred_Expression& expr)
       {
-        this->do_defer_expression(sloc, code);
+        this->m_defer_refs.emplace_back(::std::addressof(expr));
         return *this;
       }
 
@@ -104,7 +149,7 @@ class Executive_Context : public Abstract_Context
     // Note that these functions may throw exceptions on their own, which is why RAII is inapplicable.
     AIR_Status on_scope_exit(AIR_Status status)
       {
-        if(ROCKET_EXPECT(this->m_defer.empty())) {
+        if(ROCKET_EXPECT(this->m_defer_refs.empty() && this->m_defer.empty())) {
           // There is nothing to do.
           return status;
         }
@@ -119,7 +164,7 @@ class Executive_Context : public Abstract_Context
       }
     Runtime_Error& on_scope_exit(Runtime_Error& except)
       {
-        if(ROCKET_EXPECT(this->m_defer.empty())) {
+        if(ROCKET_EXPECT(this->m_defer_refs.empty() && this->m_defer.empty())) {
           // There is nothing to do.
           return except;
         }
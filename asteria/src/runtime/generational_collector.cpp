@@ -34,30 +34,53 @@ rcptr<Variable> Generational_Collector::create_variable(GC_Generation gc_hint)
   {
     // Locate the collector, which will be responsible for tracking the new variable.
     auto& coll = this->*(this->do_locate(gc_hint));
-    // Try allocating a variable from the pool.
-    auto var = this->m_pool.erase_random_opt();
-    if(ROCKET_UNEXPECT(!var)) {
-      // Create a new one if the pool has been exhausted.
-      var = ::rocket::make_refcnt<Variable>();
-    }
+    // Allocate a variable from the arena. Storage of collected variables is reused.
+    auto var = rcptr<Variable>(new(this->m_arena) Variable());
     coll.track_variable(var);
     // Mark it uninitialized.
     var->uninitialize();
     return var;
   }
 
+rcptr<Variable> Generational_Collector::create_untracked_variable()
+  {
+    // Allocate a variable from the arena. Storage of collected variables is reused.
+    auto var = rcptr<Variable>(new(this->m_arena) Variable());
+    // Mark it uninitialized.
+    var->uninitialize();
+    return var;
+  }
+
 size_t Generational_Collector::collect_variables(GC_Generation gc_limit)
   {
     // Collect variables from the newest generation to the oldest.
+    size_t nvars = 0;
     for(auto p = ::std::make_pair(&(this->m_newest), gc_limit + 1);
-          p.first && p.second;  p.first = p.first->get_tied_collector_opt(), p.second--)
+          p.first && p.second;  p.first = p.first->get_tied_collector_opt(), p.second--) {
       p.first->collect_single_opt();
-    // Clear the variable pool.
-    auto nvars = this->m_pool.size();
-    this->m_pool.clear();
+      nvars += p.first->get_statistics().collected;
+    }
     return nvars;
   }
 
+bool Generational_Collector::collect_step(uint32_t budget_us)
+  {
+    // Resume the cycle in progress on the oldest generation.
+    Collector* qcoll = nullptr;
+    for(auto q = &(this->m_newest);  q;  q = q->get_tied_collector_opt())
+      if(q->is_collecting())
+        qcoll = q;
+    // If there is none, start a new one on the newest generation that has tracked any variables since its last
+    // collection. Variables that survive are transferred to the next generation, which is collected later.
+    for(auto q = &(this->m_newest);  q && !qcoll;  q = q->get_tied_collector_opt())
+      if(q->count_pending_variables() != 0)
+        qcoll = q;
+    if(!qcoll)
+      return false;
+    qcoll->collect_step_opt(budget_us);
+    return true;
+  }
+
 Generational_Collector& Generational_Collector::wipe_out_variables() noexcept
   {
     // Uninitialize all variables recursively.
@@ -6,7 +6,7 @@
 
 #include "../fwd.hpp"
 #include "collector.hpp"
-#include "../llds/variable_hashset.hpp"
+#include "../llds/variable_arena.hpp"
 
 namespace Asteria {
 
@@ -14,7 +14,7 @@ class Generational_Collector final : public Rcfwd<Generational_Collector>
   {
   private:
     // Mind the order of construction and destruction.
-    Variable_HashSet m_pool;
+    Variable_Arena m_arena;
     Collector m_oldest;
     Collector m_middle;
     Collector m_newest;
@@ -22,9 +22,9 @@ class Generational_Collector final : public Rcfwd<Generational_Collector>
   public:
     Generational_Collector() noexcept
       :
-        m_oldest(&(this->m_pool),           nullptr,  10),
-        m_middle(&(this->m_pool), &(this->m_oldest),  60),
-        m_newest(&(this->m_pool), &(this->m_middle), 800)
+        m_oldest(nullptr,           nullptr,  10),
+        m_middle(nullptr, &(this->m_oldest),  60),
+        m_newest(nullptr, &(this->m_middle), 800)
       {
       }
     ~Generational_Collector() override;
@@ -38,26 +38,72 @@ class Generational_Collector final : public Rcfwd<Generational_Collector>
     Collector Generational_Collector::* do_locate(GC_Generation gc_gen) const;
 
   public:
-    size_t get_pool_size() const noexcept
+    const Collector& get_collector(GC_Generation gc_gen) const
       {
-        return this->m_pool.size();
+        return this->*(this->do_locate(gc_gen));
       }
-    Generational_Collector& clear_pool() noexcept
+    Collector& open_collector(GC_Generation gc_gen)
       {
-        return this->m_pool.clear(), *this;
+        return this->*(this->do_locate(gc_gen));
       }
 
-    const Collector& get_collector(GC_Generation gc_gen) const
+    // These apply to all generations. See `Collector::set_policy()` for details.
+    GC_Policy get_policy() const noexcept
       {
-        return this->*(this->do_locate(gc_gen));
+        return this->m_newest.get_policy();
       }
-    Collector& open_collector(GC_Generation gc_gen)
+    Generational_Collector& set_policy(GC_Policy policy) noexcept
       {
-        return this->*(this->do_locate(gc_gen));
+        this->m_newest.set_policy(policy);
+        this->m_middle.set_policy(policy);
+        this->m_oldest.set_policy(policy);
+        return *this;
+      }
+    Generational_Collector& set_goals(uint32_t pause_goal_us, uint32_t time_ratio) noexcept
+      {
+        this->m_newest.set_pause_goal(pause_goal_us).set_time_ratio(time_ratio);
+        this->m_middle.set_pause_goal(pause_goal_us).set_time_ratio(time_ratio);
+        this->m_oldest.set_pause_goal(pause_goal_us).set_time_ratio(time_ratio);
+        return *this;
+      }
+
+    // This applies to all generations. See `Collector::set_parallel_workers()`.
+    Generational_Collector& set_parallel_workers(uint32_t nworkers) noexcept
+      {
+        this->m_newest.set_parallel_workers(nworkers);
+        this->m_middle.set_parallel_workers(nworkers);
+        this->m_oldest.set_parallel_workers(nworkers);
+        return *this;
+      }
+
+    // This enables incremental collection on all generations. See `Collector::set_step_budget()`.
+    Generational_Collector& set_step_budget(uint32_t budget_us) noexcept
+      {
+        this->m_newest.set_step_budget(budget_us);
+        this->m_middle.set_step_budget(budget_us);
+        this->m_oldest.set_step_budget(budget_us);
+        return *this;
+      }
+
+    // Variables used to be cached in a pool, which has been superseded by the arena. These are kept for
+    // compatibility and do nothing.
+    [[deprecated("variables are no longer pooled")]] size_t get_pool_size() const noexcept
+      {
+        return 0;
+      }
+    [[deprecated("variables are no longer pooled")]] Generational_Collector& clear_pool() noexcept
+      {
+        return *this;
       }
 
     rcptr<Variable> create_variable(GC_Generation gc_hint = gc_generation_newest);
+    // Variables that are not tracked are destroyed when their reference counts drop to zero. This is only correct
+    // for variables that are not referenced by other variables, as cycles through them are never broken.
+    rcptr<Variable> create_untracked_variable();
     size_t collect_variables(GC_Generation gc_limit = gc_generation_oldest);
+    // This performs a step of incremental collection, which is meant to be called when the host is idle. It
+    // returns `true` if there is more work to do, and `false` if all generations have been collected.
+    bool collect_step(uint32_t budget_us);
     Generational_Collector& wipe_out_variables() noexcept;
   };
 
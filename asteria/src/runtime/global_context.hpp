@@ -16,6 +16,11 @@ class Global_Context : public Abstract_Context
   private:
     Recursion_Sentry m_sentry;
     rcptr<Abstract_Hooks> m_qhooks;
+    cow_vector<cow_vector<Reference>> m_ref_pool;
+    cow_vector<rcfwdp<PTC_Arguments>> m_ptc_pool;
+    bool m_jit_enabled = false;
+    uint64_t m_jit_nqueues = 0;
+    uint64_t m_jit_nexecs = 0;
 
     rcfwdp<Generational_Collector> m_gcoll;
     rcfwdp<Random_Number_Generator> m_prng;
@@ -66,6 +71,109 @@ class Global_Context : public Abstract_Context
       {
         return this->m_qhooks = ::std::move(hooks_opt), *this;
       }
+    bool has_hooks() const noexcept
+      {
+        return static_cast<bool>(this->m_qhooks);
+      }
+
+    // This calls a hook function if hooks have been installed. When there are no hooks, this
+    // is a single test which doesn't touch any reference counter. The pointer is copied before
+    // the call, so a hook may replace hooks of this context safely.
+    template<typename... ParamsT, typename... ArgsT>
+        void call_hook(void (Abstract_Hooks::*mfunc)(ParamsT...), ArgsT&&... args) const
+      {
+        if(ROCKET_EXPECT(!this->m_qhooks)) {
+          return;
+        }
+        this->do_call_hook(mfunc, ::std::forward<ArgsT>(args)...);
+      }
+
+  private:
+    template<typename... ParamsT, typename... ArgsT>
+        ROCKET_NOINLINE void do_call_hook(void (Abstract_Hooks::*mfunc)(ParamsT...), ArgsT&&... args) const
+      {
+        auto qhooks = this->m_qhooks;
+        ((*qhooks).*mfunc)(::std::forward<ArgsT>(args)...);
+      }
+
+  public:
+    // This controls whether hot code may be translated into native code. It is disabled by default.
+    // Disabling it causes all code to be interpreted again. This has no effect if native code
+    // generation is not supported.
+    bool is_jit_enabled() const noexcept
+      {
+        return this->m_jit_enabled;
+      }
+    Global_Context& set_jit_enabled(bool enabled) noexcept
+      {
+        return this->m_jit_enabled = enabled, *this;
+      }
+
+    // These count queues that have been translated into native code in this context, and executions
+    // of native code.
+    uint64_t count_native_queues() const noexcept
+      {
+        return this->m_jit_nqueues;
+      }
+    Global_Context& note_native_queue() noexcept
+      {
+        return this->m_jit_nqueues++, *this;
+      }
+    uint64_t count_native_executions() const noexcept
+      {
+        return this->m_jit_nexecs;
+      }
+    Global_Context& note_native_execution() noexcept
+      {
+        return this->m_jit_nexecs++, *this;
+      }
+
+    // These recycle storage for argument lists and evaluation stacks of function calls.
+    // Buffers are always empty when acquired. Released buffers are cleared, so they don't
+    // keep any variables alive.
+    cow_vector<Reference> acquire_reference_buffer()
+      {
+        cow_vector<Reference> refs;
+        if(ROCKET_EXPECT(this->m_ref_pool.size())) {
+          refs = ::std::move(this->m_ref_pool.mut_back());
+          this->m_ref_pool.pop_back();
+        }
+        return refs;
+      }
+    Global_Context& release_reference_buffer(cow_vector<Reference>&& refs)
+      {
+        // Don't keep buffers that are unallocated or too large.
+        refs.clear();
+        if(refs.capacity() && (refs.capacity() <= 1024) && (this->m_ref_pool.size() < 256)) {
+          this->m_ref_pool.emplace_back(::std::move(refs));
+        }
+        return *this;
+      }
+
+    // These recycle wrappers of proper tail calls, so a loop of tail calls doesn't allocate memory
+    // in each iteration. Released wrappers are cleared, so they don't keep any variables alive.
+    ASTERIA_INCOMPLET(PTC_Arguments) rcptr<PTC_Arguments> acquire_ptc_arguments(const Source_Location& sloc,
+                           const rcptr<Variadic_Arguer>& zvarg, PTC_Aware ptc, const cow_function& target,
+                           cow_vector<Reference>&& args_self)
+      {
+        if(ROCKET_UNEXPECT(this->m_ptc_pool.empty())) {
+          return ::rocket::make_refcnt<PTC_Arguments>(sloc, zvarg, ptc, target, ::std::move(args_self));
+        }
+        auto tca = unerase_cast<PTC_Arguments>(::std::move(this->m_ptc_pool.mut_back()));
+        this->m_ptc_pool.pop_back();
+        tca->reset(sloc, zvarg, ptc, target, ::std::move(args_self));
+        return tca;
+      }
+    ASTERIA_INCOMPLET(PTC_Arguments) Global_Context& release_ptc_arguments(rcptr<PTC_Arguments>&& tca)
+      {
+        // Don't keep wrappers that are still in use.
+        if(tca.unique() && (this->m_ptc_pool.size() < 256)) {
+          tca->clear();
+          this->m_ptc_pool.emplace_back(::std::move(tca));
+        }
+        tca.reset();
+        return *this;
+      }
 
     // These are interfaces for individual global components.
     ASTERIA_INCOMPLET(Generational_Collector) rcptr<Generational_Collector> generational_collector() const noexcept
@@ -49,20 +49,28 @@ Instantiated_Function::~Instantiated_Function()
   {
   }
 
-void Instantiated_Function::do_solidify_code(const cow_vector<AIR_Node>& code)
+void Instantiated_Function::do_solidify_code(const cow_vector<phsh_string>& params, rcptr<Variadic_Arguer>&& zvarg,
+                                             const cow_vector<AIR_Node>& code)
   {
-    ::rocket::for_each(code, [&](const AIR_Node& node) { node.solidify(this->m_queue, 0);  });  // 1st pass
-    ::rocket::for_each(code, [&](const AIR_Node& node) { node.solidify(this->m_queue, 1);  });  // 2nd pass
+    auto body = ::rocket::make_refcnt<Body>();
+    body->params = params;
+    body->zvarg = ::std::move(zvarg);
+    AIR_Node::solidify_all(body->queue, code);
+    this->m_body = ::std::move(body);
   }
 
 tinyfmt& Instantiated_Function::describe(tinyfmt& fmt) const
   {
-    return fmt << this->m_zvarg->func() << " @ " << this->m_zvarg->sloc();
+    return fmt << this->m_body->zvarg->func() << " @ " << this->m_body->zvarg->sloc();
   }
 
 Variable_Callback& Instantiated_Function::enumerate_variables(Variable_Callback& callback) const
   {
-    return this->m_queue.enumerate_variables(callback);
+    for(const auto& ref : this->m_captures)
+      ref.enumerate_variables(callback);
+    if(this->m_owns_body)
+      this->m_body->queue.enumerate_variables(callback);
+    return callback;
   }
 
 Reference& Instantiated_Function::invoke_ptc_aware(Reference& self, Global_Context& global,
@@ -70,17 +78,22 @@ Reference& Instantiated_Function::invoke_ptc_aware(Reference& self, Global_Conte
   {
     // Create the stack and context for this function.
     Evaluation_Stack stack;
-    Executive_Context ctx_func(::rocket::ref(global), ::rocket::ref(stack), ::rocket::ref(this->m_zvarg),
-                               this->m_params, ::std::move(self), ::std::move(args));
+    Executive_Context ctx_func(::rocket::ref(global), ::rocket::ref(stack), ::rocket::ref(this->m_body->zvarg),
+                               ::rocket::ref(this->m_captures), this->m_body->params,
+                               ::std::move(self), ::std::move(args));
+    // If `args` has been stolen for variadic arguments, borrow a buffer from the pool instead.
+    if(args.capacity() == 0) {
+      args = global.acquire_reference_buffer();
+    }
     stack.reserve(::std::move(args));
     // Execute the function body.
     AIR_Status status;
     ASTERIA_RUNTIME_TRY {
-      status = this->m_queue.execute(ctx_func);
+      status = this->m_body->queue.execute(ctx_func);
     }
     ASTERIA_RUNTIME_CATCH(Runtime_Error& except) {
       ctx_func.on_scope_exit(except);
-      except.push_frame_func(this->m_zvarg->sloc(), this->m_zvarg->func());
+      except.push_frame_func(this->m_body->zvarg->sloc(), this->m_body->zvarg->func());
       throw;
     }
     ctx_func.on_scope_exit(status);
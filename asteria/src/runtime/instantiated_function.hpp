@@ -12,36 +12,57 @@ namespace Asteria {
 
 class Instantiated_Function final : public Abstract_Function
   {
+  public:
+    // This is the part of a function that does not depend on its captures. It is compiled once for each
+    // function definition and shared by all its instances.
+    struct Body final : public Rcfwd<Body>
+      {
+        cow_vector<phsh_string> params;
+        rcptr<Variadic_Arguer> zvarg;
+        AVMC_Queue queue;
+      };
+
   private:
-    cow_vector<phsh_string> m_params;
-    rcptr<Variadic_Arguer> m_zvarg;
-    AVMC_Queue m_queue;
+    rcptr<const Body> m_body;
+    cow_vector<Reference> m_captures;
+    // Variables in a shared body are enumerated by its owner, which is the function definition.
+    bool m_owns_body;
 
   public:
     Instantiated_Function(const cow_vector<phsh_string>& params, rcptr<Variadic_Arguer>&& zvarg,
                           const cow_vector<AIR_Node>& code)
       :
-        m_params(params), m_zvarg(::std::move(zvarg))
+        m_owns_body(true)
+      {
+        this->do_solidify_code(params, ::std::move(zvarg), code);
+      }
+    Instantiated_Function(const rcptr<const Body>& body, cow_vector<Reference>&& captures)
+      :
+        m_body(body), m_captures(::std::move(captures)), m_owns_body(false)
       {
-        this->do_solidify_code(code);
       }
     ~Instantiated_Function() override;
 
   private:
-    void do_solidify_code(const cow_vector<AIR_Node>& code);
+    void do_solidify_code(const cow_vector<phsh_string>& params, rcptr<Variadic_Arguer>&& zvarg,
+                          const cow_vector<AIR_Node>& code);
 
   public:
     const Source_Location& source_location() const noexcept
       {
-        return this->m_zvarg->sloc();
+        return this->m_body->zvarg->sloc();
       }
     const cow_string& signature() const noexcept
       {
-        return this->m_zvarg->func();
+        return this->m_body->zvarg->func();
       }
     const cow_vector<phsh_string>& parameters() const noexcept
       {
-        return this->m_params;
+        return this->m_body->params;
+      }
+    const cow_vector<Reference>& captures() const noexcept
+      {
+        return this->m_captures;
       }
 
     tinyfmt& describe(tinyfmt& fmt) const override;
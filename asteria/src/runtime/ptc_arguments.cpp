@@ -5,6 +5,7 @@
 #include "ptc_arguments.hpp"
 #include "reference.hpp"
 #include "variable_callback.hpp"
+#include "../llds/avmc_queue.hpp"
 #include "../utilities.hpp"
 
 namespace Asteria {
@@ -13,6 +14,27 @@ PTC_Arguments::~PTC_Arguments()
   {
   }
 
+PTC_Arguments& PTC_Arguments::reset(const Source_Location& sloc, const rcptr<Variadic_Arguer>& zvarg, PTC_Aware ptc,
+                                    const cow_function& target, cow_vector<Reference>&& args_self)
+  {
+    ROCKET_ASSERT(this->m_defer.empty());
+    this->m_sloc = sloc;
+    this->m_zvarg = zvarg;
+    this->m_ptc = ptc;
+    this->m_target = target;
+    this->m_args_self = ::std::move(args_self);
+    return *this;
+  }
+
+PTC_Arguments& PTC_Arguments::clear() noexcept
+  {
+    this->m_zvarg.reset();
+    this->m_defer.clear();
+    this->m_target.reset();
+    this->m_args_self.clear();
+    return *this;
+  }
+
 Variable_Callback& PTC_Arguments::enumerate_variables(Variable_Callback& callback) const
   {
     this->m_target.enumerate_variables(callback);
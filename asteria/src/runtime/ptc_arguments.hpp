@@ -43,6 +43,11 @@ class PTC_Arguments final : public Rcfwd<PTC_Arguments>
       = delete;
 
   public:
+    // These are used to recycle wrappers. The wrapper must not be shared.
+    PTC_Arguments& reset(const Source_Location& sloc, const rcptr<Variadic_Arguer>& zvarg, PTC_Aware ptc,
+                         const cow_function& target, cow_vector<Reference>&& args_self);
+    PTC_Arguments& clear() noexcept;
+
     const Source_Location& sloc() const noexcept
       {
         return this->m_sloc;
@@ -16,31 +16,115 @@
 namespace Asteria {
 namespace {
 
-Runtime_Error& do_unpack_frames(Runtime_Error& except, Global_Context& global, Evaluation_Stack& stack,
-                                cow_vector<rcptr<PTC_Arguments>>&& frames)
+struct PTC_Frame
   {
-    while(frames.size()) {
-      auto tca = ::std::move(frames.mut_back());
-      frames.pop_back();
-      // Unpack arguments.
-      const auto& sloc = tca->sloc();
-      const auto& inside = tca->zvarg()->func();
-      const auto& qhooks = global.get_hooks_opt();
+    // These describe the function call.
+    Source_Location sloc;
+    rcptr<Variadic_Arguer> zvarg;
+    // These are deferred expressions.
+    cow_bivector<Source_Location, AVMC_Queue> defer;
+    // Frames of state machines repeat, and are folded, so a loop of tail calls doesn't allocate memory.
+    // This frame and the `period - 1` ones before it are repeated `count` times, followed by the first
+    // `phase` ones of them. Only frames without deferred expressions are folded.
+    uint32_t period;
+    uint32_t phase;
+    size_t count;
+  };
 
-      // Push the function call.
-      except.push_frame_call(sloc, inside);
-      // Call the hook function if any.
-      if(qhooks) {
-        qhooks->on_function_except(sloc, inside, except);
+constexpr uint32_t ptc_period_max = 4;
+
+bool do_is_plain_frame(const PTC_Frame& frame) noexcept
+  {
+    return frame.defer.empty() && (frame.period == 1) && (frame.phase == 0) && (frame.count == 1);
+  }
+
+bool do_is_same_frame(const PTC_Frame& frame, const PTC_Arguments& tca) noexcept
+  {
+    return (frame.zvarg == tca.zvarg()) && (frame.sloc.line() == tca.sloc().line()) &&
+           (frame.sloc.file() == tca.sloc().file());
+  }
+
+void do_push_frame(cow_vector<PTC_Frame>& frames, PTC_Arguments& tca)
+  {
+    // Frames are recorded without holding wrappers of proper tail calls, so wrappers can be recycled.
+    if(tca.get_defer_stack().empty() && frames.size()) {
+      auto& last = frames.mut_back();
+      if(!do_is_plain_frame(last)) {
+        // Continue the repetition if this frame is the next one.
+        size_t base = frames.size() - last.period;
+        if(do_is_same_frame(frames[base + last.phase], tca)) {
+          if(++(last.phase) == last.period) {
+            last.phase = 0;
+            last.count++;
+          }
+          return;
+        }
+        // Otherwise, unfold the incomplete repetition.
+        uint32_t phase = ::std::exchange(last.phase, 0U);
+        for(uint32_t k = 0;  k < phase;  ++k) {
+          auto frame = frames[base + k];
+          frames.emplace_back(::std::move(frame));
+        }
       }
-      // Evaluate deferred expressions if any.
-      if(tca->get_defer_stack().size()) {
-        Executive_Context ctx(::rocket::ref(global), ::rocket::ref(stack), ::rocket::ref(tca->zvarg()),
-                              ::std::move(tca->open_defer_stack()));
-        ctx.on_scope_exit(except);
+      // Look for a new repetition.
+      for(uint32_t p = 1;  (p <= ptc_period_max) && (p <= frames.size());  ++p) {
+        if(!do_is_plain_frame(frames[frames.size() - p])) {
+          break;
+        }
+        if(!do_is_same_frame(frames[frames.size() - p], tca)) {
+          continue;
+        }
+        auto& back = frames.mut_back();
+        back.period = p;
+        back.phase = 1;
+        if(back.phase == back.period) {
+          back.phase = 0;
+          back.count++;
+        }
+        return;
       }
-      // Push the caller.
-      except.push_frame_func(tca->zvarg()->sloc(), inside);
+    }
+    PTC_Frame frame = { tca.sloc(), tca.zvarg(), ::std::move(tca.open_defer_stack()), 1, 0, 1 };
+    frames.emplace_back(::std::move(frame));
+  }
+
+Runtime_Error& do_unpack_frame(Runtime_Error& except, Global_Context& global, Evaluation_Stack& stack,
+                               PTC_Frame& frame)
+  {
+    // Unpack arguments.
+    const auto& sloc = frame.sloc;
+    const auto& inside = frame.zvarg->func();
+
+    // Push the function call.
+    except.push_frame_call(sloc, inside);
+    // Call the hook function if any.
+    global.call_hook(&Abstract_Hooks::on_function_except, sloc, inside, except);
+    // Evaluate deferred expressions if any.
+    if(frame.defer.size()) {
+      Executive_Context ctx(::rocket::ref(global), ::rocket::ref(stack), ::rocket::ref(frame.zvarg),
+                            ::std::move(frame.defer));
+      ctx.on_scope_exit(except);
+    }
+    // Push the caller.
+    except.push_frame_func(frame.zvarg->sloc(), inside);
+    return except;
+  }
+
+Runtime_Error& do_unpack_frames(Runtime_Error& except, Global_Context& global, Evaluation_Stack& stack,
+                                cow_vector<PTC_Frame>&& frames)
+  {
+    while(frames.size()) {
+      // Unfold repeated frames backwards.
+      size_t period = frames.back().period;
+      size_t phase = frames.back().phase;
+      size_t count = frames.back().count;
+      size_t base = frames.size() - period;
+      for(size_t k = phase - 1;  k != SIZE_MAX;  --k)
+        do_unpack_frame(except, global, stack, frames.mut(base + k));
+      for(size_t r = 0;  r < count;  ++r)
+        for(size_t k = period - 1;  k != SIZE_MAX;  --k)
+          do_unpack_frame(except, global, stack, frames.mut(base + k));
+      frames.pop_back(period);
     }
     return except;
   }
@@ -51,7 +135,7 @@ Reference& do_unpack_tail_calls(Reference& self, Global_Context& global)
     PTC_Aware ptc_conj = ptc_aware_by_ref;
     rcptr<PTC_Arguments> tca;
     // We must rebuild the backtrace using this queue if an exception is thrown.
-    cow_vector<rcptr<PTC_Arguments>> frames;
+    cow_vector<PTC_Frame> frames;
     Evaluation_Stack stack;
 
     // Unpack all frames recursively.
@@ -60,7 +144,6 @@ Reference& do_unpack_tail_calls(Reference& self, Global_Context& global)
       // Unpack arguments.
       const auto& sloc = tca->sloc();
       const auto& inside = tca->zvarg()->func();
-      const auto& qhooks = global.get_hooks_opt();
 
       // Figure out how to forward the result.
       if(tca->ptc_aware() == ptc_aware_void) {
@@ -70,21 +153,17 @@ Reference& do_unpack_tail_calls(Reference& self, Global_Context& global)
         ptc_conj = ptc_aware_by_val;
       }
       // Record this frame.
-      frames.emplace_back(tca);
+      do_push_frame(frames, *tca);
 
       // Generate a single-step trap.
-      if(qhooks) {
-        qhooks->on_single_step_trap(sloc, inside, nullptr);
-      }
+      global.call_hook(&Abstract_Hooks::on_single_step_trap, sloc, inside, nullptr);
       // Get the `this` reference and all the other arguments.
       const auto& target = tca->get_target();
       auto args = ::std::move(tca->open_arguments_and_self());
       self = ::std::move(args.mut_back());
       args.pop_back();
       // Call the hook function if any.
-      if(qhooks) {
-        qhooks->on_function_call(sloc, inside, target);
-      }
+      global.call_hook(&Abstract_Hooks::on_function_call, sloc, inside, target);
       // Perform a non-tail call.
       ASTERIA_RUNTIME_TRY {
         target.invoke_ptc_aware(self, global, ::std::move(args));
@@ -93,16 +172,19 @@ Reference& do_unpack_tail_calls(Reference& self, Global_Context& global)
         do_unpack_frames(except, global, stack, ::std::move(frames));
         throw;
       }
+      // Recycle the argument buffer and the wrapper.
+      global.release_reference_buffer(::std::move(args));
+      global.release_ptc_arguments(::std::move(tca));
     }
-    // Check for deferred expressions.
+    // Check for deferred expressions. Repeated frames have none.
     while(frames.size()) {
-      tca = ::std::move(frames.mut_back());
-      frames.pop_back();
+      auto frame = ::std::move(frames.mut_back());
+      frames.pop_back(frame.period);
       // Evaluate deferred expressions if any.
       ASTERIA_RUNTIME_TRY {
-        if(tca->get_defer_stack().size()) {
-          Executive_Context ctx(::rocket::ref(global), ::rocket::ref(stack), ::rocket::ref(tca->zvarg()),
-                                ::std::move(tca->open_defer_stack()));
+        if(frame.defer.size()) {
+          Executive_Context ctx(::rocket::ref(global), ::rocket::ref(stack), ::rocket::ref(frame.zvarg),
+                                ::std::move(frame.defer));
           ctx.on_scope_exit(air_status_next);
         }
       }
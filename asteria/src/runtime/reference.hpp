@@ -123,6 +123,36 @@ class Reference
           return this->do_unset(this->m_mods.data(), this->m_mods.size() - 1, this->m_mods.back());
       }
 
+    // These are fast paths of `read()` and `open()` for constants, temporaries and variables without
+    // modifiers. If the value cannot be accessed this way, a null pointer is returned, in which case
+    // the caller shall call `read()` or `open()` instead, which may throw exceptions.
+    ASTERIA_INCOMPLET(Variable) const Value* read_fast_opt() const noexcept
+      {
+        if(ROCKET_UNEXPECT(!this->m_mods.empty()))
+          return nullptr;
+        if(this->m_root.is_temporary())
+          return ::std::addressof(this->m_root.as_temporary());
+        if(this->m_root.is_constant())
+          return ::std::addressof(this->m_root.as_constant());
+        if(ROCKET_UNEXPECT(!this->m_root.is_variable()))
+          return nullptr;
+        auto var = static_cast<const Variable*>(this->m_root.as_variable().get());
+        if(ROCKET_UNEXPECT(!var || !var->is_initialized()))
+          return nullptr;
+        return ::std::addressof(var->get_value());
+      }
+    ASTERIA_INCOMPLET(Variable) Value* open_fast_opt() const noexcept
+      {
+        if(ROCKET_UNEXPECT(!this->m_mods.empty()))
+          return nullptr;
+        if(ROCKET_UNEXPECT(!this->m_root.is_variable()))
+          return nullptr;
+        auto var = static_cast<Variable*>(this->m_root.as_variable().get());
+        if(ROCKET_UNEXPECT(!var || !var->is_initialized() || var->is_immutable()))
+          return nullptr;
+        return ::std::addressof(var->open_value());
+      }
+
     const Value& read(const Modifier& last) const
       {
         return this->do_read(this->m_mods.data(), this->m_mods.size(), last);
@@ -58,12 +58,15 @@ Simple_Script& Simple_Script::reload(tinybuf& cbuf, const cow_string& name)
       Analytic_Context ctx_func(nullptr, this->m_params);
       // Generate code with regard to proper tail calls.
       for(size_t i = 0;  i < epos;  ++i) {
-        stmtq.at(i).generate_code(code_body, nullptr, ctx_func, this->m_opts,
+        stmtq.at(i).generate_code(code_body, ctx_func, this->m_opts,
                                   stmtq.at(i + 1).is_empty_return() ? ptc_aware_void : ptc_aware_none);
       }
-      stmtq.at(epos).generate_code(code_body, nullptr, ctx_func, this->m_opts, ptc_aware_void);
+      stmtq.at(epos).generate_code(code_body, ctx_func, this->m_opts, ptc_aware_void);
+    }
+    // Optimize the body unless disabled.
+    if(!this->m_opts.no_optimization) {
+      AIR_Node::optimize(code_body, this->m_opts);
     }
-    // TODO: Insert optimization passes.
     // Instantiate the function.
     this->m_func = ::rocket::make_refcnt<Instantiated_Function>(this->m_params, ::std::move(zvarg), code_body);
     return *this;
@@ -103,7 +106,7 @@ Reference Simple_Script::execute(Global_Context& global, cow_vector<Value>&& val
   {
     cow_vector<Reference> args;
     args.reserve(vals.size());
-    for(size_t i = 0;  i < args.size();  ++i) {
+    for(size_t i = 0;  i < vals.size();  ++i) {
       Reference_root::S_temporary xref = { ::std::move(vals.mut(i)) };
       args.emplace_back(::std::move(xref));
     }
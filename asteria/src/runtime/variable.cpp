@@ -3,6 +3,7 @@
 
 #include "../precompiled.hpp"
 #include "variable.hpp"
+#include "../llds/variable_arena.hpp"
 #include "../utilities.hpp"
 
 namespace Asteria {
@@ -11,6 +12,29 @@ Variable::~Variable()
   {
   }
 
+void* Variable::operator new(size_t cb)
+  {
+    static thread_local Variable_Arena s_arena;
+    ROCKET_ASSERT(cb == sizeof(Variable));
+    return s_arena.allocate();
+  }
+
+void* Variable::operator new(size_t cb, Variable_Arena& arena)
+  {
+    ROCKET_ASSERT(cb == sizeof(Variable));
+    return arena.allocate();
+  }
+
+void Variable::operator delete(void* ptr) noexcept
+  {
+    Variable_Arena::deallocate(ptr);
+  }
+
+void Variable::operator delete(void* ptr, Variable_Arena& /*arena*/) noexcept
+  {
+    Variable_Arena::deallocate(ptr);
+  }
+
 Variable_Callback& Variable::enumerate_variables(Variable_Callback& callback) const
   {
     return this->m_value.enumerate_variables(callback);
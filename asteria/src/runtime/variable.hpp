@@ -15,13 +15,16 @@ class Variable final : public Rcfwd<Variable>
     Value m_value;
     bool m_immut = false;
     bool m_alive = false;
+    uint8_t m_gclevel = 0;  // level of the collector that tracks this variable, or zero if none
 
     // These are reference counters for garbage collection and are uninitialized by default.
     // As values are reference-counting, reference counts can be fractional. For example,
     // if three variablesshare a single instance of a function, then each of them is supposed
     // to have 1/3 of the object.
-    long m_gcref_i;
-    double m_gcref_f;
+    // They are atomic for parallel marking. Other accesses are relaxed loads and stores, which
+    // are as cheap as plain ones.
+    ::std::atomic<long> m_gcref_i;
+    ::std::atomic<double> m_gcref_f;
 
   public:
     Variable() noexcept
@@ -34,6 +37,14 @@ class Variable final : public Rcfwd<Variable>
     Variable& operator=(const Variable&)
       = delete;
 
+    // Variables are allocated from slabs. If no arena is specified, a per-thread one is used.
+    // An arena shall only be used to allocate variables by one thread at a time, but a variable may be deallocated
+    // by any thread, including after its arena has been destroyed.
+    static void* operator new(size_t cb);
+    static void* operator new(size_t cb, Variable_Arena& arena);
+    static void operator delete(void* ptr) noexcept;
+    static void operator delete(void* ptr, Variable_Arena& arena) noexcept;
+
   public:
     const Value& get_value() const noexcept
       {
@@ -71,18 +82,27 @@ class Variable final : public Rcfwd<Variable>
         return *this;
       }
 
+    uint8_t get_gclevel() const noexcept
+      {
+        return this->m_gclevel;
+      }
+    Variable& set_gclevel(uint8_t level) noexcept
+      {
+        return this->m_gclevel = level, *this;
+      }
+
     long gcref_split() const noexcept
       {
         return this->m_value.gcref_split();
       }
     long get_gcref() const noexcept
       {
-        return this->m_gcref_i;
+        return this->m_gcref_i.load(::std::memory_order_relaxed);
       }
     Variable& reset_gcref(long iref) noexcept
       {
-        this->m_gcref_i = iref;
-        this->m_gcref_f = 0x1p-26;
+        this->m_gcref_i.store(iref, ::std::memory_order_relaxed);
+        this->m_gcref_f.store(0x1p-26, ::std::memory_order_relaxed);
         return *this;
       }
     Variable& increment_gcref(long split) noexcept
@@ -90,16 +110,48 @@ class Variable final : public Rcfwd<Variable>
         // Optimize for the non-split case.
         if(split > 1) {
           // Update the fractional part.
-          this->m_gcref_f += 1 / static_cast<double>(split);
+          auto fref = this->m_gcref_f.load(::std::memory_order_relaxed) + 1 / static_cast<double>(split);
           // Check and accumulate the carry bit.
-          if(static_cast<long>(this->m_gcref_f) == 0)
+          if(static_cast<long>(fref) == 0) {
+            this->m_gcref_f.store(fref, ::std::memory_order_relaxed);
             return *this;
-          this->m_gcref_f -= 1;
+          }
+          this->m_gcref_f.store(fref - 1, ::std::memory_order_relaxed);
         }
-        this->m_gcref_i += 1;
+        this->m_gcref_i.store(this->m_gcref_i.load(::std::memory_order_relaxed) + 1, ::std::memory_order_relaxed);
         return *this;
       }
 
+    // These may be called by multiple threads concurrently.
+    Variable& increment_gcref_shared(long split) noexcept
+      {
+        if(split > 1) {
+          auto fold = this->m_gcref_f.load(::std::memory_order_relaxed);
+          double fref;
+          bool carry;
+          do {
+            fref = fold + 1 / static_cast<double>(split);
+            carry = static_cast<long>(fref) != 0;
+            if(carry)
+              fref -= 1;
+          } while(!this->m_gcref_f.compare_exchange_weak(fold, fref, ::std::memory_order_relaxed));
+          if(!carry)
+            return *this;
+        }
+        this->m_gcref_i.fetch_add(1, ::std::memory_order_relaxed);
+        return *this;
+      }
+    bool mark_gcref_shared() noexcept
+      {
+        // Set the gcref counter to -1 unless it is negative. Only one thread succeeds.
+        auto iold = this->m_gcref_i.load(::std::memory_order_relaxed);
+        do {
+          if(iold < 0)
+            return false;
+        } while(!this->m_gcref_i.compare_exchange_weak(iold, -1, ::std::memory_order_relaxed));
+        return true;
+      }
+
     Variable_Callback& enumerate_variables(Variable_Callback& callback) const;
   };
 
@@ -0,0 +1,57 @@
+// This file is part of Asteria.
+// Copyleft 2018 - 2020, LH_Mouse. All wrongs reserved.
+
+#include "test_utilities.hpp"
+#include "../src/runtime/simple_script.hpp"
+#include "../src/runtime/global_context.hpp"
+#include "../src/runtime/generational_collector.hpp"
+
+using namespace Asteria;
+
+int main()
+  {
+    ::rocket::tinybuf_str cbuf;
+    cbuf.set_string(::rocket::sref(
+      R"__(
+///////////////////////////////////////////////////////////////////////////////
+
+        assert std.gc.get_policy() == "adaptive";
+        assert std.gc.set_policy("meow") == null;
+        assert std.gc.get_statistics(3) == null;
+
+        // Variables that survive are staged by the oldest generation again and again, so its threshold
+        // shall be raised.
+        var base = std.gc.get_threshold(2);
+        var keep = [ ];
+        for(var i = 0;  i < 20000;  ++i) {
+          var x = i;
+          keep[$] = func() = x;
+        }
+        var s = std.gc.get_statistics(2);
+        assert s.cycles > 0;
+        assert s.staged > 0;
+        assert s.threshold == std.gc.get_threshold(2);
+        assert s.threshold > base;
+        assert std.array.find([ "keep", "grow_for_throughput", "shrink_for_footprint" ], s.decision) != null;
+
+        // Thresholds are left intact by the fixed policy.
+        assert std.gc.set_policy("fixed") == "adaptive";
+        std.gc.set_threshold(2, base);
+        for(var i = 0;  i < 20000;  ++i) {
+          var x = i;
+          keep[$] = func() = x;
+        }
+        s = std.gc.get_statistics(2);
+        assert s.threshold == base;
+        assert s.decision == "none";
+        return keep[39999]();
+
+///////////////////////////////////////////////////////////////////////////////
+      )__"), tinybuf::open_read);
+    Simple_Script code(cbuf, ::rocket::sref(__FILE__));
+
+    // Pauses may be long in debug builds. Don't let them get in the way.
+    Global_Context global;
+    global.generational_collector()->set_goals(UINT32_MAX, 19);
+    ASTERIA_TEST_CHECK(code.execute(global).read().as_integer() == 19999);
+  }
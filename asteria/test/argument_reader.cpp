@@ -0,0 +1,75 @@
+// This file is part of Asteria.
+// Copyleft 2018 - 2020, LH_Mouse. All wrongs reserved.
+
+#include "test_utilities.hpp"
+#include "../src/runtime/argument_reader.hpp"
+
+using namespace Asteria;
+
+int main()
+  {
+    cow_vector<Reference> args;
+    args.emplace_back(Reference_root::S_constant{ V_integer(42) });
+    args.emplace_back(Reference_root::S_constant{ V_string("meow") });
+
+    Argument_Reader reader(::rocket::cref(args), ::rocket::sref("test"));
+    Argument_Reader::State state;
+    Ival ival;
+    Sval sval;
+    Ropt ropt;
+    Value val;
+    cow_vector<Value> vargs;
+
+    // The first overload fails.
+    ASTERIA_TEST_CHECK(reader.I().v(sval).F() == false);
+    // This overload fails after its state is saved.
+    ASTERIA_TEST_CHECK(reader.I().v(ival).S(state).o(ropt).F() == false);
+    // This overload fails because of excess arguments.
+    ASTERIA_TEST_CHECK(reader.L(state).F() == false);
+    // These overloads match.
+    ASTERIA_TEST_CHECK(reader.L(state).o(val).F() == true);
+    ASTERIA_TEST_CHECK(val.as_string() == "meow");
+    ASTERIA_TEST_CHECK(reader.I().v(ival).F(vargs) == true);
+    ASTERIA_TEST_CHECK(ival == 42);
+    ASTERIA_TEST_CHECK(vargs.size() == 1);
+
+    // Overloads that have a lot of parameters are supported, and their states can be saved, too.
+    Argument_Reader other(::rocket::cref(args), ::rocket::sref("long"));
+    Argument_Reader::State other_state;
+    other.I().v(ival);
+    for(long i = 0;  i < 40;  ++i) {
+      if(i == 30)
+        other.S(other_state);
+      other.o(ropt);
+    }
+    ASTERIA_TEST_CHECK(other.F() == false);
+    ASTERIA_TEST_CHECK(other.L(other_state).F() == false);
+
+    cow_string expect30 = ::rocket::sref("`long(integer");
+    for(long i = 0;  i < 30;  ++i)
+      expect30 += ", [real]";
+    auto expect40 = expect30;
+    for(long i = 30;  i < 40;  ++i)
+      expect40 += ", [real]";
+    expect30 += ")`";
+    expect40 += ")`";
+    try {
+      other.throw_no_matching_function_call();
+    }
+    catch(exception& e) {
+      ASTERIA_TEST_CHECK(::std::strstr(e.what(), expect30.c_str()));
+      ASTERIA_TEST_CHECK(::std::strstr(e.what(), expect40.c_str()));
+    }
+
+    // Only failed overloads are listed.
+    try {
+      reader.throw_no_matching_function_call();
+    }
+    catch(exception& e) {
+      ASTERIA_TEST_CHECK(::std::strstr(e.what(), "`test(integer, string)`"));
+      ASTERIA_TEST_CHECK(::std::strstr(e.what(), "`test(string)`,\n  `test(integer, [real])`,\n  `test(integer)`\n"));
+      ASTERIA_TEST_CHECK(::std::strstr(e.what(), "<generic>") == nullptr);
+      return 0;
+    }
+    ASTERIA_TEST_CHECK(false);
+  }
@@ -0,0 +1,64 @@
+// This file is part of Asteria.
+// Copyleft 2018 - 2020, LH_Mouse. All wrongs reserved.
+
+#include "test_utilities.hpp"
+#include "../src/runtime/simple_script.hpp"
+#include "../src/runtime/global_context.hpp"
+#include "../src/runtime/air_node.hpp"
+
+using namespace Asteria;
+
+int main()
+  {
+    ::rocket::tinybuf_str cbuf;
+    cbuf.set_string(::rocket::sref(
+      R"__(
+///////////////////////////////////////////////////////////////////////////////
+
+        var r = 0;
+        for(var i = 0; i < 10; ++i)
+          r += std.numeric.abs(-i);
+        assert r == 45;
+        assert std.numeric.nonexistent == null;
+        assert typeof std.numeric.abs == "function";
+        var caught = false;
+        try
+          std.numeric.abs = 42;
+        catch(e)
+          caught = true;
+        assert caught;
+        return std.string.slice("meow", 1);
+
+///////////////////////////////////////////////////////////////////////////////
+      )__"), tinybuf::open_read);
+
+    Simple_Script code;
+    code.open_options().bind_std_members = true;
+    AIR_Node::set_pair_counter_mode(true);
+    code.reload(cbuf, ::rocket::sref(__FILE__));
+    AIR_Node::set_pair_counter_mode(false);
+    Global_Context global;
+    ASTERIA_TEST_CHECK(code.execute(global).read().as_string() == "eow");
+    ASTERIA_TEST_CHECK(code.execute(global).read().as_string() == "eow");
+
+    // Make sure members have been bound.
+    ::rocket::tinyfmt_str fmt;
+    AIR_Node::print_pair_counts(fmt, 100);
+    ASTERIA_TEST_CHECK(fmt.get_string().find("push_std_member") != cow_string::npos);
+    ASTERIA_TEST_CHECK(fmt.get_string().find("push_global_reference") == cow_string::npos);
+
+    // Reinitialize the standard library. Cached values must not be reused.
+    global.initialize();
+    ASTERIA_TEST_CHECK(code.execute(global).read().as_string() == "eow");
+
+    // Rebind `std` to something else, which disables caching.
+    const auto& vstd = global.get_named_reference_opt(::rocket::sref("std"))->read();
+    V_object ostd;
+    V_object ostr;
+    ostr.try_emplace(::rocket::sref("slice"),
+                     vstd.as_object().at(::rocket::sref("string")).as_object().at(::rocket::sref("slice")));
+    ostd.try_emplace(::rocket::sref("string"), ::std::move(ostr));
+    ostd.try_emplace(::rocket::sref("numeric"), vstd.as_object().at(::rocket::sref("numeric")));
+    global.open_named_reference(::rocket::sref("std")) = Reference_root::S_constant{ ::std::move(ostd) };
+    ASTERIA_TEST_CHECK(code.execute(global).read().as_string() == "eow");
+  }
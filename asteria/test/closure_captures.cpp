@@ -0,0 +1,143 @@
+// This file is part of Asteria.
+// Copyleft 2018 - 2020, LH_Mouse. All wrongs reserved.
+
+#include "test_utilities.hpp"
+#include "../src/runtime/simple_script.hpp"
+#include "../src/runtime/global_context.hpp"
+
+using namespace Asteria;
+
+int main()
+  {
+    ::rocket::tinybuf_str cbuf;
+    cbuf.set_string(::rocket::sref(
+      R"__(
+///////////////////////////////////////////////////////////////////////////////
+
+        var r = [ ];
+
+        // Each instance captures its own variables, although the body is shared.
+        var fs = [ ];
+        for(each k, v : [ 10, 20, 30 ]) {
+          var w = v + 1, j = k;
+          fs[$] = func(n) = n * w + j;
+        }
+        r[$] = [ fs[0](1), fs[1](2), fs[2](3) ];
+
+        // Captured variables are shared with the defining context.
+        func counter() {
+          var n = 0;
+          return [ func() = ++n, func() = n ];
+        }
+        var c1 = counter(), c2 = counter();
+        c1[0]();
+        c1[0]();
+        c2[0]();
+        r[$] = [ c1[1](), c2[1]() ];
+
+        // Nested functions capture variables from all enclosing functions.
+        func outer(a) {
+          var b = a * 2;
+          return func(c) {
+            var d = c + 1;
+            return func(e) = a + b * 10 + c * 100 + d * 1000 + e * 10000;
+          };
+        }
+        r[$] = outer(1)(2)(3);
+        r[$] = outer(4)(5)(6);
+
+        // Predefined names are captured, too.
+        func named() {
+          return func() = __func;
+        }
+        r[$] = named()();
+
+        // Captured variables are seen by deferred expressions and tail calls.
+        func deferred(x) {
+          var log = [ ], y = x;
+          var f = func() {
+            defer log[$] = y;
+            return& log;
+          };
+          f();
+          y += 1;
+          f();
+          return log;
+        }
+        r[$] = deferred(5);
+        func recurse(n) {
+          var total = 0;
+          var step;
+          step = func(i) {
+            if(i > n)
+              return total;
+            total += i;
+            return step(i + 1);
+          };
+          return step(1);
+        }
+        r[$] = recurse(100);
+
+        // A declaration that has been bypassed yields null.
+        func bypassed(t) {
+          if(t)
+            return func() = 1;
+          var z = 42;
+          return func() = z;
+        }
+        r[$] = [ bypassed(true)(), bypassed(false)() ];
+
+        // Closures keep only variables that they reference. `big` is passed by reference, so it is a tracked
+        // variable, but it is freed when `capture_one()` returns.
+        func count_tracked() {
+          return std.gc.tracked_count(0) + std.gc.tracked_count(1) + std.gc.tracked_count(2);
+        }
+        func escape(x) {
+          return x;
+        }
+        func capture_one(i) {
+          var big = [ ];
+          for(var k = 0;  k < 1000;  ++k)
+            big[$] = k;
+          escape(&big);
+          var used = i;
+          return func() = used;
+        }
+        var fs = [ ];
+        std.gc.collect();
+        var base = count_tracked();
+        for(var i = 0;  i < 100;  ++i)
+          fs[$] = capture_one(i);
+        std.gc.collect();
+        assert count_tracked() - base == 100;
+        assert fs[42]() == 42;
+        fs = null;
+        std.gc.collect();
+        assert count_tracked() == base;
+        return r;
+
+///////////////////////////////////////////////////////////////////////////////
+      )__"), tinybuf::open_read);
+
+    // Run without optimization.
+    Simple_Script code;
+    code.open_options().no_optimization = true;
+    code.reload(cbuf, ::rocket::sref(__FILE__));
+    Global_Context global;
+    auto expect = code.execute(global).read();
+    ASTERIA_TEST_CHECK(expect.as_array().at(0).compare(V_array({ V_integer(11), V_integer(43),
+                                                                V_integer(95) })) == compare_equal);
+    ASTERIA_TEST_CHECK(expect.as_array().at(1).compare(V_array({ V_integer(2), V_integer(1) })) == compare_equal);
+    ASTERIA_TEST_CHECK(expect.as_array().at(2).as_integer() == 33221);
+    ASTERIA_TEST_CHECK(expect.as_array().at(3).as_integer() == 66584);
+    ASTERIA_TEST_CHECK(expect.as_array().at(5).compare(V_array({ V_integer(5), V_integer(6) })) == compare_equal);
+    ASTERIA_TEST_CHECK(expect.as_array().at(6).as_integer() == 5050);
+
+    // Run with register-based expressions, whose operands are captured differently.
+    cbuf.set_string(cow_string(cbuf.get_string()), tinybuf::open_read);
+    Simple_Script lowered;
+    lowered.open_options().register_expressions = true;
+    lowered.reload(cbuf, ::rocket::sref(__FILE__));
+    auto result = lowered.execute(global).read();
+    ASTERIA_TEST_CHECK(result.compare(expect) == compare_equal);
+  }
@@ -0,0 +1,150 @@
+// This file is part of Asteria.
+// Copyleft 2018 - 2020, LH_Mouse. All wrongs reserved.
+
+#include "test_utilities.hpp"
+#include "../src/runtime/simple_script.hpp"
+#include "../src/runtime/global_context.hpp"
+#include "../src/runtime/air_node.hpp"
+
+using namespace Asteria;
+
+int main()
+  {
+    ::rocket::tinybuf_str cbuf;
+    cbuf.set_string(::rocket::sref(
+      R"__(
+///////////////////////////////////////////////////////////////////////////////
+
+        var r = [ ];
+
+        // The loop variable is not referenced by the body.
+        var n = 0;
+        for(var i = 0;  i < 100;  ++i)
+          n += 2;
+        r[$] = n;
+
+        // Other increments and conditions.
+        var a = [ ];
+        for(var i = 10;  i >= 0;  i -= 3)
+          a[$] = i;
+        for(var i = 0;  i <= 10;  i += 4)
+          a[$] = i;
+        for(var i = 5;  i > 2;  i--)
+          a[$] = i;
+        r[$] = a;
+
+        // The bound is a variable which the body modifies.
+        var m = 10;
+        n = 0;
+        for(var i = 0;  i < m;  ++i) {
+          m -= 1;
+          n += 1;
+        }
+        r[$] = [ m, n ];
+        for(var k = 3, i = 0;  i < k;  i++)
+          n += k;
+        r[$] = n;
+
+        // The body modifies the loop variable.
+        a = [ ];
+        for(var i = 0;  i < 20;  ++i) {
+          a[$] = i;
+          i += 2;
+        }
+        r[$] = a;
+        a = [ ];
+        for(var i = 0;  i < 5;  ++i) {
+          a[$] = i;
+          if(i == 2)
+            i = 2.5;
+        }
+        r[$] = a;
+        try {
+          for(var i = 0;  i < 5;  ++i)
+            i = "x";
+          r[$] = "unreachable";
+        }
+        catch(e) {
+          r[$] = std.string.find(e, "increment not applicable") != null;
+        }
+
+        // Closures capture the loop variable.
+        var fs = [ ];
+        for(var i = 0;  i < 3;  ++i)
+          fs[$] = func() = i;
+        r[$] = [ fs[0](), fs[1](), fs[2]() ];
+
+        // Jumps.
+        a = [ ];
+        for(var i = 0;  i < 10;  ++i) {
+          if(i % 2 == 0)
+            continue;
+          if(i > 6)
+            break;
+          a[$] = i;
+        }
+        r[$] = a;
+        func find(x) {
+          for(var i = 0;  i < 100;  ++i)
+            if(i * i >= x)
+              return i;
+          return -1;
+        }
+        r[$] = [ find(50), find(100000) ];
+
+        // Bounds and initial values that are not integers.
+        n = 0;
+        for(var i = 0;  i < 3.5;  ++i)
+          n += 1;
+        r[$] = n;
+        n = 0;
+        for(var i = 0.5;  i < 3;  ++i)
+          n += 1;
+        r[$] = n;
+
+        // Overflows are detected.
+        try {
+          for(var i = 0x7FFFFFFFFFFFFFFD;  i >= 0;  ++i)
+            ;
+          r[$] = "unreachable";
+        }
+        catch(e) {
+          r[$] = std.string.find(e, "integer addition overflow") != null;
+        }
+        return r;
+
+///////////////////////////////////////////////////////////////////////////////
+      )__"), tinybuf::open_read);
+
+    // Run without optimization.
+    Simple_Script code;
+    code.open_options().no_optimization = true;
+    code.reload(cbuf, ::rocket::sref(__FILE__));
+    Global_Context global;
+    auto expect = code.execute(global).read();
+
+    // Run with counted loops. The results must be identical.
+    cbuf.set_string(cow_string(cbuf.get_string()), tinybuf::open_read);
+    Simple_Script counted;
+    AIR_Node::set_pair_counter_mode(true);
+    counted.reload(cbuf, ::rocket::sref(__FILE__));
+    AIR_Node::set_pair_counter_mode(false);
+    auto result = counted.execute(global).read();
+    ASTERIA_TEST_CHECK(result.compare(expect) == compare_equal);
+    ASTERIA_TEST_CHECK(result.as_array().at(0).as_integer() == 200);
+    ASTERIA_TEST_CHECK(result.as_array().at(4).as_array().size() == 7);
+    ASTERIA_TEST_CHECK(result.as_array().at(6).as_boolean() == true);
+    ASTERIA_TEST_CHECK(result.as_array().at(12).as_boolean() == true);
+
+    ::rocket::tinyfmt_str fmt;
+    AIR_Node::print_pair_counts(fmt, 100);
+    ASTERIA_TEST_CHECK(fmt.get_string().find("counted_for_statement") != cow_string::npos);
+
+    // Run with register-based expressions, whose conditions are lowered differently.
+    cbuf.set_string(cow_string(cbuf.get_string()), tinybuf::open_read);
+    Simple_Script lowered;
+    lowered.open_options().register_expressions = true;
+    lowered.reload(cbuf, ::rocket::sref(__FILE__));
+    result = lowered.execute(global).read();
+    ASTERIA_TEST_CHECK(result.compare(expect) == compare_equal);
+  }
@@ -114,6 +114,45 @@ int main()
           assert rec == [3,2,1];
         }
 
+        // Deferred expressions read local references that were visible when they were pushed.
+        func foo() {
+          var x = 1;
+          defer rec[$] = x;
+          x = 5;
+          var x = 2;
+          defer rec[$] = x;
+        }
+        rec = [ ];
+        foo();
+        assert rec == [2,5];
+
+        func foo() {
+          for(var i = 0;  i < 3;  ++i) {
+            var k = i * 10;
+            defer rec[$] = k + i;
+          }
+        }
+        rec = [ ];
+        foo();
+        assert rec == [0,11,22];
+
+        func foo(a) {
+          var b = a + 1;
+          defer rec[$] = [a,b];
+          {
+            var c = b + 1;
+            defer rec[$] = c;
+            return xpush(c);  // ptc
+          }
+        }
+        rec = [ ];
+        try
+          foo(10);
+        catch(e) {
+          assert e == 12;
+          assert rec == [12,12,[10,11]];
+        }
+
 ///////////////////////////////////////////////////////////////////////////////
       )__"), tinybuf::open_read);
     Simple_Script code(cbuf, ::rocket::sref(__FILE__));
@@ -0,0 +1,130 @@
+// This file is part of Asteria.
+// Copyleft 2018 - 2020, LH_Mouse. All wrongs reserved.
+
+#include "test_utilities.hpp"
+#include "../src/runtime/simple_script.hpp"
+#include "../src/runtime/global_context.hpp"
+
+using namespace Asteria;
+
+::std::atomic<long> bcnt;
+
+void* operator new(size_t cb)
+  {
+    auto ptr = ::std::malloc(cb);
+    if(!ptr) {
+      throw ::std::bad_alloc();
+    }
+    bcnt.fetch_add(1, ::std::memory_order_relaxed);
+    return ptr;
+  }
+
+void operator delete(void* ptr) noexcept
+  {
+    if(!ptr) {
+      return;
+    }
+    bcnt.fetch_sub(1, ::std::memory_order_relaxed);
+    ::std::free(ptr);
+  }
+
+void operator delete(void* ptr, size_t) noexcept
+  {
+    operator delete(ptr);
+  }
+
+int main()
+  {
+    // Ignore leaks of emutls, emergency pool, etc.
+    delete new int;
+
+    bcnt.store(0, ::std::memory_order_relaxed);
+    {
+      Global_Context global;
+      ::rocket::tinybuf_str cbuf;
+      cbuf.set_string(::rocket::sref(
+        R"__(
+///////////////////////////////////////////////////////////////////////////////
+
+          // Variables that do not escape are not tracked.
+          std.gc.set_threshold(0, 1000000);
+          var base = std.gc.tracked_count(0);
+          func work(n) {
+            var total = 0;
+            for(var i = 0;  i < n;  ++i) {
+              var a = i * 2;
+              var b = [ a, a + 1 ], c;
+              const d = b[1] - b[0];
+              c = { x: a };
+              b[0] += 1;
+              total += a + c.x + d + std.array.max_of(b);
+            }
+            return total;
+          }
+          assert work(10000) == 299990000;
+          assert std.gc.tracked_count(0) - base < 100;
+
+          // These variables escape and form reference cycles, which have to be collected.
+          func setr(r) {
+            r = func() = r;
+          }
+          func by_ref() {
+            var v;
+            setr(&v);
+          }
+          func by_this() {
+            var o = { set: func() { this.g = func() = this;  } };
+            o.set();
+          }
+          func ret_ref() {
+            var v;
+            return& v;
+          }
+          func by_ret_ref() {
+            setr(&ret_ref());
+          }
+          func by_for_each() {
+            var arr = [ 1 ];
+            for(each k, e : arr)
+              setr(&e);
+          }
+          func by_subscript() {
+            var arr = [ 0 ];
+            setr(&arr[0]);
+          }
+          func by_branch() {
+            var v, w;
+            setr(&(v ? v : w));
+          }
+          func by_coalescence() {
+            var v, w;
+            setr(&(v ?? w));
+          }
+          func by_assignment() {
+            var v;
+            setr(&(v = 1));
+          }
+          func by_capture() {
+            var f = func() = f;
+          }
+          for(var i = 0;  i < 100;  ++i) {
+            by_ref();
+            by_this();
+            by_ret_ref();
+            by_for_each();
+            by_subscript();
+            by_branch();
+            by_coalescence();
+            by_assignment();
+            by_capture();
+          }
+          assert std.gc.tracked_count(0) - base >= 900;
+
+///////////////////////////////////////////////////////////////////////////////
+        )__"), tinybuf::open_read);
+      Simple_Script code(cbuf, ::rocket::sref(__FILE__));
+      code.execute(global);
+    }
+    // All cycles shall have been broken.
+    ASTERIA_TEST_CHECK(bcnt.load(::std::memory_order_relaxed) == 0);
+  }
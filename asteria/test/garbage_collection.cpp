@@ -35,6 +35,52 @@ void operator delete(void* ptr, size_t) noexcept
     operator delete(ptr);
   }
 
+namespace {
+
+pair<int64_t, int64_t> execute_parallel(uint32_t nworkers)
+  {
+    Global_Context global;
+    global.generational_collector()->set_parallel_workers(nworkers);
+
+    ::rocket::tinybuf_str cbuf;
+    cbuf.set_string(::rocket::sref(
+      R"__(
+        // Defer collection until there are many variables.
+        std.gc.set_policy("fixed");
+        std.gc.set_threshold(0, 1000000);
+        std.gc.set_threshold(1, 1000000);
+        std.gc.set_threshold(2, 1000000);
+        var keep = [ ];
+        for(var i = 0;  i < 5000;  ++i) {
+          // This cycle becomes garbage immediately.
+          var f = func() = f;
+          // This one is kept alive if `i` is even.
+          var n = i;
+          var g = func() = [ g, n ];
+          // The function is shared, so references to it are fractional.
+          var h = g;
+          if(i % 2 == 0)
+            keep[$] = func() = h;
+        }
+        var ncoll = std.gc.collect();
+        var sum = 0;
+        for(each k, h : keep)
+          sum += h()()[1];
+        return [ ncoll, sum ];
+      )__"), tinybuf::open_read);
+    Simple_Script code(cbuf, ::rocket::sref(__FILE__));
+    auto result = code.execute(global).read().as_array();
+    ASTERIA_TEST_CHECK(global.generational_collector()->get_collector(gc_generation_newest)
+                                                           .get_statistics().staged >= 4096);
+    // Worker threads are kept for later cycles. Variables of the first run are collected, too.
+    auto again = code.execute(global).read().as_array();
+    ASTERIA_TEST_CHECK(again.at(0).as_integer() >= result.at(0).as_integer());
+    ASTERIA_TEST_CHECK(again.at(1).as_integer() == result.at(1).as_integer());
+    return { result.at(0).as_integer(), result.at(1).as_integer() };
+  }
+
+}  // namespace
+
 int main()
   {
     // Ignore leaks of emutls, emergency pool, etc.
@@ -71,4 +117,16 @@ int main()
     ASTERIA_TEST_CHECK(var->is_initialized() == false);
     var.reset();
     ASTERIA_TEST_CHECK(bcnt.load(::std::memory_order_relaxed) == 0);
+
+    // Phases 2 and 3 may be run in parallel, which shall not make any difference.
+    bcnt.store(0, ::std::memory_order_relaxed);
+    auto expect = execute_parallel(1);
+    ASTERIA_TEST_CHECK(expect.first >= 7500);
+    ASTERIA_TEST_CHECK(expect.second == 6247500);
+    for(uint32_t nworkers = 2;  nworkers <= 8;  nworkers *= 2) {
+      auto result = execute_parallel(nworkers);
+      ASTERIA_TEST_CHECK(result.first == expect.first);
+      ASTERIA_TEST_CHECK(result.second == expect.second);
+    }
+    ASTERIA_TEST_CHECK(bcnt.load(::std::memory_order_relaxed) == 0);
   }
@@ -22,5 +22,39 @@ int main()
 
     Simple_Script code(cbuf, ::rocket::sref(__FILE__));
     Global_Context global;
-    code.execute(global).read().as_string() == "string/object";
+    ASTERIA_TEST_CHECK(code.execute(global).read().as_string() == "string/object");
+
+    // Global references are cached. Make sure caches are invalidated as needed.
+    cbuf.set_string(::rocket::sref(
+      R"__(
+///////////////////////////////////////////////////////////////////////////////
+
+        return std.string.slice(g, 1);
+
+///////////////////////////////////////////////////////////////////////////////
+      )__"), tinybuf::open_read);
+
+    code.reload(cbuf, ::rocket::sref(__FILE__));
+    global.open_named_reference(::rocket::sref("g")) = Reference_root::S_constant{ V_string("meow") };
+    ASTERIA_TEST_CHECK(code.execute(global).read().as_string() == "eow");
+
+    // Add more names, causing rehashes.
+    for(int i = 0;  i < 100;  ++i) {
+      char name[32];
+      ::std::sprintf(name, "dummy%d", i);
+      global.open_named_reference(cow_string(name));
+    }
+    global.open_named_reference(::rocket::sref("g")) = Reference_root::S_constant{ V_string("hello") };
+    ASTERIA_TEST_CHECK(code.execute(global).read().as_string() == "ello");
+
+    // Execute the same code in another context.
+    Global_Context other;
+    other.open_named_reference(::rocket::sref("g")) = Reference_root::S_constant{ V_string("world") };
+    ASTERIA_TEST_CHECK(code.execute(other).read().as_string() == "orld");
+
+    // Reinitialize the context, which clears all references.
+    global.initialize();
+    ASTERIA_TEST_CHECK_CATCH(code.execute(global));
+    global.open_named_reference(::rocket::sref("g")) = Reference_root::S_constant{ V_string("again") };
+    ASTERIA_TEST_CHECK(code.execute(global).read().as_string() == "gain");
   }
@@ -0,0 +1,92 @@
+// This file is part of Asteria.
+// Copyleft 2018 - 2020, LH_Mouse. All wrongs reserved.
+
+#include "test_utilities.hpp"
+#include "../src/runtime/simple_script.hpp"
+#include "../src/runtime/global_context.hpp"
+#include "../src/runtime/abstract_hooks.hpp"
+
+using namespace Asteria;
+
+namespace {
+
+struct Test_Hooks : Abstract_Hooks
+  {
+    Global_Context* global_opt = nullptr;
+    long ndecls = 0;
+    long ncalls = 0;
+    long nrets = 0;
+    long ntraps = 0;
+
+    void on_variable_declare(const Source_Location&, const cow_string&, const phsh_string&) override
+      {
+        this->ndecls++;
+      }
+    void on_function_call(const Source_Location&, const cow_string&, const cow_function&) override
+      {
+        this->ncalls++;
+        // Uninstall hooks from inside a hook. `this` must stay valid.
+        if(this->global_opt)
+          this->global_opt->set_hooks(nullptr);
+      }
+    void on_function_return(const Source_Location&, const cow_string&, const Reference&) override
+      {
+        this->nrets++;
+      }
+    void on_single_step_trap(const Source_Location&, const cow_string&, Executive_Context*) override
+      {
+        this->ntraps++;
+      }
+  };
+
+}  // namespace
+
+int main()
+  {
+    ::rocket::tinybuf_str cbuf;
+    cbuf.set_string(::rocket::sref(
+      R"__(
+///////////////////////////////////////////////////////////////////////////////
+
+        func add(x, y) {
+          var r = x + y;
+          return r;
+        }
+        var s = 0;
+        for(var i = 0;  i < 10;  ++i)
+          s = add(s, i);
+        return s;
+
+///////////////////////////////////////////////////////////////////////////////
+      )__"), tinybuf::open_read);
+
+    Simple_Script code(cbuf, ::rocket::sref(__FILE__));
+    Global_Context global;
+
+    // Run without hooks.
+    ASTERIA_TEST_CHECK(code.execute(global).read().as_integer() == 45);
+    ASTERIA_TEST_CHECK(global.has_hooks() == false);
+
+    // Attach hooks to the same context. The code needn't be recompiled.
+    auto hooks = ::rocket::make_refcnt<Test_Hooks>();
+    global.set_hooks(hooks);
+    ASTERIA_TEST_CHECK(code.execute(global).read().as_integer() == 45);
+    ASTERIA_TEST_CHECK(hooks->ndecls > 10);
+    ASTERIA_TEST_CHECK(hooks->ncalls == 10);
+    ASTERIA_TEST_CHECK(hooks->nrets == 10);
+    ASTERIA_TEST_CHECK(hooks->ntraps > 10);
+
+    // Detach hooks. Nothing should be notified.
+    global.set_hooks(nullptr);
+    auto ndecls = hooks->ndecls;
+    ASTERIA_TEST_CHECK(code.execute(global).read().as_integer() == 45);
+    ASTERIA_TEST_CHECK(hooks->ndecls == ndecls);
+    ASTERIA_TEST_CHECK(hooks->ncalls == 10);
+
+    // Attach hooks which uninstall themselves upon the first call.
+    auto once = ::rocket::make_refcnt<Test_Hooks>();
+    once->global_opt = &global;
+    global.set_hooks(::std::move(once));
+    ASTERIA_TEST_CHECK(code.execute(global).read().as_integer() == 45);
+    ASTERIA_TEST_CHECK(global.has_hooks() == false);
+  }
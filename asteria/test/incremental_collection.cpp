@@ -0,0 +1,116 @@
+// This file is part of Asteria.
+// Copyleft 2018 - 2020, LH_Mouse. All wrongs reserved.
+
+#include "test_utilities.hpp"
+#include "../src/runtime/simple_script.hpp"
+#include "../src/runtime/global_context.hpp"
+#include "../src/runtime/generational_collector.hpp"
+
+using namespace Asteria;
+
+::std::atomic<long> bcnt;
+
+void* operator new(size_t cb)
+  {
+    auto ptr = ::std::malloc(cb);
+    if(!ptr) {
+      throw ::std::bad_alloc();
+    }
+    bcnt.fetch_add(1, ::std::memory_order_relaxed);
+    return ptr;
+  }
+
+void operator delete(void* ptr) noexcept
+  {
+    if(!ptr) {
+      return;
+    }
+    bcnt.fetch_sub(1, ::std::memory_order_relaxed);
+    ::std::free(ptr);
+  }
+
+void operator delete(void* ptr, size_t) noexcept
+  {
+    operator delete(ptr);
+  }
+
+namespace {
+
+int64_t execute(Global_Context& global)
+  {
+    ::rocket::tinybuf_str cbuf;
+    cbuf.set_string(::rocket::sref(
+      R"__(
+///////////////////////////////////////////////////////////////////////////////
+
+        // Collect frequently, so references are moved around between steps.
+        std.gc.set_threshold(0, 20);
+        std.gc.set_threshold(1, 20);
+        std.gc.set_threshold(2, 20);
+        var keep = [ ];
+        for(var i = 0;  i < 3000;  ++i) {
+          // This cycle becomes garbage immediately.
+          var f = func() = f;
+          // This one is kept alive, but the reference to it may be moved later.
+          var n = i;
+          var g = func() = [ g, n ];
+          keep[$] = g;
+          if(i % 3 == 0) {
+            var t = keep[i / 2];
+            keep[i / 2] = null;
+            keep[$] = t;
+          }
+        }
+        var sum = 0;
+        for(each k, g : keep)
+          if(g)
+            sum += g()[0]()[1];
+        return sum;
+
+///////////////////////////////////////////////////////////////////////////////
+      )__"), tinybuf::open_read);
+    Simple_Script code(cbuf, ::rocket::sref(__FILE__));
+    return code.execute(global).read().as_integer();
+  }
+
+}  // namespace
+
+int main()
+  {
+    // Ignore leaks of emutls, emergency pool, etc.
+    delete new int;
+
+    // Get the expected result without incremental collection.
+    bcnt.store(0, ::std::memory_order_relaxed);
+    int64_t expect;
+    {
+      Global_Context global;
+      expect = execute(global);
+    }
+    ASTERIA_TEST_CHECK(expect == 4498500);
+    ASTERIA_TEST_CHECK(bcnt.load(::std::memory_order_relaxed) == 0);
+
+    // Steps of automatic collection are interleaved with the script. Variables that are alive must not be
+    // collected, although references to them have been moved between steps.
+    bcnt.store(0, ::std::memory_order_relaxed);
+    {
+      Global_Context global;
+      auto gcoll = global.generational_collector();
+      gcoll->set_step_budget(1);
+      ASTERIA_TEST_CHECK(execute(global) == expect);
+
+      // Complete the work in idle time. All cycles shall have been collected then.
+      gcoll->set_step_budget(0);
+      long nsteps = 0;
+      while(gcoll->collect_step(0))
+        ++nsteps;
+      ASTERIA_TEST_CHECK(nsteps > 0);
+      ASTERIA_TEST_CHECK(gcoll->get_collector(gc_generation_newest).is_collecting() == false);
+      ASTERIA_TEST_CHECK(gcoll->get_collector(gc_generation_oldest).is_collecting() == false);
+      ASTERIA_TEST_CHECK(gcoll->get_collector(gc_generation_newest).count_tracked_variables() == 0);
+      ASTERIA_TEST_CHECK(gcoll->get_collector(gc_generation_middle).count_tracked_variables() == 0);
+      ASTERIA_TEST_CHECK(gcoll->get_collector(gc_generation_oldest).count_tracked_variables() < 200);
+      ASTERIA_TEST_CHECK(gcoll->get_collector(gc_generation_newest).get_statistics().cycles > 0);
+    }
+    ASTERIA_TEST_CHECK(bcnt.load(::std::memory_order_relaxed) == 0);
+  }
@@ -0,0 +1,139 @@
+// This file is part of Asteria.
+// Copyleft 2018 - 2020, LH_Mouse. All wrongs reserved.
+
+#include "test_utilities.hpp"
+#include "../src/runtime/simple_script.hpp"
+#include "../src/runtime/global_context.hpp"
+#include "../src/runtime/runtime_error.hpp"
+
+using namespace Asteria;
+
+int main()
+  {
+    ::rocket::tinybuf_str cbuf;
+    cbuf.set_string(::rocket::sref(
+      R"__(
+///////////////////////////////////////////////////////////////////////////////
+
+        var log = [];
+
+        func check(x) {
+          var y = x * 3 + 1;
+          if(y % 7 == 0)
+            throw y;
+          return y;
+        }
+
+        func step(x) {
+          defer log[$] = x;
+          var t = 0;
+          try {
+            t = check(x);
+          }
+          catch(e) {
+            t = -e;
+          }
+          return t;
+        }
+
+        func nested(n) {
+          var r = 0;
+          for(var i = 0;  i < n;  ++i) {
+            if(i % 5 == 3)
+              continue;
+            if(i > 40)
+              break;
+            r += step(i);
+          }
+          return r;
+        }
+
+        var s = 0;
+        var caught = 0;
+        for(var k = 0;  k < 500;  ++k) {
+          s += nested(k % 50);
+          try {
+            // The exception propagates through several frames.
+            check(2 + k % 3 * 7);
+            s += 1;
+          }
+          catch(e) {
+            caught += 1;
+          }
+        }
+        return [ s, caught, lengthof log ];
+
+///////////////////////////////////////////////////////////////////////////////
+      )__"), tinybuf::open_read);
+
+    Simple_Script code(cbuf, ::rocket::sref(__FILE__));
+
+    // Run without native code, which is the default.
+    Global_Context global;
+    ASTERIA_TEST_CHECK(global.is_jit_enabled() == false);
+    auto expect = code.execute(global).read();
+    ASTERIA_TEST_CHECK(global.count_native_queues() == 0);
+    ASTERIA_TEST_CHECK(global.count_native_executions() == 0);
+
+    // Run with native code. Hot functions and loop bodies are translated midway.
+    global.set_jit_enabled(true);
+    for(int r = 0;  r < 3;  ++r) {
+      auto result = code.execute(global).read();
+      ASTERIA_TEST_CHECK(result.compare(expect) == compare_equal);
+    }
+#if defined(__x86_64__) && defined(__linux__) && defined(HAVE_REGISTER_FRAME_LIST) && defined(HAVE_MEMFD_CREATE)  \
+    && !defined(ASTERIA_NO_JIT)
+    ASTERIA_TEST_CHECK(global.count_native_queues() > 0);
+    ASTERIA_TEST_CHECK(global.count_native_executions() > global.count_native_queues());
+#endif
+
+    // Run in a new context where native code is disabled at the middle. Queues that have been translated
+    // are interpreted again.
+    Global_Context other;
+    other.set_jit_enabled(true);
+    ASTERIA_TEST_CHECK(code.execute(other).read().compare(expect) == compare_equal);
+    other.set_jit_enabled(false);
+    auto nexecs = other.count_native_executions();
+    ASTERIA_TEST_CHECK(code.execute(other).read().compare(expect) == compare_equal);
+    ASTERIA_TEST_CHECK(other.count_native_executions() == nexecs);
+
+    // Exceptions that are thrown by nodes called from native code propagate to C++ code.
+    cbuf.set_string(::rocket::sref(
+      R"__(
+///////////////////////////////////////////////////////////////////////////////
+
+        func add(x, y) {
+          var r = x;
+          r += y;
+          r += 0;
+          return r;
+        }
+
+        var s = 0;
+        for(var k = 0;  k < 1000;  ++k)
+          s = add(s, 1);
+        // This overflows.
+        return add(0x7FFFFFFFFFFFFFFF, s);
+
+///////////////////////////////////////////////////////////////////////////////
+      )__"), tinybuf::open_read);
+
+    Simple_Script ovfl(cbuf, ::rocket::sref(__FILE__));
+    Global_Context third;
+    third.set_jit_enabled(true);
+    for(int r = 0;  r < 3;  ++r) {
+      cow_string what;
+      try {
+        ovfl.execute(third);
+      }
+      catch(Runtime_Error& e) {
+        what.assign(e.what());
+      }
+      ASTERIA_TEST_CHECK(what.find("integer addition overflow") != cow_string::npos);
+    }
+#if defined(__x86_64__) && defined(__linux__) && defined(HAVE_REGISTER_FRAME_LIST) && defined(HAVE_MEMFD_CREATE)  \
+    && !defined(ASTERIA_NO_JIT)
+    ASTERIA_TEST_CHECK(third.count_native_queues() > 0);
+    ASTERIA_TEST_CHECK(third.count_native_executions() > 1000);
+#endif
+  }
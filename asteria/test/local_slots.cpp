@@ -0,0 +1,160 @@
+// This file is part of Asteria.
+// Copyleft 2018 - 2020, LH_Mouse. All wrongs reserved.
+
+#include "test_utilities.hpp"
+#include "../src/runtime/simple_script.hpp"
+#include "../src/runtime/global_context.hpp"
+
+using namespace Asteria;
+
+int main()
+  {
+    ::rocket::tinybuf_str cbuf;
+    cbuf.set_string(::rocket::sref(
+      R"__(
+///////////////////////////////////////////////////////////////////////////////
+
+        // `default` clauses are taken if no `case` label matches.
+        func first(x) {
+          var r = [ ];
+          switch(x) {
+          default:
+            r[$] = "default";
+          case 1:
+            r[$] = "one";
+          }
+          return r;
+        }
+        assert first(1) == [ "one" ];
+        assert first(2) == [ "default", "one" ];
+
+        func only(x) {
+          var r = [ ];
+          switch(x) {
+          default:
+            r[$] = "default";
+          }
+          return r;
+        }
+        assert only(1) == [ "default" ];
+
+        func none(x) {
+          var r = [ ];
+          switch(x) {
+          case 1:
+            r[$] = "one";
+          case 2:
+            r[$] = "two";
+          }
+          return r;
+        }
+        assert none(1) == [ "one", "two" ];
+        assert none(2) == [ "two" ];
+        assert none(3) == [ ];
+
+        // Names that are declared in skipped clauses are void.
+        func skip(x) {
+          switch(x) {
+          case 1:
+            var a = "one";
+          case 2:
+            var b = "two";
+          default:
+            return typeof a + "/" + typeof b;
+          }
+        }
+        assert skip(1) == "string/string";
+        func read_void(x) {
+          try {
+            return skip(x);
+          }
+          catch(e) {
+            return std.string.find(e, "no value") != null;
+          }
+        }
+        assert read_void(2) == true;
+        assert read_void(3) == true;
+
+        // Slots are not shared by contexts.
+        func nested(x) {
+          switch(x) {
+          case 1: {
+            var a = "inner";
+          }
+          case 2:
+            var a = "outer";
+          default:
+            return a;
+          }
+        }
+        assert nested(1) == "outer";
+        assert nested(2) == "outer";
+
+        // Redeclaration and shadowing across nested blocks.
+        var a = 1;
+        func get_a() { return a;  }
+        {
+          assert a == 1;
+          var a = 2;
+          assert a == 2;
+          {
+            assert a == 2;
+            var a = 3;
+            assert a == 3;
+            a = 4;
+          }
+          assert a == 2;
+          var c = a;
+          var a = c + 10;
+          assert a == 12;
+        }
+        assert a == 1;
+        var a = 5;
+        assert a == 5;
+        // Functions keep the references that they captured.
+        assert get_a() == 1;
+
+        func shadow(a, b) {
+          {
+            var b = a * 2;
+            {
+              var a = b + 1;
+              for(var b = 0;  b < 3;  ++b)
+                a += b;
+              return [ a, b ];
+            }
+          }
+        }
+        assert shadow(3, 42) == [ 10, 6 ];
+
+        // Pre-defined names are looked up by name at all depths.
+        func dyn(x, ...) {
+          {
+            {
+              var r = [ __varg(), __varg(0), __func ];
+              for(var i = 0;  i < 1;  ++i)
+                r[$] = __varg(1);
+              return r;
+            }
+          }
+        }
+        assert dyn(1, 2, 3) == [ 2, 2, "dyn(x, ...)", 3 ];
+
+        var obj = {
+          k: 42,
+          get: func() {
+            if(true) {
+              {
+                return __this.k;
+              }
+            }
+          },
+        };
+        assert obj.get() == 42;
+
+///////////////////////////////////////////////////////////////////////////////
+      )__"), tinybuf::open_read);
+    Simple_Script code(cbuf, ::rocket::sref(__FILE__));
+    Global_Context global;
+    code.execute(global);
+  }
@@ -0,0 +1,56 @@
+// This file is part of Asteria.
+// Copyleft 2018 - 2020, LH_Mouse. All wrongs reserved.
+
+#include "test_utilities.hpp"
+#include "../src/runtime/simple_script.hpp"
+#include "../src/runtime/global_context.hpp"
+
+using namespace Asteria;
+
+int main()
+  {
+    ::rocket::tinybuf_str cbuf;
+    cbuf.set_string(::rocket::sref(
+      R"__(
+///////////////////////////////////////////////////////////////////////////////
+
+        // Build a large structure and move it into the oldest generation.
+        var big = [ ];
+        for(var i = 0;  i < 10000;  ++i) {
+          var x = i;
+          big[$] = func() = x;
+        }
+        std.gc.collect();
+
+        // Create young cycles that refer to the old structure.
+        for(var i = 0;  i < 100;  ++i) {
+          var f = func() = [ f, big ];
+        }
+
+        // The old structure is not traversed by a collection of the newest
+        // generation. References from it are counted as external ones.
+        std.gc.collect(0);
+        var s = std.gc.get_statistics(0);
+        assert s.collected >= 100;
+        assert s.staged < 1000;
+
+        // Young variables that are only referenced by old ones survive.
+        var y = 42;
+        big[$] = func() = y;
+        y = null;
+        std.gc.collect(0);
+        assert big[10000]() == null;
+        y = 43;
+        assert big[10000]() == 43;
+
+        var sum = 0;
+        for(each k, f : big)
+          sum += f();
+        return sum;
+
+///////////////////////////////////////////////////////////////////////////////
+      )__"), tinybuf::open_read);
+    Simple_Script code(cbuf, ::rocket::sref(__FILE__));
+    Global_Context global;
+    ASTERIA_TEST_CHECK(code.execute(global).read().as_integer() == 49995043);
+  }
@@ -0,0 +1,155 @@
+// This file is part of Asteria.
+// Copyleft 2018 - 2020, LH_Mouse. All wrongs reserved.
+
+#include "test_utilities.hpp"
+#include "../src/runtime/simple_script.hpp"
+#include "../src/runtime/global_context.hpp"
+
+using namespace Asteria;
+
+int main()
+  {
+    ::rocket::tinybuf_str cbuf;
+    cbuf.set_string(::rocket::sref(
+      R"__(
+///////////////////////////////////////////////////////////////////////////////
+
+        var r = [ ];
+
+        // Operators that would throw are not folded, and their errors are raised at run time.
+        func error_of(f) {
+          try {
+            f();
+          }
+          catch(e) {
+            return e;
+          }
+          return null;
+        }
+        func div_zero() { return 1 / 0;  }
+        func mod_zero() { return 1 % 0;  }
+        func add_ovfl() { return 0x7FFFFFFFFFFFFFFF + 1;  }
+        func sub_ovfl() { return -0x7FFFFFFFFFFFFFFF - 2;  }
+        func mul_ovfl() { return 0x4000000000000000 * 2;  }
+        func neg_ovfl() { return -(-0x7FFFFFFFFFFFFFFF - 1);  }
+        assert std.string.find(error_of(div_zero), "integer divided by zero") != null;
+        assert std.string.find(error_of(mod_zero), "integer divided by zero") != null;
+        assert std.string.find(error_of(add_ovfl), "integer addition overflow") != null;
+        assert std.string.find(error_of(sub_ovfl), "integer subtraction overflow") != null;
+        assert std.string.find(error_of(mul_ovfl), "integer multiplication overflow") != null;
+        assert std.string.find(error_of(neg_ovfl), "integer negation overflow") != null;
+
+        // Operators that don't throw yield the same results either way.
+        r[$] = 1 + 2 * 3 - 4 / 2;
+        r[$] = 0x7FFFFFFFFFFFFFFF + -1;
+        r[$] = 1.5 / 0;
+        r[$] = "meow" + "MEOW";
+        r[$] = !(1 < 2) || (3 != 3.0);
+        assert r == [ 5, 0x7FFFFFFFFFFFFFFE, infinity, "meowMEOW", false ];
+
+        // Constant conditions take the right branch. Side effects in other branches never happen.
+        var n = 0;
+        r = [ ];
+        if(true)
+          r[$] = "if-true";
+        else
+          r[$] = ++n;
+        if(false)
+          r[$] = ++n;
+        else
+          r[$] = "if-false";
+        if(null)
+          r[$] = ++n;
+        if(!0) {
+          var k = "if-not";
+          r[$] = k;
+        }
+        r[$] = true ? "sel-true" : ++n;
+        r[$] = false ? ++n : "sel-false";
+        r[$] = 0 ? ++n : "sel-zero";
+        r[$] = null ?? "coal-null";
+        r[$] = 0 ?? ++n;
+        r[$] = "" ?? ++n;
+        assert n == 0;
+        assert r == [ "if-true", "if-false", "if-not", "sel-true", "sel-false", "sel-zero", "coal-null", 0, "" ];
+
+        // Statements that follow `return`, `throw` or `break` are never executed.
+        func clause(x) {
+          var s = [ ];
+          switch(x) {
+          case 1: {
+            s[$] = 1;
+            break;
+            s[$] = "dead";
+          }
+          case 2: {
+            s[$] = 2;
+            return s;
+            s[$] = "dead";
+          }
+          default: {
+            s[$] = 3;
+            throw s;
+            s[$] = "dead";
+          }
+          }
+          s[$] = "after";
+          return s;
+        }
+        assert clause(1) == [ 1, "after" ];
+        assert clause(2) == [ 2 ];
+        assert error_of(func() { return clause(3);  }) == [ 3 ];
+
+        func loops() {
+          var s = [ ];
+          for(var i = 0;  i < 4;  ++i) {
+            if(i == 1) {
+              continue;
+              s[$] = "dead";
+            }
+            s[$] = i;
+            if(i == 2) {
+              break;
+              s[$] = "dead";
+            }
+          }
+          while(true) {
+            s[$] = "while";
+            break;
+            s[$] = "dead";
+          }
+          do {
+            s[$] = "do";
+            break;
+            s[$] = "dead";
+          }
+          while(true);
+          for(each k, v : [ 5, 6 ]) {
+            s[$] = v;
+            continue;
+            s[$] = "dead";
+          }
+          return s;
+          s[$] = "dead";
+        }
+        assert loops() == [ 0, 2, "while", "do", 5, 6 ];
+
+        return [ r, clause(1), loops() ];
+
+///////////////////////////////////////////////////////////////////////////////
+      )__"), tinybuf::open_read);
+
+    // Run without optimization.
+    Simple_Script code;
+    code.open_options().no_optimization = true;
+    code.reload(cbuf, ::rocket::sref(__FILE__));
+    Global_Context global;
+    auto expect = code.execute(global).read();
+
+    // Run with optimization. The results must be identical.
+    cbuf.set_string(cow_string(cbuf.get_string()), tinybuf::open_read);
+    Simple_Script optimized;
+    optimized.reload(cbuf, ::rocket::sref(__FILE__));
+    auto result = optimized.execute(global).read();
+    ASTERIA_TEST_CHECK(result.compare(expect) == compare_equal);
+  }
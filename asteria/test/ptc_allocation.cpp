@@ -0,0 +1,115 @@
+// This file is part of Asteria.
+// Copyleft 2018 - 2020, LH_Mouse. All wrongs reserved.
+
+#include "test_utilities.hpp"
+#include "../src/runtime/simple_script.hpp"
+#include "../src/runtime/global_context.hpp"
+
+using namespace Asteria;
+
+::std::atomic<long> acnt;
+
+void* operator new(size_t cb)
+  {
+    auto ptr = ::std::malloc(cb);
+    if(!ptr) {
+      throw ::std::bad_alloc();
+    }
+    acnt.fetch_add(1, ::std::memory_order_relaxed);
+    return ptr;
+  }
+
+void operator delete(void* ptr) noexcept
+  {
+    ::std::free(ptr);
+  }
+
+void operator delete(void* ptr, size_t) noexcept
+  {
+    operator delete(ptr);
+  }
+
+int main()
+  {
+    ::rocket::tinybuf_str cbuf;
+    cbuf.set_string(::rocket::sref(
+      R"__(
+///////////////////////////////////////////////////////////////////////////////
+
+        // A state machine whose states transfer control by proper tail calls.
+        var even, odd;
+        even = func(n, acc) {
+          if(n <= 0)
+            return acc;
+          return odd(n - 1, acc + 1);
+        };
+        odd = func(n, acc) {
+          if(n <= 0)
+            return acc;
+          return even(n - 1, acc * 2 % 1000);
+        };
+        func loop(n) {
+          var total = 0;
+          for(var i = 0;  i < n;  ++i)
+            total = total * 3 + i & 0xFFFF;
+          return total;
+        }
+        func count(n) {
+          return (n <= 0) ? loop(3) : count(n - 1);
+        }
+        return [ even(__varg(0), 0), count(__varg(0)) ];
+
+///////////////////////////////////////////////////////////////////////////////
+      )__"), tinybuf::open_read);
+
+    Simple_Script code(cbuf, ::rocket::sref(__FILE__));
+    Global_Context global;
+
+    // Warm up, so buffers are allocated and function bodies are compiled.
+    cow_vector<Value> args;
+    args.emplace_back(V_integer(10));
+    code.execute(global, ::std::move(args));
+
+    // Measure allocations with different numbers of steps. They should not grow with the number of steps.
+    long counts[2];
+    for(long k = 0;  k < 2;  ++k) {
+      acnt.store(0, ::std::memory_order_relaxed);
+      args.clear();
+      args.emplace_back(V_integer(1000 + k * 99000));
+      code.execute(global, ::std::move(args));
+      counts[k] = acnt.load(::std::memory_order_relaxed);
+    }
+    ASTERIA_TEST_CHECK(counts[1] - counts[0] < 100);
+
+    // Frames are folded, but backtraces must be complete.
+    cbuf.set_string(::rocket::sref(
+      R"__(
+///////////////////////////////////////////////////////////////////////////////
+
+        var x, y, z;
+        x = func(n) {
+          if(n <= 0)
+            throw "done";
+          return (n % 10 == 0) ? z(n - 1) : y(n - 1);
+        };
+        y = func(n) = z(n - 1);
+        z = func(n) = x(n - 1);
+        func trace(n) {
+          try {
+            x(n);
+          }
+          catch(e) {
+            var ncalls = 0;
+            for(each k, frm : __backtrace)
+              if(frm.frame == "call")
+                ++ncalls;
+            return ncalls;
+          }
+        }
+        return trace(500) - trace(100);
+
+///////////////////////////////////////////////////////////////////////////////
+      )__"), tinybuf::open_read);
+    code.reload(cbuf, ::rocket::sref(__FILE__));
+    ASTERIA_TEST_CHECK(code.execute(global).read().as_integer() == 400);
+  }
@@ -0,0 +1,89 @@
+// This file is part of Asteria.
+// Copyleft 2018 - 2020, LH_Mouse. All wrongs reserved.
+
+#include "test_utilities.hpp"
+#include "../src/runtime/simple_script.hpp"
+#include "../src/runtime/global_context.hpp"
+#include "../src/runtime/air_node.hpp"
+
+using namespace Asteria;
+
+int main()
+  {
+    ::rocket::tinybuf_str cbuf;
+    cbuf.set_string(::rocket::sref(
+      R"__(
+///////////////////////////////////////////////////////////////////////////////
+
+        var r = [];
+
+        var a = 7, b = 3, c = 2.5;
+        r[$] = a + b * 2 - a % b;
+        r[$] = (a - b) * (a + b) / c;
+        r[$] = a << b | a >> 1 ^ b & 6;
+        r[$] = a < b || b <= c && c != a;
+        r[$] = a <=> b;
+        r[$] = [ a == 7, b != 3, c > 2, a >= 8 ];
+
+        // Assignments whose sources are lowered.
+        var s = 0;
+        for(var i = 0;  i < 100;  ++i) {
+          s = s + i * 2 - 1;
+        }
+        r[$] = s;
+
+        // Strings and mixed operands.
+        var x = "ab", y = "cd";
+        x = x + y + x;
+        r[$] = x;
+        r[$] = x * 3;
+
+        // Outer variables are bound into closures.
+        func make(k) {
+          var t = k * 10;
+          return func(n) = n * t + k - 1;
+        }
+        var f = make(4);
+        r[$] = f(5) + f(6);
+
+        // Errors are reported by stack-based code.
+        var e = [];
+        var z = 0;
+        try { e[$] = a / z; }  catch(ex) { e[$] = ex; }
+        try { e[$] = x - y; }  catch(ex) { e[$] = ex; }
+        try { e[$] = a + x; }  catch(ex) { e[$] = ex; }
+        try { e[$] = [1] < [2] + 1; }  catch(ex) { e[$] = ex; }
+        const k = 1;
+        try { k = a + b; }  catch(ex) { e[$] = ex; }
+        var big = 0x7FFFFFFFFFFFFFFF;
+        try { e[$] = big + a; }  catch(ex) { e[$] = ex; }
+        r[$] = e;
+        r[$] = k;
+
+        return r;
+
+///////////////////////////////////////////////////////////////////////////////
+      )__"), tinybuf::open_read);
+
+    // Run without register-based expressions.
+    Simple_Script code(cbuf, ::rocket::sref(__FILE__));
+    Global_Context global;
+    auto expect = code.execute(global).read();
+
+    // Run with register-based expressions. The results must be identical.
+    cbuf.set_string(cow_string(cbuf.get_string()), tinybuf::open_read);
+    Simple_Script lowered;
+    lowered.open_options().register_expressions = true;
+    AIR_Node::set_pair_counter_mode(true);
+    lowered.reload(cbuf, ::rocket::sref(__FILE__));
+    AIR_Node::set_pair_counter_mode(false);
+    auto result = lowered.execute(global).read();
+    ASTERIA_TEST_CHECK(result.compare(expect) == compare_equal);
+    ASTERIA_TEST_CHECK(result.as_array().at(6).as_integer() == 9800);
+    ASTERIA_TEST_CHECK(result.as_array().at(9).as_integer() == 446);
+    ASTERIA_TEST_CHECK(result.as_array().at(10).as_array().size() == 6);
+
+    ::rocket::tinyfmt_str fmt;
+    AIR_Node::print_pair_counts(fmt, 100);
+    ASTERIA_TEST_CHECK(fmt.get_string().find("register_expression") != cow_string::npos);
+  }
@@ -0,0 +1,61 @@
+// This file is part of Asteria.
+// Copyleft 2018 - 2020, LH_Mouse. All wrongs reserved.
+
+#include "test_utilities.hpp"
+#include "../src/runtime/simple_script.hpp"
+#include "../src/runtime/global_context.hpp"
+#include "../src/runtime/air_node.hpp"
+
+using namespace Asteria;
+
+int main()
+  {
+    ::rocket::tinybuf_str cbuf;
+    cbuf.set_string(::rocket::sref(
+      R"__(
+///////////////////////////////////////////////////////////////////////////////
+
+        var o = { a: 1, b: "x" };
+        var n = 0, m = 0;
+        for(var i = 0; i < 10; ++i) {
+          n = n + 3;
+          m -= 1;
+          if(i == 5)
+            n = n * 2;
+          if ! (i < 8)
+            o.a++;
+          if(o.b != "x")
+            assert false;
+        }
+        assert n == 48;
+        assert m == -10;
+        assert o.a == 3;
+
+        var k = 5;
+        assert k++ == 5;
+        assert ++k == 7;
+        assert k-- == 7;
+        assert --k == 5;
+        assert o.b + "y" == "xy";
+        return o.a + k;
+
+///////////////////////////////////////////////////////////////////////////////
+      )__"), tinybuf::open_read);
+
+    // Superinstructions must not alter the results.
+    Simple_Script code(cbuf, ::rocket::sref(__FILE__));
+    Global_Context global;
+    ASTERIA_TEST_CHECK(code.execute(global).read().as_integer() == 8);
+
+    // In the pair counter mode, pairs of adjacent nodes are counted as they are executed.
+    AIR_Node::set_pair_counter_mode(true);
+    cbuf.set_string(cow_string(cbuf.get_string()), tinybuf::open_read);
+    Simple_Script counted(cbuf, ::rocket::sref(__FILE__));
+    AIR_Node::set_pair_counter_mode(false);
+    ASTERIA_TEST_CHECK(counted.execute(global).read().as_integer() == 8);
+
+    ::rocket::tinyfmt_str fmt;
+    AIR_Node::print_pair_counts(fmt, 100);
+    ASTERIA_TEST_CHECK(fmt.get_string().find("push_local_reference + member_access") != cow_string::npos);
+    ASTERIA_TEST_CHECK(fmt.get_string().find("apply_operator + if_statement") != cow_string::npos);
+  }
@@ -0,0 +1,135 @@
+// This file is part of Asteria.
+// Copyleft 2018 - 2020, LH_Mouse. All wrongs reserved.
+
+#include "test_utilities.hpp"
+#include "../src/runtime/simple_script.hpp"
+#include "../src/runtime/global_context.hpp"
+
+using namespace Asteria;
+
+int main()
+  {
+    ::rocket::tinybuf_str cbuf;
+    cbuf.set_string(::rocket::sref(
+      R"__(
+///////////////////////////////////////////////////////////////////////////////
+
+        // Dense integers, with fallthrough and a `default` clause in the middle.
+        func dense(x) {
+          var r = [ ];
+          switch(x) {
+          case 3:
+            r[$] = "three";
+          case 1: {
+            r[$] = "one";
+            break;
+          }
+          default:
+            r[$] = "default";
+          case 2: {
+            r[$] = "two";
+            break;
+          }
+          case 1:
+            r[$] = "unreachable";
+          }
+          return r;
+        }
+        assert dense(1) == [ "one" ];
+        assert dense(2) == [ "two" ];
+        assert dense(3) == [ "three", "one" ];
+        assert dense(4) == [ "default", "two" ];
+        assert dense(-0x8000000000000000) == [ "default", "two" ];
+        assert dense(0x7FFFFFFFFFFFFFFF) == [ "default", "two" ];
+        // Reals are compared with integers by value.
+        assert dense(1.0) == [ "one" ];
+        assert dense(2.5) == [ "default", "two" ];
+        // Values of other types never match.
+        assert dense(null) == [ "default", "two" ];
+        assert dense(true) == [ "default", "two" ];
+        assert dense("1") == [ "default", "two" ];
+
+        // Sparse integers and strings.
+        func sparse(x) {
+          switch(x) {
+          case -1000000:
+            return "a";
+          case 7:
+            return "b";
+          case 1 << 40:
+            return "c";
+          case "7":
+            return "d";
+          case "":
+            return "e";
+          case "route/" + "one":
+            return "f";
+          case "7":
+            return "unreachable";
+          }
+          return "none";
+        }
+        assert sparse(-1000000) == "a";
+        assert sparse(7) == "b";
+        assert sparse(7.0) == "b";
+        assert sparse(0x10000000000) == "c";
+        assert sparse(8) == "none";
+        assert sparse("7") == "d";
+        assert sparse("") == "e";
+        assert sparse("route/one") == "f";
+        assert sparse("route") == "none";
+        assert sparse([ 7 ]) == "none";
+
+        // Labels that are not constants are evaluated in order.
+        func dynamic(x, y) {
+          switch(x) {
+          case 1:
+            return "one";
+          case y:
+            return "y";
+          case y + 1:
+            return "y+1";
+          }
+          return "none";
+        }
+        assert dynamic(1, 1) == "one";
+        assert dynamic(5, 5) == "y";
+        assert dynamic(6, 5) == "y+1";
+        assert dynamic(7, 5) == "none";
+
+        // Multiple `default` clauses are still diagnosed.
+        try {
+          switch(1) {
+          default:
+          case 2:
+          default:
+          }
+          assert false;
+        }
+        catch(e) {
+          assert std.string.find(e, "multiple `default` clauses") != null;
+        }
+
+        // A large table.
+        func route(x) {
+          switch(x) {
+          case  0:  return 100;  case  1:  return 101;  case  2:  return 102;  case  3:  return 103;
+          case  4:  return 104;  case  5:  return 105;  case  6:  return 106;  case  7:  return 107;
+          case  8:  return 108;  case  9:  return 109;  case 10:  return 110;  case 11:  return 111;
+          case "0":  return 200;  case "1":  return 201;  case "2":  return 202;  case "3":  return 203;
+          case "4":  return 204;  case "5":  return 205;  case "6":  return 206;  case "7":  return 207;
+          }
+          return -1;
+        }
+        var sum = 0;
+        for(var i = -5;  i < 20;  ++i)
+          sum += route(i) + route(std.string.format("$1", i));
+        return sum;
+
+///////////////////////////////////////////////////////////////////////////////
+      )__"), tinybuf::open_read);
+
+    Simple_Script code(cbuf, ::rocket::sref(__FILE__));
+    Global_Context global;
+    ASTERIA_TEST_CHECK(code.execute(global).read().as_integer() == 1266 - 13 + 1628 - 17);
+  }
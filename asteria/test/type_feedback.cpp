@@ -0,0 +1,98 @@
+// This file is part of Asteria.
+// Copyleft 2018 - 2020, LH_Mouse. All wrongs reserved.
+
+#include "test_utilities.hpp"
+#include "../src/runtime/simple_script.hpp"
+#include "../src/runtime/global_context.hpp"
+
+using namespace Asteria;
+
+int main()
+  {
+    ::rocket::tinybuf_str cbuf;
+    cbuf.set_string(::rocket::sref(
+      R"__(
+///////////////////////////////////////////////////////////////////////////////
+
+        func calc(a, b) {
+          return [ a + b, a - b, a * b, a / b, a % b,
+                   a == b, a != b, a < b, a > b, a <= b, a >= b ];
+        }
+
+        // Operators become monomorphic on integers...
+        for(var i = 1;  i < 100;  ++i)
+          assert calc(i, 7)[0] == i + 7;
+        assert calc(-9, 4) == [ -5, -13, -36, -2, -1, false, true, true, false, true, false ];
+
+        // ... and are deoptimized when they see reals.
+        assert calc(7.5, 2.5) == [ 10.0, 5.0, 18.75, 3.0, 0.0, false, true, false, true, false, true ];
+        assert calc(-9, 4) == [ -5, -13, -36, -2, -1, false, true, true, false, true, false ];
+
+        // Mixed types and other types still work.
+        assert calc(3, 1.5) == [ 4.5, 1.5, 4.5, 2.0, 0.0, false, true, false, true, false, true ];
+
+        func rcmp(a, b) { return [ a == b, a != b ]; }
+        for(var i = 0;  i < 10;  ++i)
+          assert rcmp(i / 2.0, 1.0) == [ i == 2, i != 2 ];
+        // NaN compares unequal with everything, and is unordered.
+        var x = __sqrt -1.0;
+        assert rcmp(x, x) == [ false, true ];
+        try {
+          var r = x < 1.0;
+          assert false;
+        }
+        catch(e) {
+          assert std.string.find(e, "not comparable") != null;
+        }
+
+        // Errors are the same as with generic operators.
+        func add(a, b) { return a + b; }
+        for(var i = 0;  i < 10;  ++i)
+          add(i, i);
+        assert add("a", "b") == "ab";
+        try {
+          add(0x7FFFFFFFFFFFFFFF, 1);
+          assert false;
+        }
+        catch(e) {
+          assert std.string.find(e, "integer addition overflow") != null;
+        }
+        try {
+          var r = 1 / 0;
+          assert false;
+        }
+        catch(e) {
+          assert std.string.find(e, "zero") != null;
+        }
+
+        // Compound assignments write the results back.
+        var s = 0, t = 1.0;
+        for(var i = 0;  i < 10;  ++i) {
+          s += i;
+          t *= 2.0;
+        }
+        assert s == 45;
+        assert t == 1024.0;
+        const k = 1;
+        try {
+          k += 1;
+          assert false;
+        }
+        catch(e) {
+          assert k == 1;
+        }
+
+        // Counted loops.
+        var n = 0;
+        for(var i = 0;  i < 1000;  ++i)
+          for(var j = i;  j > 990;  --j)
+            n = n + 1;
+        return n;
+
+///////////////////////////////////////////////////////////////////////////////
+      )__"), tinybuf::open_read);
+
+    Simple_Script code(cbuf, ::rocket::sref(__FILE__));
+    Global_Context global;
+    ASTERIA_TEST_CHECK(code.execute(global).read().as_integer() == 45);
+  }
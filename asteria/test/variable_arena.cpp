@@ -0,0 +1,66 @@
+// This file is part of Asteria.
+// Copyleft 2018 - 2020, LH_Mouse. All wrongs reserved.
+
+#include "test_utilities.hpp"
+#include "../src/llds/variable_arena.hpp"
+#include "../src/runtime/variable.hpp"
+#include <thread>
+
+using namespace Asteria;
+
+int main()
+  {
+    cow_vector<rcptr<Variable>> vars;
+    {
+      Variable_Arena arena;
+      for(long i = 0;  i < 500;  ++i) {
+        auto var = rcptr<Variable>(new(arena) Variable());
+        var->initialize(V_integer(i), false);
+        vars.emplace_back(::std::move(var));
+      }
+
+      // Variables that are created together are adjacent.
+      auto p1 = reinterpret_cast<uintptr_t>(vars[1].get());
+      auto p2 = reinterpret_cast<uintptr_t>(vars[2].get());
+      auto p3 = reinterpret_cast<uintptr_t>(vars[3].get());
+      ASTERIA_TEST_CHECK(p2 - p1 >= sizeof(Variable));
+      ASTERIA_TEST_CHECK(p2 - p1 == p3 - p2);
+
+      // Storage is reused once a variable is freed.
+      vars.mut(2).reset();
+      auto var = rcptr<Variable>(new(arena) Variable());
+      ASTERIA_TEST_CHECK(reinterpret_cast<uintptr_t>(var.get()) == p2);
+      vars.mut(2) = ::std::move(var);
+
+      // Free half of them before the arena is destroyed.
+      for(size_t i = 0;  i < vars.size();  i += 2)
+        vars.mut(i).reset();
+    }
+    // Others outlive their arena.
+    for(size_t i = 1;  i < vars.size();  i += 2)
+      ASTERIA_TEST_CHECK(vars[i]->get_value().as_integer() == static_cast<long>(i));
+    vars.clear();
+
+    // Variables may be freed by other threads while the arena is being used, and after it has been destroyed.
+    ::std::thread thr;
+    {
+      Variable_Arena arena;
+      for(long i = 0;  i < 5000;  ++i)
+        vars.emplace_back(new(arena) Variable());
+      thr = ::std::thread([&] { vars.clear();  });
+      for(long i = 0;  i < 5000;  ++i)
+        rcptr<Variable>(new(arena) Variable());
+      thr.join();
+
+      for(long i = 0;  i < 5000;  ++i)
+        vars.emplace_back(new(arena) Variable());
+      thr = ::std::thread([&] { vars.clear();  });
+    }
+    thr.join();
+    ASTERIA_TEST_CHECK(vars.empty());
+
+    // Variables that are allocated without an arena are supported, too.
+    auto var = ::rocket::make_refcnt<Variable>();
+    var->initialize(V_integer(42), true);
+    ASTERIA_TEST_CHECK(var->get_value().as_integer() == 42);
+  }